@@ -0,0 +1,145 @@
+#include "additive.h"
+#include "env.h"
+
+/* Increments at or past this are at or above Nyquist. */
+#define ADDITIVE_NYQUIST 2147483648.0f
+
+static void partial_silence(struct additivevoice *v, int p)
+{
+    v->amp[p] = 0.0f;
+    v->step[p] = 0.0f;
+    v->target[p] = 0.0f;
+    v->floor[p] = 0.0f;
+    v->fall[p] = 0.0f;
+}
+
+void additive_start(struct additivevoice *v,
+                    const struct additivepatch *p,
+                    uint32_t inc,
+                    bool fresh)
+{
+    int partials = p->partials;
+    partials = partials < 0 ? 0 : partials;
+    partials = partials > ADDITIVE_PARTIALS ? ADDITIVE_PARTIALS : partials;
+
+    /* The partials a retriggered note keeps are the same ones as before, in
+     * the same places, unless the patch has changed under it - in which case
+     * carrying on from the old phases is harmless anyway. */
+    int n = 0;
+    for (int k = 0; k < partials; k++) {
+        float ratio = p->ratio[k];
+        float level = p->level[k];
+        if (ratio <= 0.0f || level <= 0.0f || inc * ratio >= ADDITIVE_NYQUIST) {
+            continue;
+        }
+
+        float sustain = p->sustain[k];
+        sustain = sustain < 0.0f ? 0.0f : sustain;
+        sustain = sustain > 1.0f ? 1.0f : sustain;
+
+        if (fresh || n >= v->count) {
+            v->re[n] = 1.0f;
+            v->im[n] = 0.0f;
+        }
+        v->ratio[n] = ratio;
+        v->amp[n] = level;
+        v->step[n] = 0.0f;
+        v->target[n] = level;
+        v->floor[n] = level * sustain;
+        v->fall[n] = p->decay[k] > 0
+                     ? (level - v->floor[n]) * adsr_rate(p->decay[k])
+                     : 0.0f;
+        n++;
+    }
+
+    /* The padding never moves off zero phase, so it's silent whatever it's
+     * rotated by. */
+    for (; n % ADDITIVE_PACK; n++) {
+        v->re[n] = 1.0f;
+        v->im[n] = 0.0f;
+        v->ratio[n] = 0.0f;
+        partial_silence(v, n);
+    }
+    v->count = n;
+}
+
+/* The cosine and sine of 0.32 fixed-point @phase, to float precision.
+ * fm_sine() is only good to 6e-7, which is plenty for an operator, whose
+ * phase is worked out afresh every sample - but a rotation's error builds up
+ * into a partial's frequency, and that much leaves one smeared across the
+ * bins around it at -70dB.  The phase is folded into the eighth of a cycle
+ * either side of the nearest quarter, where the Taylor series converge
+ * quickly, and that quarter picks which is which. */
+static void rotation(uint32_t phase, float *c, float *s)
+{
+    uint32_t quarter = (phase + 0x20000000) >> 30;
+    float x = (int32_t)(phase - (quarter << 30))
+              * (6.28318531f / 4294967296.0f);
+    float x2 = x * x;
+    float sx = 1.0f - x2 * (1.0f / 72.0f);
+    sx = 1.0f - x2 * (1.0f / 42.0f) * sx;
+    sx = 1.0f - x2 * (1.0f / 20.0f) * sx;
+    sx = x * (1.0f - x2 * (1.0f / 6.0f) * sx);
+    float cx = 1.0f - x2 * (1.0f / 56.0f);
+    cx = 1.0f - x2 * (1.0f / 30.0f) * cx;
+    cx = 1.0f - x2 * (1.0f / 12.0f) * cx;
+    cx = 1.0f - x2 * 0.5f * cx;
+
+    switch (quarter) {
+    case 0:
+        *c = cx;
+        *s = sx;
+        break;
+    case 1:
+        *c = -sx;
+        *s = cx;
+        break;
+    case 2:
+        *c = -cx;
+        *s = -sx;
+        break;
+    default:
+        *c = sx;
+        *s = -cx;
+        break;
+    }
+}
+
+void additive_tune(struct additivevoice *v, uint32_t inc)
+{
+    for (int p = 0; p < v->count; p++) {
+        float pinc = inc * v->ratio[p];
+        if (pinc < ADDITIVE_NYQUIST) {
+            rotation((uint32_t)pinc, &v->rot_re[p], &v->rot_im[p]);
+        } else {
+            v->re[p] = 1.0f;
+            v->im[p] = 0.0f;
+            v->rot_re[p] = 1.0f;
+            v->rot_im[p] = 0.0f;
+            partial_silence(v, p);
+        }
+    }
+}
+
+void additive_control(struct additivevoice *v, int len)
+{
+    float inv_len = 1.0f / len;
+    for (int p = 0; p < v->count; p++) {
+        float end = v->amp[p] - v->fall[p] * len;
+        end = end < v->floor[p] ? v->floor[p] : end;
+        v->target[p] = end;
+        v->step[p] = (end - v->amp[p]) * inv_len;
+    }
+}
+
+void additive_land(struct additivevoice *v)
+{
+    for (int p = 0; p < v->count; p++) {
+        v->amp[p] = v->target[p];
+    }
+}
+
+void additive_reset(struct additivevoice *v)
+{
+    v->count = 0;
+}
@@ -0,0 +1,91 @@
+#ifndef SXLHLG_ADDITIVE_H
+#define SXLHLG_ADDITIVE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <caboose/util.h>
+
+#include "voicebank.h"
+
+/* Additive voices: each note is a sum of up to ADDITIVE_PARTIALS sines, every
+ * one at its own ratio to the note's frequency and with its own level, which
+ * falls away from its initial value to a sustain level of its own over its own
+ * decay time - so a patch can be bright at the start of a note and mellow out,
+ * or have a bell's inharmonic partials die away before the body does.  The
+ * voice's ADSR (and everything else) is applied on top, as for any other
+ * waveform.
+ *
+ * The sines aren't looked up or evaluated from a phase.  Each partial is a
+ * unit phasor re + i im that's rotated by a fixed complex number every sample,
+ * which takes four multiplies and two adds, and its imaginary part is the
+ * sine.  The rotations are worked out once per retuning.  Rounding makes a
+ * phasor's magnitude drift, so the kernels pull it back towards 1 at the end
+ * of every block.
+ *
+ * Partials at or above Nyquist would alias, so the ones that would be are left
+ * out at note on, and the rest are packed together so the kernels don't spend
+ * any time on them.  The kernels take the partials eight at a time, so a
+ * voice's count is rounded up to a multiple of eight with silent ones.
+ *
+ * A partial bent up past Nyquist after note on is silenced for the rest of the
+ * note rather than dropped, since that would shuffle the others around under
+ * the kernels. */
+#define ADDITIVE_PARTIALS 64
+#define ADDITIVE_PACK 8
+
+/* The most samples the kernels render before folding a voice's partials down:
+ * a control sub-block's worth. */
+#define ADDITIVE_CHUNK 16
+
+/* The settings of the partials, shared by every voice. */
+struct additivepatch {
+    int partials;   /* how many of the below are used */
+    float ratio[ADDITIVE_PARTIALS];     /* frequency, relative to the note */
+    float level[ADDITIVE_PARTIALS];     /* at note on, [0, 1] */
+    float sustain[ADDITIVE_PARTIALS];   /* fraction of the level decayed to */
+    int decay[ADDITIVE_PARTIALS];       /* ms; 0 holds the level */
+};
+
+/* One voice's partials, packed, struct-of-arrays like the voicebank.  The
+ * levels are ramped per sample by step, just like the voice's, and landed on
+ * their targets after each sub-block. */
+struct additivevoice {
+    float re[ADDITIVE_PARTIALS];
+    float im[ADDITIVE_PARTIALS];
+    float rot_re[ADDITIVE_PARTIALS];
+    float rot_im[ADDITIVE_PARTIALS];
+    float amp[ADDITIVE_PARTIALS];       /* at the start of the block */
+    float step[ADDITIVE_PARTIALS];      /* added to the level every sample */
+    float target[ADDITIVE_PARTIALS];    /* at the end of the block */
+    float floor[ADDITIVE_PARTIALS];     /* the sustain level */
+    float fall[ADDITIVE_PARTIALS];      /* per sample, while decaying */
+    float ratio[ADDITIVE_PARTIALS];
+    int count;      /* a multiple of ADDITIVE_PACK */
+} __aligned(16);
+
+struct additivebank {
+    struct additivevoice voice[SYNTH_VOICE_COUNT];
+};
+
+/* Start a note with increment @inc on @v: pick out the partials of @p below
+ * Nyquist and set their levels going from the top.  The phasors of a @fresh
+ * note start at zero phase; a retriggered one carries on where it is. */
+void additive_start(struct additivevoice *v,
+                    const struct additivepatch *p,
+                    uint32_t inc,
+                    bool fresh);
+
+/* Retune @v's partials for increment @inc.  This costs a couple of sines per
+ * partial, so it's only done when the pitch has moved. */
+void additive_tune(struct additivevoice *v, uint32_t inc);
+
+/* Run @v's decays on over the next @len samples and set up the ramps there,
+ * and land them at the end. */
+void additive_control(struct additivevoice *v, int len);
+void additive_land(struct additivevoice *v);
+
+/* Silence @v altogether. */
+void additive_reset(struct additivevoice *v);
+
+#endif
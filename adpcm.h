@@ -0,0 +1,111 @@
+#ifndef SXLHLG_ADPCM_H
+#define SXLHLG_ADPCM_H
+
+#include <stdint.h>
+
+/* IMA ADPCM, which is how a bank's samples can be stored compressed (see
+ * bank.h): each frame is a 4-bit code that moves a prediction, starting from
+ * the last frame, by some fraction of a step size, and the step size goes up
+ * or down by a fixed table depending on how big the code was.  That's a
+ * quarter of the size of 16-bit frames, for noise that follows the signal's
+ * level - it's lossy - and it only takes a few adds and shifts a frame to
+ * decode, which is cheap enough to do as the frames are played.
+ *
+ * A channel is split into blocks of ADPCM_FRAMES frames, each of which starts
+ * with its first frame as it is and the step index to carry on with, so that
+ * decoding can start again at any block without having to go back to the
+ * start of the sample.  The codes of the rest follow, two to a byte, the
+ * earlier in the low nibble.  (That leaves one nibble of every block spare.)
+ *
+ * Both the packer on the build host and the target include this, so the
+ * encoder is here too, and the two can't disagree. */
+#define ADPCM_FRAMES 128
+
+struct adpcmblock {
+    int16_t first;
+    uint8_t index;
+    uint8_t reserved;
+    uint8_t codes[ADPCM_FRAMES / 2];
+};
+
+/* A decoder's (or an encoder's) state: the last frame, and where it is in the
+ * table of step sizes. */
+struct adpcm {
+    int32_t last;
+    int32_t index;
+};
+
+#define ADPCM_STEPS 89
+
+static const int16_t adpcm_steps[ADPCM_STEPS] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+    19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+    130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+    337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+    876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+    5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+/* How far each code moves the step index, ignoring its sign. */
+static const int8_t adpcm_moves[8] = { -1, -1, -1, -1, 2, 4, 6, 8 };
+
+/* Pick up decoding at the start of @b. */
+static inline int16_t adpcm_block(struct adpcm *a, const struct adpcmblock *b)
+{
+    a->last = b->first;
+    a->index = b->index < ADPCM_STEPS ? b->index : ADPCM_STEPS - 1;
+    return b->first;
+}
+
+/* Decode the next frame, from @code. */
+static inline int16_t adpcm_decode(struct adpcm *a, unsigned int code)
+{
+    int32_t step = adpcm_steps[a->index];
+    int32_t diff = step >> 3;
+    diff += code & 4 ? step : 0;
+    diff += code & 2 ? step >> 1 : 0;
+    diff += code & 1 ? step >> 2 : 0;
+
+    int32_t x = a->last + (code & 8 ? -diff : diff);
+    x = x < INT16_MIN ? INT16_MIN : x;
+    x = x > INT16_MAX ? INT16_MAX : x;
+    a->last = x;
+
+    int32_t index = a->index + adpcm_moves[code & 7];
+    index = index < 0 ? 0 : index;
+    a->index = index < ADPCM_STEPS - 1 ? index : ADPCM_STEPS - 1;
+    return x;
+}
+
+/* The code that takes the prediction closest to @x, which is then decoded so
+ * that the state moves just as the decoder's will. */
+static inline unsigned int adpcm_encode(struct adpcm *a, int16_t x)
+{
+    int32_t step = adpcm_steps[a->index];
+    int32_t diff = x - a->last;
+    unsigned int code = 0;
+    if (diff < 0) {
+        code = 8;
+        diff = -diff;
+    }
+
+    if (diff >= step) {
+        code |= 4;
+        diff -= step;
+    }
+    if (diff >= step >> 1) {
+        code |= 2;
+        diff -= step >> 1;
+    }
+    if (diff >= step >> 2) {
+        code |= 1;
+    }
+
+    adpcm_decode(a, code);
+    return code;
+}
+
+#endif
@@ -10,6 +10,7 @@
 #include <caboose-platform/irq.h>
 #include <caboose-platform/mmu.h>
 #include <caboose-platform/platform-events.h>
+#include <caboose-platform/timer.h>
 #include <caboose-platform/util.h>
 
 #include "audio.h"
@@ -145,8 +146,6 @@
  *     -clock-sources-for-the-general-purpose-clocks
  */
 
-#define DMA_SAMPLE_CNT 32 /* 32 * 22.675us = 725.6us theoretical latency */
-
 /* I'm omitting the registers I'm not using for now (which is most of them).
  * The full set is described in the datasheet, and a mostly complete subset of
  * those are defined in rsta2's bcm2835.h. */
@@ -323,8 +322,8 @@ static void audio_init(struct dmaconblk conblks[2],
     /* Configure the range register of each channel to use a 22.675us period
      * (5669 ticks of the 250MHz PWM clock). */
     volatile struct pwmregs *pwm = (struct pwmregs *)ARM_PWM_BASE;
-    pwm->rng1 = 5669;
-    pwm->rng2 = 5669;
+    pwm->rng1 = AUDIO_PWM_RANGE;
+    pwm->rng2 = AUDIO_PWM_RANGE;
 
     /* Enable both channels, configure them both to use the FIFO (sharing it
      * round robin as described in the datasheet), and clear the FIFO as
@@ -419,6 +418,7 @@ void audio(void)
     };
 
     for (int i = 0; i < 2; i++) {
+        req.stamp = timer_read();
         int replylen = Send(audio_source,
                             &req,
                             sizeof req,
@@ -444,6 +444,7 @@ void audio(void)
         ASSERT(dma->conblkad == (uint32_t)&conblks[!i]);
 
         /* Refill it with new audio data. */
+        req.stamp = timer_read();
         int replylen = Send(audio_source,
                             &req,
                             sizeof req,
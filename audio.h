@@ -1,15 +1,33 @@
 #ifndef SXLHLG_AUDIO_H
 #define SXLHLG_AUDIO_H
 
+#include <stdint.h>
+
 #include "messages.h"
 
 #define AUDIO_SOURCE "marvin"
 
+#define AUDIO_SAMPLE_RATE 44100
+
+/* The PWM period, in ticks of its 250MHz clock (see audio.c): a sample's
+ * value is its pulse width, so nothing above this can be played. */
+#define AUDIO_PWM_RANGE 5669
+
+#define DMA_SAMPLE_CNT 32 /* 32 * 22.675us = 725.6us theoretical latency */
+
+/* Every GET_AUDIO must be answered before the DMA engine finishes playing out
+ * the other buffer, so this is the render deadline for each request. */
+#define DMA_PERIOD_US 725
+
 struct audioreq {
     struct msghdr hdr;
     /* The number of stereo 12-bit 44100Hz samples we'd like to receive in
      * reply. */
     unsigned int len;
+    /* The system timer when the request was made, which is when the DMA
+     * engine started on the buffer before the one being asked for - so the
+     * time between two requests is the block of time the second is for. */
+    uint32_t stamp;
 };
 
 void audio(void);
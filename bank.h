@@ -0,0 +1,109 @@
+#ifndef SXLHLG_BANK_H
+#define SXLHLG_BANK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "adpcm.h"
+
+/* Instrument banks: a set of samples, each with the range of keys and
+ * velocities it plays for, packed into one binary on the build host by
+ * tools/mkbank.c and linked in as it is (see bank.S), with nothing to
+ * compile and nothing to convert at run time.
+ *
+ * A bank starts with struct bank, which holds a map from every key and
+ * velocity to the zone that plays it, so that finding it at note on is a
+ * single load, and then the zones themselves.  The samples follow, each
+ * channel of each one starting on a BANK_ALIGN boundary, either as signed
+ * 16-bit frames or compressed into ADPCM blocks (see adpcm.h), which are
+ * decoded a little at a time as they're played (see samplestream.h).
+ * Everything's little-endian, like the Pi.
+ *
+ * The packer works out the map from the zones' ranges, the first zone that
+ * covers a key and velocity taking it, so the ranges are only kept for
+ * reference.  It also follows the end of every loop with the first few
+ * frames of it, so that interpolating across the end reads what's played
+ * next, and drops anything after that: a looped sample keeps on looping,
+ * and the envelope's release is what ends it. */
+#define BANK_MAGIC 0x4b4e4253   /* "SBNK" */
+#define BANK_VERSION 2
+
+#define BANK_KEYS 128
+#define BANK_VELOCITIES 128
+#define BANK_CHANNELS 2
+#define BANK_ALIGN 64
+
+/* There can be up to 255 zones: the last index means none. */
+#define BANK_NONE 0xff
+#define BANK_ZONES BANK_NONE
+
+/* How a zone's sample is stored. */
+#define BANK_PCM16 0
+#define BANK_ADPCM 1
+
+struct bankzone {
+    uint8_t lokey, hikey;       /* inclusive */
+    uint8_t lovel, hivel;
+    uint8_t root;               /* the key it plays at its own pitch */
+    uint8_t channels;           /* 1 or 2 */
+    uint8_t codec;
+    uint8_t reserved;
+    uint32_t frames;            /* in each channel */
+    uint32_t loop_start;        /* in frames, */
+    uint32_t loop_end;          /* or 0 if it doesn't loop */
+    uint32_t data[BANK_CHANNELS];   /* each channel's offset in the bank; a
+                                       mono zone's are the same */
+};
+
+struct bank {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t zones;
+    uint32_t size;              /* of the whole bank, in bytes */
+    uint32_t reserved;
+    uint8_t map[BANK_KEYS][BANK_VELOCITIES];
+    struct bankzone zone[];
+};
+
+/* The bank built into the kernel. */
+extern const struct bank bank_default;
+
+/* Whether @b looks like a bank this code understands. */
+static inline bool bank_valid(const struct bank *b)
+{
+    return b->magic == BANK_MAGIC
+           && b->version == BANK_VERSION
+           && b->zones <= BANK_ZONES
+           && b->size >= sizeof *b + b->zones * sizeof b->zone[0];
+}
+
+/* The zone of @b that plays @key at @velocity, or NULL if none does. */
+static inline const struct bankzone *bank_zone(const struct bank *b,
+                                               int key,
+                                               int velocity)
+{
+    uint8_t z = b->map[key & (BANK_KEYS - 1)]
+                      [velocity & (BANK_VELOCITIES - 1)];
+    return z == BANK_NONE ? NULL : &b->zone[z];
+}
+
+/* Channel @channel of @z's sample, in @b, however it's stored. */
+static inline const void *bank_data(const struct bank *b,
+                                    const struct bankzone *z,
+                                    int channel)
+{
+    return (const uint8_t *)b + z->data[channel];
+}
+
+/* How many bytes a channel of @z's sample takes. */
+static inline uint32_t bank_bytes(const struct bankzone *z)
+{
+    if (z->codec == BANK_ADPCM) {
+        uint32_t blocks = (z->frames + ADPCM_FRAMES - 1) / ADPCM_FRAMES;
+        return blocks * sizeof(struct adpcmblock);
+    }
+    return z->frames * sizeof(int16_t);
+}
+
+#endif
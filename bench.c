@@ -0,0 +1,3588 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <mini-printf.h>
+
+#include <caboose/caboose.h>
+#include <caboose/config.h>
+#include <caboose/platform.h>
+
+#include <caboose-platform/cpu.h>
+#include <caboose-platform/debug.h>
+#include <caboose-platform/fxmem.h>
+#include <caboose-platform/pmu.h>
+#include <caboose-platform/timer.h>
+#include <caboose-platform/worker.h>
+
+#include "additive.h"
+#include "audio.h"
+#include "bench.h"
+#include "blep.h"
+#include "chorus.h"
+#include "delay.h"
+#include "dither.h"
+#include "drive.h"
+#include "env.h"
+#include "fm.h"
+#include "kernels.h"
+#include "lfo.h"
+#include "limiter.h"
+#include "mod.h"
+#include "osc.h"
+#include "params.h"
+#include "reverb.h"
+#include "sampler.h"
+#include "samplestream.h"
+#include "svf.h"
+#include "synth.h"
+#include "tuning.h"
+#include "unison.h"
+#include "wavetable.h"
+
+/* None of this - least of all its buffers - is wanted in an image that's
+ * going to make any sound (see sxlhlg.c). */
+#ifdef CONFIG_SYNTH_BENCH
+
+/* Every measurement is repeated this many times, so that the worst case we
+ * report has had a fair chance to show up. */
+#define BENCH_RUNS 2000
+
+struct benchstat {
+    uint32_t start;
+    uint32_t worst;
+    uint64_t total;
+    uint32_t runs;
+};
+
+/* Measured once at startup, so we can quote results in microseconds without
+ * assuming anything about how the firmware has clocked the ARM. */
+static uint32_t cycles_per_us;
+
+static void bench_reset(struct benchstat *b)
+{
+    b->worst = 0;
+    b->total = 0;
+    b->runs = 0;
+}
+
+static inline void bench_begin(struct benchstat *b)
+{
+    b->start = pmu_cycles();
+}
+
+static inline void bench_end(struct benchstat *b)
+{
+    uint32_t cycles = pmu_cycles() - b->start;
+    b->worst = cycles > b->worst ? cycles : b->worst;
+    b->total += cycles;
+    b->runs++;
+}
+
+static uint32_t bench_mean(struct benchstat *b)
+{
+    return b->total / b->runs;
+}
+
+/* mini-printf doesn't do floats, so per-sample figures are printed with two
+ * fixed decimal places. */
+static void bench_report(const char *what, struct benchstat *b, int samples)
+{
+    uint32_t mean = bench_mean(b);
+    uint32_t per_sample = (uint32_t)(b->total * 100 / ((uint64_t)b->runs
+                                                       * samples));
+    debug_printf("%s: mean %u cycles, worst %u cycles (%u us), "
+                 "%u.%02u cycles/sample",
+                 what,
+                 mean,
+                 b->worst,
+                 b->worst / cycles_per_us,
+                 per_sample / 100,
+                 per_sample % 100);
+}
+
+static void bench_calibrate(void)
+{
+    uint32_t us = timer_read();
+    uint32_t cycles = pmu_cycles();
+    while (timer_read() - us < 100000) {
+        /* wait */
+    }
+
+    cycles_per_us = (pmu_cycles() - cycles) / (timer_read() - us);
+    debug_printf("bench: %u cycles/us, %u us block deadline (%u samples)",
+                 cycles_per_us,
+                 DMA_PERIOD_US,
+                 DMA_SAMPLE_CNT);
+}
+
+/* ---------------- Oscillators ---------------- */
+
+/* The period-counting square wave the synth used before it had phase
+ * accumulators, kept verbatim as a baseline. */
+static int legacy_fill(uint32_t *buf, int count, int period, int offset)
+{
+    int midpoint = period / 2;
+    for (int i = 0; i < count; i++) {
+        uint32_t sample = offset < midpoint ? 6144 : 2048;
+        *buf++ = sample;
+        *buf++ = sample;
+        offset = (offset + 1) % period;
+    }
+
+    return offset;
+}
+
+static void bench_oscillators(void)
+{
+    uint32_t out[DMA_SAMPLE_CNT * 2];
+    float mix[DMA_SAMPLE_CNT];
+    struct benchstat b;
+
+    /* periods[] held 100 for A4 and 4 for the top note. */
+    static const struct {
+        const char *what;
+        int note;
+        int period;
+    } cases[] = {
+        { "A4", 69, 100 },
+        { "G9", 127, 4 },
+    };
+
+    for (int i = 0; i < sizeof cases / sizeof cases[0]; i++) {
+        char what[48];
+
+        int offset = 0;
+        bench_reset(&b);
+        for (int run = 0; run < BENCH_RUNS; run++) {
+            bench_begin(&b);
+            offset = legacy_fill(out, DMA_SAMPLE_CNT, cases[i].period, offset);
+            bench_end(&b);
+        }
+        mini_snprintf(what, sizeof what, "fill() %s", cases[i].what);
+        bench_report(what, &b, DMA_SAMPLE_CNT);
+
+        struct osc o;
+        osc_start(&o, tuning_words[cases[i].note]);
+        bench_reset(&b);
+        for (int run = 0; run < BENCH_RUNS; run++) {
+            bench_begin(&b);
+            osc_square(&o, mix, DMA_SAMPLE_CNT);
+            bench_end(&b);
+        }
+        mini_snprintf(what, sizeof what, "osc_square() %s", cases[i].what);
+        bench_report(what, &b, DMA_SAMPLE_CNT);
+
+        osc_start(&o, tuning_words[cases[i].note]);
+        bench_reset(&b);
+        for (int run = 0; run < BENCH_RUNS; run++) {
+            bench_begin(&b);
+            blep_square(&o, mix, DMA_SAMPLE_CNT);
+            bench_end(&b);
+        }
+        mini_snprintf(what, sizeof what, "blep_square() %s", cases[i].what);
+        bench_report(what, &b, DMA_SAMPLE_CNT);
+
+        osc_start(&o, tuning_words[cases[i].note]);
+        bench_reset(&b);
+        for (int run = 0; run < BENCH_RUNS; run++) {
+            bench_begin(&b);
+            blep_saw(&o, mix, DMA_SAMPLE_CNT);
+            bench_end(&b);
+        }
+        mini_snprintf(what, sizeof what, "blep_saw() %s", cases[i].what);
+        bench_report(what, &b, DMA_SAMPLE_CNT);
+    }
+}
+
+/* ---------------- Aliasing ---------------- */
+
+/* We render a few seconds' worth of each oscillator offline and look at its
+ * spectrum.  Choosing a frequency of exactly ALIAS_BIN cycles per ALIAS_LEN
+ * samples makes the rendered signal exactly periodic in the transform, so every
+ * true harmonic lands precisely on a multiple of ALIAS_BIN and no window is
+ * needed.  Everything in the other bins is aliasing, and since ALIAS_LEN is a
+ * power of two and the fundamental bins are odd, the folded harmonics can't
+ * land back on a multiple of the fundamental. */
+#define ALIAS_LEN 4096
+
+static float alias_buf[ALIAS_LEN];
+static float alias_cos[ALIAS_LEN];
+static float alias_sin[ALIAS_LEN];
+
+static void alias_twiddles(void)
+{
+    /* No libm here, so build the table by repeated rotation, seeded with a
+     * Taylor series for the (tiny) angle of one bin. */
+    double theta = 2 * 3.14159265358979323846 / ALIAS_LEN;
+    double theta2 = theta * theta;
+    double c = 1 - theta2 / 2 * (1 - theta2 / 12 * (1 - theta2 / 30));
+    double s = theta * (1 - theta2 / 6 * (1 - theta2 / 20 * (1 - theta2 / 42)));
+    double re = 1, im = 0;
+    for (int n = 0; n < ALIAS_LEN; n++) {
+        alias_cos[n] = re;
+        alias_sin[n] = im;
+
+        double next = re * c - im * s;
+        im = re * s + im * c;
+        re = next;
+    }
+}
+
+/* 10log10(x), good to a fraction of a dB, which is all we print anyway. */
+static int bench_db(float x)
+{
+    union {
+        float f;
+        uint32_t u;
+    } bits = { .f = x };
+
+    int exponent = (int)((bits.u >> 23) & 0xff) - 127;
+    bits.u = (bits.u & 0x007fffff) | 0x3f800000;
+    float m = bits.f;
+    float log2m = -1.7417939f
+                  + (2.8212026f
+                     + (-1.4699568f
+                        + (0.44717955f - 0.056570851f * m) * m) * m) * m;
+
+    float db = 3.0103f * (exponent + log2m);
+    return db < 0 ? (int)(db - 0.5f) : (int)(db + 0.5f);
+}
+
+/* The energy in bin @k of alias_buf's spectrum. */
+static float alias_bin(int k)
+{
+    float re = 0, im = 0;
+    for (int n = 0, idx = 0; n < ALIAS_LEN; n++) {
+        re += alias_buf[n] * alias_cos[idx];
+        im -= alias_buf[n] * alias_sin[idx];
+        idx = (idx + k) & (ALIAS_LEN - 1);
+    }
+
+    return re * re + im * im;
+}
+
+/* Return the ratio of the energy outside the harmonics of @bin to the energy
+ * in them, in dB. */
+static int alias_measure(int bin)
+{
+    float harmonic = 0, alias = 0;
+    for (int k = 1; k < ALIAS_LEN / 2; k++) {
+        float energy = alias_bin(k);
+        if (k % bin == 0) {
+            harmonic += energy;
+        } else {
+            alias += energy;
+        }
+    }
+
+    return bench_db(alias / harmonic);
+}
+
+static void bench_aliasing(void)
+{
+    /* ~660Hz, ~2.6kHz and ~5.3kHz */
+    static const int bins[] = { 61, 245, 491 };
+
+    alias_twiddles();
+
+    bool pass = true;
+    for (int i = 0; i < sizeof bins / sizeof bins[0]; i++) {
+        int bin = bins[i];
+        struct osc o;
+        int db[4];
+
+        for (int shape = 0; shape < 4; shape++) {
+            osc_start(&o, (uint32_t)bin << 20);
+            switch (shape) {
+            case 0:
+                osc_square(&o, alias_buf, ALIAS_LEN);
+                break;
+            case 1:
+                blep_square(&o, alias_buf, ALIAS_LEN);
+                break;
+            case 2:
+                blep_saw(&o, alias_buf, ALIAS_LEN);
+                break;
+            case 3:
+                blep_pulse(&o, 0x40000000, alias_buf, ALIAS_LEN);
+                break;
+            }
+
+            db[shape] = alias_measure(bin);
+        }
+
+        debug_printf("aliasing at %uHz: naive square %d dB, square %d dB, "
+                     "saw %d dB, 25%% pulse %d dB",
+                     bin * AUDIO_SAMPLE_RATE / ALIAS_LEN,
+                     db[0],
+                     db[1],
+                     db[2],
+                     db[3]);
+
+        /* PolyBLEP measures ~15dB under the naive square at each of these
+         * frequencies, so demand at least 12. */
+        for (int shape = 1; shape < 4; shape++) {
+            pass = pass && db[shape] <= db[0] - 12;
+        }
+    }
+
+    debug_printf("aliasing: %s", pass ? "PASS" : "FAIL");
+}
+
+/* ---------------- Kernels ---------------- */
+
+/* The outputs of every kernel in a set, run over the same inputs.  The blocks
+ * are deliberately an awkward length so that the NEON kernels' scalar tails
+ * and the phase hand-off between blocks get exercised too. */
+#define KERNEL_CHECK_LEN 1024
+#define KERNEL_CHECK_BLOCK 37
+
+/* The reverb network's kernel only takes a chunk at a time, and every
+ * combination of line count and filter order is checked. */
+#define FDN_CHECK_LEN 256
+#define FDN_CHECK_BLOCK 29
+#define FDN_CONFIGS (2 * (REVERB_MAX_ORDER + 1))
+
+/* The unison kernel is checked with a number of copies that fits in one
+ * register and one that needs two, neither of them full. */
+#define UNISON_CHECKS 2
+static const int unison_checks[UNISON_CHECKS] = { 3, 7 };
+
+/* Both half-band filters are checked, going each way.  They read ahead by
+ * their history, so they stop short of the end of their input. */
+#define HALFBAND_CHECK_LEN (KERNEL_CHECK_LEN - HALFBAND_MAX)
+static const struct {
+    const float *coef;
+    int taps;
+} halfband_checks[2] = {
+    { halfband_long, HALFBAND_LONG },
+    { halfband_short, HALFBAND_SHORT }
+};
+
+struct kernelout {
+    float saw[KERNEL_CHECK_LEN];
+    float pulse[KERNEL_CHECK_LEN];
+    float saw4[KERNEL_CHECK_LEN * VOICE_LANES];
+    float pulse4[KERNEL_CHECK_LEN * VOICE_LANES];
+    float table4[KERNEL_CHECK_LEN * VOICE_LANES];
+    float table4_cubic[KERNEL_CHECK_LEN * VOICE_LANES];
+    float svf4[KERNEL_CHECK_LEN * VOICE_LANES];
+    float unison4[UNISON_CHECKS][2][KERNEL_CHECK_LEN * VOICE_LANES];
+    float additive4[KERNEL_CHECK_LEN * VOICE_LANES];
+    float fm4[FM_ALGORITHMS][KERNEL_CHECK_LEN * VOICE_LANES];
+    float sampler4[SAMPLER_INTERPS][KERNEL_CHECK_LEN * VOICE_LANES];
+    float fdn_taps[FDN_CONFIGS][FDN_CHECK_LEN * REVERB_LINES];
+    float fdn_out[FDN_CONFIGS][FDN_CHECK_LEN * 2];
+    float reduce[KERNEL_CHECK_LEN];
+    float gain[KERNEL_CHECK_LEN];
+    float mix[KERNEL_CHECK_LEN];
+    float halfband_up[2][KERNEL_CHECK_LEN * 2];
+    float halfband_down[2][KERNEL_CHECK_LEN];
+    float drive[KERNEL_CHECK_LEN];
+    uint32_t pwm[KERNEL_CHECK_LEN * 2];
+    uint32_t quantize[KERNEL_CHECK_LEN * 2];
+};
+
+/* The reference outputs. */
+static struct kernelout kernels_out_ref;
+
+/* Fill group 0 of @vb with a spread of pitches, levels, ramps and filter
+ * settings, with one voice gated off so that the masking gets checked.  Each
+ * voice's unison copies are detuned by a quarter of a semitone. */
+static void bench_bank(struct voicebank *vb)
+{
+    static const int notes[VOICE_LANES] = { 40, 69, 100, 127 };
+    static const float damping[VOICE_LANES] = { 2.0f, 1.0f, 0.5f, 0.1f };
+    for (int lane = 0; lane < VOICE_LANES; lane++) {
+        struct svfcoeffs c;
+        svf_coeffs(&c, 60 + lane * 20, damping[lane]);
+        vb->svf_a1[lane] = c.a1;
+        vb->svf_a2[lane] = c.a2;
+        vb->svf_a3[lane] = c.a3;
+        vb->svf_ic1[0][lane] = 0.0f;
+        vb->svf_ic2[0][lane] = 0.0f;
+        vb->svf_ic1[1][lane] = 0.0f;
+        vb->svf_ic2[1][lane] = 0.0f;
+
+        for (int op = 0; op < FM_OPS; op++) {
+            vb->fm_phase[op][lane] = op * 0x30000000u;
+            vb->fm_inc[op][lane] = tuning_words[notes[lane] - op * 7];
+            vb->fm_level[op][lane] = 0.3f + 0.2f * op;
+            vb->fm_step[op][lane] = (op - lane) * 0.00002f;
+        }
+        vb->fm_fb1[lane] = 0.0f;
+        vb->fm_fb2[lane] = 0.0f;
+
+        uint32_t inc = tuning_words[notes[lane]];
+        vb->phase[lane] = lane * 0x10000000;
+        vb->inc[lane] = inc;
+        vb->inv_dt[lane] = 1.0f / (inc * PHASE_SCALE);
+        vb->level[lane] = 0.1f * (lane + 1);
+        vb->step[lane] = (lane - 1.5f) * 0.0001f;
+        vb->gate[lane] = lane == 1 ? 0 : 0xffffffff;
+        vb->width[lane] = 0x30000000 + lane * 0x10000000;
+
+        const float *detune = unison_detune[UNISON_MAX - 1];
+        for (int c = 0; c < UNISON_MAX; c++) {
+            uint32_t inc = tuning_inc(notes[lane] + 0.25f * detune[c]);
+            vb->uni_phase[lane][c] = unison_phase[c];
+            vb->uni_inc[lane][c] = inc;
+            vb->uni_inv_dt[lane][c] = 1.0f / (inc * PHASE_SCALE);
+        }
+    }
+}
+
+/* @partials partials, each @spacing times the note further up than the last,
+ * falling off like a saw's harmonics and decaying over @decay ms to a fifth of
+ * their level, the higher ones sooner.  A @decay of 0 holds them. */
+static void bench_additive_patch(struct additivepatch *p,
+                                 int partials,
+                                 float spacing,
+                                 int decay)
+{
+    p->partials = partials;
+    for (int k = 0; k < partials; k++) {
+        p->ratio[k] = 1.0f + k * spacing;
+        p->level[k] = 0.5f / (k + 1);
+        p->sustain[k] = 0.2f;
+        p->decay[k] = decay / (k + 1);
+    }
+}
+
+/* Start each voice of group 0 of @vb on @p's partials in @ab, at its pitch. */
+static void bench_partials(struct additivebank *ab,
+                           const struct voicebank *vb,
+                           const struct additivepatch *p)
+{
+    for (int lane = 0; lane < VOICE_LANES; lane++) {
+        additive_start(&ab->voice[lane], p, vb->inc[lane], true);
+        additive_tune(&ab->voice[lane], vb->inc[lane]);
+    }
+}
+
+static const char *const sampler_names[SAMPLER_INTERPS] = {
+    "linear",
+    "hermite",
+    "sinc"
+};
+
+/* The sample the sampler kernels are checked and measured with. */
+#define SAMPLER_PERIOD 3001
+#define SAMPLER_PCM_LEN 3072
+static int16_t sampler_pcm[SAMPLER_PCM_LEN];
+
+/* Fill sampler_pcm with a nearly full-scale sine of @cycles cycles every
+ * SAMPLER_PERIOD frames, which lands on an exact bin (see the aliasing tests)
+ * when it's played at a rate of SAMPLER_PERIOD / ALIAS_LEN - and so does its
+ * 16 bits' rounding, which repeats along with it.  Since it repeats, a loop of
+ * SAMPLER_PERIOD frames anywhere in it is already followed by its own start,
+ * just as tools/mkbank.c would leave it. */
+static void bench_sampler_sine(int cycles)
+{
+    for (int m = 0; m < SAMPLER_PCM_LEN; m++) {
+        uint32_t at = cycles * m % SAMPLER_PERIOD;
+        float x = fm_sine(((uint64_t)at << 32) / SAMPLER_PERIOD)
+                  * 32000.0f;
+        sampler_pcm[m] = (int16_t)(x < 0.0f ? x - 0.5f : x + 0.5f);
+    }
+}
+
+/* The loop the looped voices play: a period of the sine, after the first few
+ * frames so that the interpolation has something before it too. */
+#define SAMPLER_LOOP_START SAMPLER_REACH
+#define SAMPLER_LOOP_END (SAMPLER_REACH + SAMPLER_PERIOD)
+
+/* Start each voice of group 0 of @vb on sampler_pcm at its pitch, with 69 as
+ * the root, a quarter of the way further through it than the last.  The odd
+ * ones loop, and the even ones are one-shots: the first starts at the very
+ * start of the sample, and the other runs off the end of it. */
+static void bench_samples(struct voicebank *vb)
+{
+    for (int lane = 0; lane < VOICE_LANES; lane++) {
+        if (lane & 1) {
+            sampler_start(vb,
+                          lane,
+                          sampler_pcm,
+                          SAMPLER_PCM_LEN,
+                          SAMPLER_LOOP_START,
+                          SAMPLER_LOOP_END);
+        } else {
+            sampler_start(vb, lane, sampler_pcm, SAMPLER_PCM_LEN, 0, 0);
+        }
+        sampler_tune(vb, lane, 69, vb->inc[lane]);
+        vb->smp_pos[lane] = lane * (SAMPLER_PCM_LEN / VOICE_LANES);
+        vb->smp_frac[lane] = lane * 0x35555555u;
+    }
+}
+
+static void kernels_exercise(const struct kernels *k, struct kernelout *res)
+{
+    /* A high note, so that most blocks contain several edges. */
+    struct osc saw, pulse;
+    osc_start(&saw, tuning_words[100]);
+    osc_start(&pulse, tuning_words[100]);
+
+    static struct voicebank saw4, pulse4, table4, table4_cubic;
+    bench_bank(&saw4);
+    bench_bank(&pulse4);
+    bench_bank(&table4);
+    bench_bank(&table4_cubic);
+    for (int i = 0; i < KERNEL_CHECK_LEN * VOICE_LANES; i++) {
+        res->saw4[i] = 0.0f;
+        res->pulse4[i] = 0.0f;
+        res->table4[i] = 0.0f;
+        res->table4_cubic[i] = 0.0f;
+    }
+
+    for (int i = 0; i < KERNEL_CHECK_LEN; i += KERNEL_CHECK_BLOCK) {
+        int len = KERNEL_CHECK_LEN - i;
+        len = len < KERNEL_CHECK_BLOCK ? len : KERNEL_CHECK_BLOCK;
+        uint32_t width = 0x30000000 + i * 0x100000;
+
+        k->saw(&saw, &res->saw[i], len);
+        k->pulse(&pulse, width, &res->pulse[i], len);
+        k->saw4(&saw4, 0, &res->saw4[i * VOICE_LANES], len);
+        for (int lane = 0; lane < VOICE_LANES; lane++) {
+            pulse4.width[lane] = width + lane * 0x08000000;
+        }
+        k->pulse4(&pulse4, 0, &res->pulse4[i * VOICE_LANES], len);
+
+        /* Sweep the morph across every frame, past both ends. */
+        float morph = (i - 32) * (WAVETABLE_FRAMES + 1.0f) / KERNEL_CHECK_LEN;
+        k->table4(&table4,
+                  0,
+                  &wavetable_classic,
+                  morph,
+                  &res->table4[i * VOICE_LANES],
+                  len);
+        k->table4_cubic(&table4_cubic,
+                        0,
+                        &wavetable_classic,
+                        morph,
+                        &res->table4_cubic[i * VOICE_LANES],
+                        len);
+    }
+
+    for (int alg = 0; alg < FM_ALGORITHMS; alg++) {
+        static struct voicebank fm4;
+        bench_bank(&fm4);
+        for (int i = 0; i < KERNEL_CHECK_LEN * VOICE_LANES; i++) {
+            res->fm4[alg][i] = 0.0f;
+        }
+
+        for (int i = 0; i < KERNEL_CHECK_LEN; i += KERNEL_CHECK_BLOCK) {
+            int len = KERNEL_CHECK_LEN - i;
+            len = len < KERNEL_CHECK_BLOCK ? len : KERNEL_CHECK_BLOCK;
+            k->fm4[alg](&fm4, 0, 0.8f, &res->fm4[alg][i * VOICE_LANES], len);
+        }
+    }
+
+    for (int interp = 0; interp < SAMPLER_INTERPS; interp++) {
+        static struct voicebank sampler4;
+        bench_sampler_sine(245);
+        bench_bank(&sampler4);
+        bench_samples(&sampler4);
+        for (int i = 0; i < KERNEL_CHECK_LEN * VOICE_LANES; i++) {
+            res->sampler4[interp][i] = 0.0f;
+        }
+
+        for (int i = 0; i < KERNEL_CHECK_LEN; i += KERNEL_CHECK_BLOCK) {
+            int len = KERNEL_CHECK_LEN - i;
+            len = len < KERNEL_CHECK_BLOCK ? len : KERNEL_CHECK_BLOCK;
+            k->sampler4[interp](&sampler4,
+                                0,
+                                &res->sampler4[interp][i * VOICE_LANES],
+                                len);
+        }
+    }
+
+    /* Feed the remaining kernels from the reference saw and pulse, so that a
+     * mismatch is attributed to the right kernel. */
+    float overdriven[KERNEL_CHECK_LEN];
+    float inverted[KERNEL_CHECK_LEN];
+    for (int i = 0; i < KERNEL_CHECK_LEN; i++) {
+        res->gain[i] = kernels_out_ref.saw[i];
+        res->mix[i] = kernels_out_ref.pulse[i];
+        overdriven[i] = kernels_out_ref.saw[i] * 1.5f;
+        inverted[i] = kernels_out_ref.pulse[i] * -1.25f;
+    }
+
+    /* A high-pass mix, so that all three of the filter's outputs count. */
+    static struct voicebank svf4;
+    static const struct svfmix svfmix = { 1.0f, -0.5f, -1.0f };
+    bench_bank(&svf4);
+    for (int i = 0; i < KERNEL_CHECK_LEN * VOICE_LANES; i++) {
+        res->svf4[i] = kernels_out_ref.saw4[i];
+    }
+
+    struct dither dither;
+    dither_init(&dither);
+    for (int i = 0; i < KERNEL_CHECK_LEN; i++) {
+        res->drive[i] = overdriven[i];
+    }
+
+    for (int i = 0; i < KERNEL_CHECK_LEN; i += KERNEL_CHECK_BLOCK) {
+        int len = KERNEL_CHECK_LEN - i;
+        len = len < KERNEL_CHECK_BLOCK ? len : KERNEL_CHECK_BLOCK;
+
+        k->gain(&res->gain[i], 0.3f, len);
+        k->mix(&res->mix[i], &kernels_out_ref.saw[i], len);
+        k->interleave(&res->pwm[i * 2], &overdriven[i], &inverted[i], len);
+        k->quantize(&dither,
+                    &res->quantize[i * 2],
+                    &overdriven[i],
+                    &inverted[i],
+                    len);
+        k->reduce(&res->reduce[i],
+                  &kernels_out_ref.pulse4[i * VOICE_LANES],
+                  len);
+        k->svf4(&svf4, 0, 1, &svfmix, &res->svf4[i * VOICE_LANES], len);
+        k->drive(&res->drive[i], 1.7f, 0.8f, len);
+    }
+
+    /* The saws stand in for the filters' input, history and all. */
+    for (int f = 0; f < 2; f++) {
+        const float *coef = halfband_checks[f].coef;
+        int taps = halfband_checks[f].taps;
+        for (int i = 0; i < HALFBAND_CHECK_LEN; i += KERNEL_CHECK_BLOCK) {
+            int len = HALFBAND_CHECK_LEN - i;
+            len = len < KERNEL_CHECK_BLOCK ? len : KERNEL_CHECK_BLOCK;
+            k->halfband_up(coef,
+                           taps,
+                           &res->halfband_up[f][i * 2],
+                           &kernels_out_ref.saw[i],
+                           len);
+            k->halfband_down(coef,
+                             taps,
+                             &res->halfband_down[f][i],
+                             &kernels_out_ref.saw4[i * 2],
+                             len);
+        }
+    }
+
+    for (int u = 0; u < UNISON_CHECKS; u++) {
+        static struct voicebank unison4;
+        int copies = unison_checks[u];
+        const float (*pan)[UNISON_MAX] = unison_pan[copies - 1];
+        bench_bank(&unison4);
+        for (int i = 0; i < KERNEL_CHECK_LEN * VOICE_LANES; i++) {
+            res->unison4[u][0][i] = 0.0f;
+            res->unison4[u][1][i] = 0.0f;
+        }
+
+        for (int i = 0; i < KERNEL_CHECK_LEN; i += KERNEL_CHECK_BLOCK) {
+            int len = KERNEL_CHECK_LEN - i;
+            len = len < KERNEL_CHECK_BLOCK ? len : KERNEL_CHECK_BLOCK;
+            k->unison4(&unison4,
+                       0,
+                       copies,
+                       pan,
+                       &res->unison4[u][0][i * VOICE_LANES],
+                       &res->unison4[u][1][i * VOICE_LANES],
+                       len);
+        }
+    }
+
+    /* Inharmonic partials, a number that leaves some padding, decaying fast
+     * enough that the ramps move from block to block.  The higher notes have
+     * most of them culled. */
+    static struct voicebank additive4;
+    static struct additivebank partials;
+    static struct additivepatch patch;
+    bench_additive_patch(&patch, 21, 0.73f, 40);
+    bench_bank(&additive4);
+    bench_partials(&partials, &additive4, &patch);
+    for (int i = 0; i < KERNEL_CHECK_LEN * VOICE_LANES; i++) {
+        res->additive4[i] = 0.0f;
+    }
+
+    for (int i = 0; i < KERNEL_CHECK_LEN; i += KERNEL_CHECK_BLOCK) {
+        int len = KERNEL_CHECK_LEN - i;
+        len = len < KERNEL_CHECK_BLOCK ? len : KERNEL_CHECK_BLOCK;
+        for (int lane = 0; lane < VOICE_LANES; lane++) {
+            additive_control(&partials.voice[lane], len);
+        }
+        k->additive4(&additive4,
+                     &partials,
+                     0,
+                     &res->additive4[i * VOICE_LANES],
+                     len);
+        for (int lane = 0; lane < VOICE_LANES; lane++) {
+            additive_land(&partials.voice[lane]);
+        }
+    }
+
+    for (int c = 0; c < FDN_CONFIGS; c++) {
+        struct fdn f = {
+            .lines = c & 1 ? REVERB_LINES : 4,
+            .order = c / 2,
+            .damp = 0.7f,
+            .out = 0.25f
+        };
+        for (int i = 0; i < REVERB_LINES; i++) {
+            f.gain[i] = 0.3f - 0.01f * i;
+        }
+
+        float *taps = res->fdn_taps[c];
+        float *left = res->fdn_out[c];
+        float *right = &res->fdn_out[c][FDN_CHECK_LEN];
+        for (int i = 0; i < FDN_CHECK_LEN * REVERB_LINES; i++) {
+            taps[i] = kernels_out_ref.saw4[i];
+        }
+        for (int i = 0; i < FDN_CHECK_LEN; i++) {
+            left[i] = kernels_out_ref.saw[i];
+            right[i] = kernels_out_ref.pulse[i];
+        }
+
+        for (int i = 0; i < FDN_CHECK_LEN; i += FDN_CHECK_BLOCK) {
+            int len = FDN_CHECK_LEN - i;
+            len = len < FDN_CHECK_BLOCK ? len : FDN_CHECK_BLOCK;
+            k->fdn(&f, &taps[i * REVERB_LINES], &left[i], &right[i], len);
+        }
+    }
+}
+
+/* Compare the bits, not the values: -0.0f == 0.0f, but we promised
+ * bit-identical output. */
+static int bench_mismatch(const void *a, const void *b, int words)
+{
+    const uint32_t *x = a, *y = b;
+    for (int i = 0; i < words; i++) {
+        if (x[i] != y[i]) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+static void bench_kernel_set(const struct kernels *k)
+{
+    float a[DMA_SAMPLE_CNT], b[DMA_SAMPLE_CNT];
+    uint32_t out[DMA_SAMPLE_CNT * 2];
+    struct benchstat stat;
+    struct osc o;
+    char what[48];
+
+    osc_start(&o, tuning_words[69]);
+    bench_reset(&stat);
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        bench_begin(&stat);
+        k->saw(&o, a, DMA_SAMPLE_CNT);
+        bench_end(&stat);
+    }
+    mini_snprintf(what, sizeof what, "%s saw", k->name);
+    bench_report(what, &stat, DMA_SAMPLE_CNT);
+
+    osc_start(&o, tuning_words[69]);
+    bench_reset(&stat);
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        bench_begin(&stat);
+        k->pulse(&o, 0x40000000, b, DMA_SAMPLE_CNT);
+        bench_end(&stat);
+    }
+    mini_snprintf(what, sizeof what, "%s pulse", k->name);
+    bench_report(what, &stat, DMA_SAMPLE_CNT);
+
+    /* The voice group kernels are reported per voice-sample. */
+    static struct voicebank vb;
+    float acc[DMA_SAMPLE_CNT * VOICE_LANES] __aligned(16);
+    for (int i = 0; i < DMA_SAMPLE_CNT * VOICE_LANES; i++) {
+        acc[i] = 0.0f;
+    }
+
+    bench_bank(&vb);
+    bench_reset(&stat);
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        bench_begin(&stat);
+        k->saw4(&vb, 0, acc, DMA_SAMPLE_CNT);
+        bench_end(&stat);
+    }
+    mini_snprintf(what, sizeof what, "%s saw4", k->name);
+    bench_report(what, &stat, DMA_SAMPLE_CNT * VOICE_LANES);
+
+    bench_bank(&vb);
+    bench_reset(&stat);
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        bench_begin(&stat);
+        k->pulse4(&vb, 0, acc, DMA_SAMPLE_CNT);
+        bench_end(&stat);
+    }
+    mini_snprintf(what, sizeof what, "%s pulse4", k->name);
+    bench_report(what, &stat, DMA_SAMPLE_CNT * VOICE_LANES);
+
+    bench_bank(&vb);
+    bench_reset(&stat);
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        bench_begin(&stat);
+        k->table4(&vb, 0, &wavetable_classic, 1.5f, acc, DMA_SAMPLE_CNT);
+        bench_end(&stat);
+    }
+    mini_snprintf(what, sizeof what, "%s table4", k->name);
+    bench_report(what, &stat, DMA_SAMPLE_CNT * VOICE_LANES);
+
+    bench_bank(&vb);
+    bench_reset(&stat);
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        bench_begin(&stat);
+        k->table4_cubic(&vb, 0, &wavetable_classic, 1.5f, acc, DMA_SAMPLE_CNT);
+        bench_end(&stat);
+    }
+    mini_snprintf(what, sizeof what, "%s table4_cubic", k->name);
+    bench_report(what, &stat, DMA_SAMPLE_CNT * VOICE_LANES);
+
+    static const struct svfmix lowpass = { 0.0f, 0.0f, 1.0f };
+    bench_bank(&vb);
+    bench_reset(&stat);
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        bench_begin(&stat);
+        k->svf4(&vb, 0, 0, &lowpass, acc, DMA_SAMPLE_CNT);
+        bench_end(&stat);
+    }
+    mini_snprintf(what, sizeof what, "%s svf4", k->name);
+    bench_report(what, &stat, DMA_SAMPLE_CNT * VOICE_LANES);
+
+    /* The unison kernel is reported per copy-sample, for the voices that are
+     * sounding (three of the four). */
+    for (int u = 0; u < UNISON_CHECKS; u++) {
+        int copies = unison_checks[u];
+        bench_bank(&vb);
+        bench_reset(&stat);
+        for (int run = 0; run < BENCH_RUNS; run++) {
+            bench_begin(&stat);
+            k->unison4(&vb,
+                       0,
+                       copies,
+                       unison_pan[copies - 1],
+                       acc,
+                       acc,
+                       DMA_SAMPLE_CNT);
+            bench_end(&stat);
+        }
+        mini_snprintf(what, sizeof what, "%s unison4 x%d", k->name, copies);
+        bench_report(what, &stat, DMA_SAMPLE_CNT * 3 * copies);
+    }
+
+    bench_reset(&stat);
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        bench_begin(&stat);
+        k->reduce(b, acc, DMA_SAMPLE_CNT);
+        bench_end(&stat);
+    }
+    mini_snprintf(what, sizeof what, "%s reduce", k->name);
+    bench_report(what, &stat, DMA_SAMPLE_CNT);
+
+    bench_reset(&stat);
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        bench_begin(&stat);
+        k->gain(a, 0.999f, DMA_SAMPLE_CNT);
+        bench_end(&stat);
+    }
+    mini_snprintf(what, sizeof what, "%s gain", k->name);
+    bench_report(what, &stat, DMA_SAMPLE_CNT);
+
+    bench_reset(&stat);
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        bench_begin(&stat);
+        k->mix(b, a, DMA_SAMPLE_CNT);
+        bench_end(&stat);
+    }
+    mini_snprintf(what, sizeof what, "%s mix", k->name);
+    bench_report(what, &stat, DMA_SAMPLE_CNT);
+
+    bench_reset(&stat);
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        bench_begin(&stat);
+        k->interleave(out, a, b, DMA_SAMPLE_CNT);
+        bench_end(&stat);
+    }
+    mini_snprintf(what, sizeof what, "%s interleave", k->name);
+    bench_report(what, &stat, DMA_SAMPLE_CNT);
+
+    struct dither dither;
+    dither_init(&dither);
+    bench_reset(&stat);
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        bench_begin(&stat);
+        k->quantize(&dither, out, a, b, DMA_SAMPLE_CNT);
+        bench_end(&stat);
+    }
+    mini_snprintf(what, sizeof what, "%s quantize", k->name);
+    bench_report(what, &stat, DMA_SAMPLE_CNT);
+}
+
+static void bench_kernels(void)
+{
+    static struct kernelout neon;
+
+    bench_kernel_set(&kernels_scalar);
+    if (!cpu_has_neon()) {
+        debug_printf("kernels: no NEON on this core, skipping");
+        return;
+    }
+    bench_kernel_set(&kernels_neon);
+
+    kernels_exercise(&kernels_scalar, &kernels_out_ref);
+    kernels_exercise(&kernels_neon, &neon);
+
+    static const struct {
+        const char *what;
+        size_t offset;
+        int words;
+    } checks[] = {
+        { "saw", offsetof(struct kernelout, saw), KERNEL_CHECK_LEN },
+        { "pulse", offsetof(struct kernelout, pulse), KERNEL_CHECK_LEN },
+        {
+            "saw4",
+            offsetof(struct kernelout, saw4),
+            KERNEL_CHECK_LEN * VOICE_LANES
+        },
+        {
+            "pulse4",
+            offsetof(struct kernelout, pulse4),
+            KERNEL_CHECK_LEN * VOICE_LANES
+        },
+        {
+            "table4",
+            offsetof(struct kernelout, table4),
+            KERNEL_CHECK_LEN * VOICE_LANES
+        },
+        {
+            "table4_cubic",
+            offsetof(struct kernelout, table4_cubic),
+            KERNEL_CHECK_LEN * VOICE_LANES
+        },
+        {
+            "svf4",
+            offsetof(struct kernelout, svf4),
+            KERNEL_CHECK_LEN * VOICE_LANES
+        },
+        {
+            "additive4",
+            offsetof(struct kernelout, additive4),
+            KERNEL_CHECK_LEN * VOICE_LANES
+        },
+        { "reduce", offsetof(struct kernelout, reduce), KERNEL_CHECK_LEN },
+        { "gain", offsetof(struct kernelout, gain), KERNEL_CHECK_LEN },
+        { "mix", offsetof(struct kernelout, mix), KERNEL_CHECK_LEN },
+        {
+            "halfband_up",
+            offsetof(struct kernelout, halfband_up),
+            2 * KERNEL_CHECK_LEN * 2
+        },
+        {
+            "halfband_down",
+            offsetof(struct kernelout, halfband_down),
+            2 * KERNEL_CHECK_LEN
+        },
+        { "drive", offsetof(struct kernelout, drive), KERNEL_CHECK_LEN },
+        { "interleave", offsetof(struct kernelout, pwm), KERNEL_CHECK_LEN * 2 },
+        {
+            "quantize",
+            offsetof(struct kernelout, quantize),
+            KERNEL_CHECK_LEN * 2
+        }
+    };
+
+    bool pass = true;
+    for (int i = 0; i < sizeof checks / sizeof checks[0]; i++) {
+        int at = bench_mismatch((uint8_t *)&kernels_out_ref + checks[i].offset,
+                                (uint8_t *)&neon + checks[i].offset,
+                                checks[i].words);
+        if (at >= 0) {
+            debug_printf("kernels: neon %s differs from scalar at word %d",
+                         checks[i].what,
+                         at);
+            pass = false;
+        }
+    }
+
+    for (int alg = 0; alg < FM_ALGORITHMS; alg++) {
+        int at = bench_mismatch(kernels_out_ref.fm4[alg],
+                                neon.fm4[alg],
+                                KERNEL_CHECK_LEN * VOICE_LANES);
+        if (at >= 0) {
+            debug_printf("kernels: neon fm4 algorithm %d differs from scalar "
+                         "at word %d",
+                         alg,
+                         at);
+            pass = false;
+        }
+    }
+
+    for (int interp = 0; interp < SAMPLER_INTERPS; interp++) {
+        int at = bench_mismatch(kernels_out_ref.sampler4[interp],
+                                neon.sampler4[interp],
+                                KERNEL_CHECK_LEN * VOICE_LANES);
+        if (at >= 0) {
+            debug_printf("kernels: neon %s sampler4 differs from scalar at "
+                         "word %d",
+                         sampler_names[interp],
+                         at);
+            pass = false;
+        }
+    }
+
+    for (int u = 0; u < UNISON_CHECKS; u++) {
+        int at = bench_mismatch(kernels_out_ref.unison4[u],
+                                neon.unison4[u],
+                                2 * KERNEL_CHECK_LEN * VOICE_LANES);
+        if (at >= 0) {
+            debug_printf("kernels: neon unison4 with %d copies differs from "
+                         "scalar at word %d",
+                         unison_checks[u],
+                         at);
+            pass = false;
+        }
+    }
+
+    for (int c = 0; c < FDN_CONFIGS; c++) {
+        int taps = bench_mismatch(kernels_out_ref.fdn_taps[c],
+                                  neon.fdn_taps[c],
+                                  FDN_CHECK_LEN * REVERB_LINES);
+        int out = bench_mismatch(kernels_out_ref.fdn_out[c],
+                                 neon.fdn_out[c],
+                                 FDN_CHECK_LEN * 2);
+        if (taps >= 0 || out >= 0) {
+            debug_printf("kernels: neon fdn %d lines order %d differs from "
+                         "scalar at word %d",
+                         c & 1 ? REVERB_LINES : 4,
+                         c / 2,
+                         taps >= 0 ? taps : out);
+            pass = false;
+        }
+    }
+
+    debug_printf("kernels: neon vs scalar bit-exact %s",
+                 pass ? "PASS" : "FAIL");
+}
+
+/* ---------------- Dither ---------------- */
+
+/* The bands the quantizer is judged in: below ~4kHz, where it should leave
+ * next to no noise, and above ~16kHz, where the noise is pushed to. */
+#define DITHER_LOW_BINS 372
+#define DITHER_HIGH_BIN 1486
+
+/* Convert ALIAS_LEN samples of a sine @amplitude LSBs high at @bin, a block at
+ * a time, truncating them or with @d's dither if there is one, and leave what
+ * they came out as in alias_buf, in LSBs.  Return the furthest any of them
+ * came out from the sine. */
+static float dither_convert(const struct kernels *k,
+                            struct dither *d,
+                            int bin,
+                            float amplitude)
+{
+    float in[DMA_SAMPLE_CNT];
+    uint32_t out[DMA_SAMPLE_CNT * 2];
+    float worst = 0.0f;
+
+    for (int i = 0; i < ALIAS_LEN; i += DMA_SAMPLE_CNT) {
+        for (int j = 0; j < DMA_SAMPLE_CNT; j++) {
+            int idx = ((i + j) * bin) & (ALIAS_LEN - 1);
+            in[j] = amplitude / SAMPLE_SWING * alias_sin[idx];
+        }
+
+        if (d) {
+            k->quantize(d, out, in, in, DMA_SAMPLE_CNT);
+        } else {
+            k->interleave(out, in, in, DMA_SAMPLE_CNT);
+        }
+
+        for (int j = 0; j < DMA_SAMPLE_CNT; j++) {
+            float x = (float)((int)out[j * 2] - SAMPLE_MID);
+            float error = x - in[j] * SAMPLE_SWING;
+            error = error < 0.0f ? -error : error;
+            worst = error > worst ? error : worst;
+            alias_buf[i + j] = x;
+        }
+    }
+
+    return worst;
+}
+
+/* Split up the spectrum of a sine at @bin in alias_buf, relative to the sine
+ * itself, in dB: @db[0] is its harmonics below DITHER_LOW_BINS, all together,
+ * and @db[1] and @db[2] the average of the other bins below DITHER_LOW_BINS and
+ * above DITHER_HIGH_BIN, the noise floor in each band. */
+static void dither_spectrum(int bin, int db[3])
+{
+    float sine = alias_bin(bin);
+    float harmonics = 0.0f, low = 0.0f, high = 0.0f;
+    int low_bins = 0, high_bins = 0;
+
+    for (int k = 1; k < ALIAS_LEN / 2; k++) {
+        if (k == bin) {
+            continue;
+        } else if (k < DITHER_LOW_BINS && k % bin == 0) {
+            harmonics += alias_bin(k);
+        } else if (k < DITHER_LOW_BINS) {
+            low += alias_bin(k);
+            low_bins++;
+        } else if (k >= DITHER_HIGH_BIN) {
+            high += alias_bin(k);
+            high_bins++;
+        }
+    }
+
+    db[0] = bench_db(harmonics / sine);
+    db[1] = bench_db(low / low_bins / sine);
+    db[2] = bench_db(high / high_bins / sine);
+}
+
+static void bench_dither(void)
+{
+    /* A ~660Hz sine only 2.5 LSBs high, like the end of a note's release,
+     * where truncation turns it into something nearer a square. */
+    const struct kernels *k = kernels_select();
+    const int bin = 61;
+    const float amplitude = 2.5f;
+    struct dither d;
+    int truncated[3], shaped[3];
+
+    dither_convert(k, NULL, bin, amplitude);
+    dither_spectrum(bin, truncated);
+
+    /* Once to let the error feedback settle, and again to measure. */
+    dither_init(&d);
+    dither_convert(k, &d, bin, amplitude);
+    float worst = dither_convert(k, &d, bin, amplitude);
+    dither_spectrum(bin, shaped);
+
+    debug_printf("dither: truncated: harmonics %d dB, noise %d dB/bin "
+                 "under 4kHz, %d dB/bin over 16kHz",
+                 truncated[0],
+                 truncated[1],
+                 truncated[2]);
+    debug_printf("dither: shaped: harmonics %d dB, noise %d dB/bin "
+                 "under 4kHz, %d dB/bin over 16kHz, at most %d LSBs off",
+                 shaped[0],
+                 shaped[1],
+                 shaped[2],
+                 (int)(worst + 0.999f));
+
+    /* The harmonics should be gone into the noise, and the noise should be
+     * well out of the bottom of the band. */
+    bool ok = shaped[0] <= truncated[0] - 10
+              && shaped[1] <= shaped[2] - 20
+              && worst <= DITHER_PEAK;
+    debug_printf("dither: %s", ok ? "PASS" : "FAIL");
+}
+
+/* ---------------- Voice layout ---------------- */
+
+/* The array-of-structs voice the synth used before the voicebank, with the
+ * bookkeeping interleaved with the oscillator state. */
+struct aosvoice {
+    int note;
+    uint32_t stamp;
+    float level;
+    struct osc osc;
+};
+
+/* ... and the per-voice loop that went with it: render each sounding voice
+ * into a scratch buffer, scale it and mix it in. */
+static void aos_render(const struct kernels *k,
+                       struct aosvoice *voices,
+                       uint32_t *out,
+                       int len)
+{
+    float mix[len];
+    float voice[len];
+    for (int i = 0; i < len; i++) {
+        mix[i] = 0.0f;
+    }
+
+    for (int i = 0; i < SYNTH_VOICE_COUNT; i++) {
+        struct aosvoice *v = &voices[i];
+        if (v->note < 0) {
+            continue;
+        }
+
+        k->pulse(&v->osc, 0x80000000, voice, len);
+        k->gain(voice, v->level, len);
+        k->mix(mix, voice, len);
+    }
+
+    k->interleave(out, mix, mix, len);
+}
+
+struct layoutstat {
+    struct benchstat cycles;
+    uint32_t refills_start;
+    uint32_t accesses_start;
+    uint64_t refills;
+    uint64_t accesses;
+};
+
+static void layout_begin(struct layoutstat *l)
+{
+    l->refills_start = pmu_event_read(0);
+    l->accesses_start = pmu_event_read(1);
+    bench_begin(&l->cycles);
+}
+
+static void layout_end(struct layoutstat *l)
+{
+    bench_end(&l->cycles);
+    l->refills += pmu_event_read(0) - l->refills_start;
+    l->accesses += pmu_event_read(1) - l->accesses_start;
+}
+
+static void layout_report(const char *what, int voices, struct layoutstat *l)
+{
+    uint32_t refills = l->refills * 100 / l->cycles.runs;
+    debug_printf("%s %d voices: mean %u cycles, worst %u cycles, "
+                 "%u.%02u L1D refills/block, %u L1D accesses/block",
+                 what,
+                 voices,
+                 bench_mean(&l->cycles),
+                 l->cycles.worst,
+                 refills / 100,
+                 refills % 100,
+                 (uint32_t)(l->accesses / l->cycles.runs));
+}
+
+static void bench_layout(void)
+{
+    static const int counts[] = { 8, 16, 32 };
+
+    static struct aosvoice aos[SYNTH_VOICE_COUNT];
+    static struct synth s;
+    uint32_t out[DMA_SAMPLE_CNT * 2];
+
+    pmu_event_start(0, PMU_EVENT_L1D_REFILL);
+    pmu_event_start(1, PMU_EVENT_L1D_ACCESS);
+
+    for (int i = 0; i < sizeof counts / sizeof counts[0]; i++) {
+        int n = counts[i];
+        if (n > SYNTH_VOICE_COUNT) {
+            break;
+        }
+
+        synth_init(&s);
+        for (int v = 0; v < SYNTH_VOICE_COUNT; v++) {
+            aos[v].note = v < n ? 36 + v : -1;
+            aos[v].stamp = v;
+            aos[v].level = 0.25f;
+            osc_start(&aos[v].osc, tuning_words[36 + v]);
+
+            if (v < n) {
+                synth_note_on(&s, 36 + v, 127);
+            }
+        }
+
+        struct layoutstat l = { .refills = 0 };
+        bench_reset(&l.cycles);
+        for (int run = 0; run < BENCH_RUNS; run++) {
+            layout_begin(&l);
+            aos_render(s.kernels, aos, out, DMA_SAMPLE_CNT);
+            layout_end(&l);
+        }
+        layout_report("per-voice loop", n, &l);
+
+        l = (struct layoutstat) { .refills = 0 };
+        bench_reset(&l.cycles);
+        for (int run = 0; run < BENCH_RUNS; run++) {
+            layout_begin(&l);
+            synth_render(&s, out, DMA_SAMPLE_CNT);
+            layout_end(&l);
+        }
+        layout_report("voicebank", n, &l);
+    }
+}
+
+/* ---------------- Wavetables ---------------- */
+
+/* Render @len samples of a single full-level wavetable voice into @out, a block
+ * at a time as the synth would. */
+static void table_render(const struct kernels *k,
+                         bool cubic,
+                         float morph,
+                         uint32_t inc,
+                         float *out,
+                         int len)
+{
+    static struct voicebank vb;
+    for (int lane = 0; lane < VOICE_LANES; lane++) {
+        vb.phase[lane] = 0;
+        vb.inc[lane] = inc;
+        vb.level[lane] = 1.0f;
+        vb.step[lane] = 0.0f;
+        vb.gate[lane] = lane == 0 ? 0xffffffff : 0;
+    }
+
+    float acc[DMA_SAMPLE_CNT * VOICE_LANES] __aligned(16);
+    for (int i = 0; i < len; i += DMA_SAMPLE_CNT) {
+        for (int j = 0; j < DMA_SAMPLE_CNT * VOICE_LANES; j++) {
+            acc[j] = 0.0f;
+        }
+
+        if (cubic) {
+            k->table4_cubic(&vb, 0, &wavetable_classic, morph, acc,
+                            DMA_SAMPLE_CNT);
+        } else {
+            k->table4(&vb, 0, &wavetable_classic, morph, acc, DMA_SAMPLE_CNT);
+        }
+        k->reduce(&out[i], acc, DMA_SAMPLE_CNT);
+    }
+}
+
+static void bench_wavetables(void)
+{
+    const struct kernels *k = kernels_select();
+
+    /* The mip levels mean that nothing in the tables can alias, so what's left
+     * is the error of interpolating between points, which is worst for the
+     * bright frames at low levels. */
+    static const int bins[] = { 61, 245, 491 };
+    bool pass = true;
+    for (int i = 0; i < sizeof bins / sizeof bins[0]; i++) {
+        int bin = bins[i];
+        int db[4];
+
+        for (int shape = 0; shape < 4; shape++) {
+            bool cubic = shape & 1;
+            float morph = shape & 2 ? 3.0f : 2.0f;
+            table_render(k, cubic, morph, (uint32_t)bin << 20,
+                         alias_buf, ALIAS_LEN);
+            db[shape] = alias_measure(bin);
+        }
+
+        struct osc o;
+        osc_start(&o, (uint32_t)bin << 20);
+        osc_square(&o, alias_buf, ALIAS_LEN);
+        int naive = alias_measure(bin);
+
+        debug_printf("wavetable at %uHz: saw %d dB (cubic %d dB), "
+                     "square %d dB (cubic %d dB), naive square %d dB",
+                     bin * AUDIO_SAMPLE_RATE / ALIAS_LEN,
+                     db[0],
+                     db[1],
+                     db[2],
+                     db[3],
+                     naive);
+
+        for (int shape = 0; shape < 4; shape++) {
+            pass = pass && db[shape] <= naive - 12;
+        }
+    }
+
+    debug_printf("wavetable aliasing: %s", pass ? "PASS" : "FAIL");
+
+    /* The cost per voice-sample is what it is regardless of pitch or frame, so
+     * all that's left to see is whether a full complement of voices spread over
+     * the keyboard (and so over every level) stays in cache. */
+    static struct synth s;
+    uint32_t out[DMA_SAMPLE_CNT * 2];
+
+    pmu_event_start(0, PMU_EVENT_L1D_REFILL);
+    pmu_event_start(1, PMU_EVENT_L1D_ACCESS);
+
+    for (int cubic = 0; cubic < 2; cubic++) {
+        synth_init(&s);
+        s.patch.wave = WAVE_TABLE;
+        s.patch.morph = 1.5f;
+        s.patch.cubic = cubic;
+        for (int v = 0; v < SYNTH_VOICE_COUNT; v++) {
+            synth_note_on(&s, 24 + v * 96 / SYNTH_VOICE_COUNT, 127);
+        }
+
+        struct layoutstat l = { .refills = 0 };
+        bench_reset(&l.cycles);
+        for (int run = 0; run < BENCH_RUNS; run++) {
+            layout_begin(&l);
+            synth_render(&s, out, DMA_SAMPLE_CNT);
+            layout_end(&l);
+        }
+        layout_report(cubic ? "wavetable cubic" : "wavetable linear",
+                      SYNTH_VOICE_COUNT,
+                      &l);
+
+        uint32_t per_voice_sample = (uint32_t)(l.cycles.total * 100
+                                               / ((uint64_t)l.cycles.runs
+                                                  * DMA_SAMPLE_CNT
+                                                  * SYNTH_VOICE_COUNT));
+        debug_printf("wavetable %s: %u.%02u cycles/voice-sample",
+                     cubic ? "cubic" : "linear",
+                     per_voice_sample / 100,
+                     per_voice_sample % 100);
+    }
+}
+
+/* ---------------- Envelopes ---------------- */
+
+static void bench_envelopes(void)
+{
+    static struct env envs[SYNTH_VOICE_COUNT];
+    struct adsr adsr;
+    struct benchstat b;
+
+    /* Short segments, with the voices staggered so that every stage, and the
+     * boundaries between them, get their share of the runs. */
+    adsr_set(&adsr, 2, 5, 50, 10);
+    for (int v = 0; v < SYNTH_VOICE_COUNT; v++) {
+        env_reset(&envs[v]);
+    }
+
+    bench_reset(&b);
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        for (int v = 0; v < SYNTH_VOICE_COUNT; v++) {
+            int phase = (run + v * 3) % 40;
+            if (phase == 0) {
+                env_gate_on(&envs[v]);
+            } else if (phase == 20) {
+                env_gate_off(&envs[v]);
+            }
+        }
+
+        bench_begin(&b);
+        for (int v = 0; v < SYNTH_VOICE_COUNT; v++) {
+            env_advance(&envs[v], &adsr, DMA_SAMPLE_CNT);
+        }
+        bench_end(&b);
+    }
+
+    uint32_t per_voice = bench_mean(&b) * 100 / SYNTH_VOICE_COUNT;
+    debug_printf("envelopes %d voices: mean %u cycles, worst %u cycles per "
+                 "block, %u.%02u cycles/voice",
+                 SYNTH_VOICE_COUNT,
+                 bench_mean(&b),
+                 b.worst,
+                 per_voice / 100,
+                 per_voice % 100);
+
+    /* A released voice must go back to the pool on its own, within a block of
+     * its release time. */
+    static struct synth s;
+    uint32_t out[DMA_SAMPLE_CNT * 2];
+    synth_init(&s);
+    adsr_set(&s.patch.adsr, 1, 1, 100, 50);
+
+    synth_note_on(&s, 69, 127);
+    for (int i = 0; i < 4; i++) {
+        synth_render(&s, out, DMA_SAMPLE_CNT);
+    }
+    synth_note_off(&s, 69);
+
+    int blocks = 0;
+    while (s.active && blocks < AUDIO_SAMPLE_RATE / DMA_SAMPLE_CNT) {
+        synth_render(&s, out, DMA_SAMPLE_CNT);
+        blocks++;
+    }
+
+    int expect = (50 * AUDIO_SAMPLE_RATE / 1000 + DMA_SAMPLE_CNT - 1)
+                 / DMA_SAMPLE_CNT;
+    debug_printf("envelopes: 50ms release freed its voice after %d blocks "
+                 "(expected %d) %s",
+                 blocks,
+                 expect,
+                 !s.active && blocks <= expect + 1 ? "PASS" : "FAIL");
+}
+
+/* ---------------- FM ---------------- */
+
+static void bench_fm(void)
+{
+    /* The shared sine against the twiddles from the aliasing tests, which are
+     * good to double precision. */
+    float worst = 0.0f;
+    for (int n = 0; n < ALIAS_LEN; n++) {
+        float err = fm_sine((uint32_t)n << 20) - alias_sin[n];
+        err = err < 0.0f ? -err : err;
+        worst = err > worst ? err : worst;
+    }
+
+    int db = bench_db(worst * worst + 1e-20f);
+    debug_printf("fm sine: worst error %d dB %s",
+                 db,
+                 db <= -110 ? "PASS" : "FAIL");
+
+    /* Every algorithm costs the same four sines per voice-sample; what differs
+     * is the routing around them. */
+    static struct voicebank vb;
+    float acc[DMA_SAMPLE_CNT * VOICE_LANES] __aligned(16);
+    for (int i = 0; i < DMA_SAMPLE_CNT * VOICE_LANES; i++) {
+        acc[i] = 0.0f;
+    }
+
+    const struct kernels *sets[] = { &kernels_scalar, &kernels_neon };
+    int nsets = cpu_has_neon() ? 2 : 1;
+    for (int alg = 0; alg < FM_ALGORITHMS; alg++) {
+        uint32_t per_voice_sample[2];
+        for (int set = 0; set < nsets; set++) {
+            struct benchstat b;
+            bench_bank(&vb);
+            bench_reset(&b);
+            for (int run = 0; run < BENCH_RUNS; run++) {
+                bench_begin(&b);
+                sets[set]->fm4[alg](&vb, 0, 0.5f, acc, DMA_SAMPLE_CNT);
+                bench_end(&b);
+            }
+
+            per_voice_sample[set] = (uint32_t)(b.total * 100
+                                               / ((uint64_t)b.runs
+                                                  * DMA_SAMPLE_CNT
+                                                  * VOICE_LANES));
+        }
+
+        if (nsets > 1) {
+            debug_printf("fm algorithm %d: scalar %u.%02u, neon %u.%02u "
+                         "cycles/voice-sample",
+                         alg,
+                         per_voice_sample[0] / 100,
+                         per_voice_sample[0] % 100,
+                         per_voice_sample[1] / 100,
+                         per_voice_sample[1] % 100);
+        } else {
+            debug_printf("fm algorithm %d: scalar %u.%02u cycles/voice-sample",
+                         alg,
+                         per_voice_sample[0] / 100,
+                         per_voice_sample[0] % 100);
+        }
+    }
+}
+
+/* ---------------- Additive ---------------- */
+
+/* Render ALIAS_LEN samples of voice 0 of @vb on its partials in @ab into
+ * alias_buf, a block at a time, as the synth would. */
+static void additive_render(const struct kernels *k,
+                            struct voicebank *vb,
+                            struct additivebank *ab)
+{
+    float acc[DMA_SAMPLE_CNT * VOICE_LANES] __aligned(16);
+    for (int n = 0; n < ALIAS_LEN; n += DMA_SAMPLE_CNT) {
+        for (int i = 0; i < DMA_SAMPLE_CNT * VOICE_LANES; i++) {
+            acc[i] = 0.0f;
+        }
+
+        additive_control(&ab->voice[0], DMA_SAMPLE_CNT);
+        k->additive4(vb, ab, 0, acc, DMA_SAMPLE_CNT);
+        additive_land(&ab->voice[0]);
+
+        for (int i = 0; i < DMA_SAMPLE_CNT; i++) {
+            alias_buf[n + i] = acc[i * VOICE_LANES];
+        }
+    }
+}
+
+static void bench_additive(void)
+{
+    const struct kernels *k = kernels_select();
+    static struct voicebank vb;
+    static struct additivebank ab;
+    static struct additivepatch p;
+
+    /* One partial, and a full set of harmonics, at exact bins (see the
+     * aliasing tests): everything outside them is the phasors' rounding. */
+    static const struct {
+        int partials;
+        int bin;
+    } purity[2] = { { 1, 61 }, { ADDITIVE_PARTIALS, 5 } };
+    int spurious[2];
+    for (int t = 0; t < 2; t++) {
+        uint32_t inc = (uint32_t)purity[t].bin << 20;
+        bench_bank(&vb);
+        for (int lane = 0; lane < VOICE_LANES; lane++) {
+            vb.gate[lane] = lane ? 0 : 0xffffffff;
+        }
+        vb.level[0] = 1.0f;
+        vb.step[0] = 0.0f;
+
+        bench_additive_patch(&p, purity[t].partials, 1.0f, 0);
+        additive_start(&ab.voice[0], &p, inc, true);
+        additive_tune(&ab.voice[0], inc);
+        additive_render(k, &vb, &ab);
+        spurious[t] = alias_measure(purity[t].bin);
+    }
+
+    debug_printf("additive: spurious energy %d dB with one partial, "
+                 "%d dB with %d %s",
+                 spurious[0],
+                 spurious[1],
+                 ADDITIVE_PARTIALS,
+                 spurious[0] <= -90 && spurious[1] <= -90 ? "PASS" : "FAIL");
+
+    /* A saw's worth of harmonics loses everything from Nyquist up at note on,
+     * and the rest are padded out to a whole number of passes. */
+    static const int notes[3] = { 36, 100, 127 };
+    int kept[3];
+    bool culled = true;
+    bench_additive_patch(&p, ADDITIVE_PARTIALS, 1.0f, 0);
+    for (int n = 0; n < 3; n++) {
+        uint32_t inc = tuning_words[notes[n]];
+        int below = 0;
+        for (int h = 1; h <= ADDITIVE_PARTIALS; h++) {
+            below += inc * (float)h < 2147483648.0f;
+        }
+        int expect = (below + ADDITIVE_PACK - 1) / ADDITIVE_PACK
+                     * ADDITIVE_PACK;
+
+        additive_start(&ab.voice[0], &p, inc, true);
+        kept[n] = ab.voice[0].count;
+        culled = culled && kept[n] == expect;
+    }
+
+    debug_printf("additive: note %d renders %d partials, note %d %d, "
+                 "note %d %d %s",
+                 notes[0],
+                 kept[0],
+                 notes[1],
+                 kept[1],
+                 notes[2],
+                 kept[2],
+                 culled ? "PASS" : "FAIL");
+
+    /* Throughput: four voices of ADDITIVE_PARTIALS each, low enough that none
+     * are culled.  The partials are what a patch is sized in, so that's what
+     * this is quoted in. */
+    const struct kernels *sets[] = { &kernels_scalar, &kernels_neon };
+    int nsets = cpu_has_neon() ? 2 : 1;
+    float acc[DMA_SAMPLE_CNT * VOICE_LANES] __aligned(16);
+    for (int i = 0; i < DMA_SAMPLE_CNT * VOICE_LANES; i++) {
+        acc[i] = 0.0f;
+    }
+
+    bench_additive_patch(&p, ADDITIVE_PARTIALS, 1.0f, 1000);
+    uint64_t per_block = (uint64_t)VOICE_LANES * ADDITIVE_PARTIALS
+                         * DMA_SAMPLE_CNT;
+    for (int set = 0; set < nsets; set++) {
+        struct benchstat b;
+        bench_bank(&vb);
+        for (int lane = 0; lane < VOICE_LANES; lane++) {
+            vb.gate[lane] = 0xffffffff;
+            vb.inc[lane] = tuning_words[36 + lane];
+        }
+        bench_partials(&ab, &vb, &p);
+        for (int lane = 0; lane < VOICE_LANES; lane++) {
+            additive_control(&ab.voice[lane], DMA_SAMPLE_CNT);
+        }
+
+        bench_reset(&b);
+        for (int run = 0; run < BENCH_RUNS; run++) {
+            bench_begin(&b);
+            sets[set]->additive4(&vb, &ab, 0, acc, DMA_SAMPLE_CNT);
+            bench_end(&b);
+        }
+
+        uint32_t per_partial = (uint32_t)(b.total * 100
+                                          / (b.runs * per_block));
+        uint64_t per_second = per_block * b.runs * cycles_per_us * 1000000
+                              / b.total;
+        debug_printf("additive %s: %u.%02u cycles/partial-sample, "
+                     "%u.%02u M partial-samples/s on one core, %u partials in "
+                     "real time at %uHz",
+                     sets[set]->name,
+                     per_partial / 100,
+                     per_partial % 100,
+                     (uint32_t)(per_second / 1000000),
+                     (uint32_t)(per_second / 10000 % 100),
+                     (uint32_t)(per_second / AUDIO_SAMPLE_RATE),
+                     AUDIO_SAMPLE_RATE);
+    }
+}
+
+/* ---------------- Sampler ---------------- */
+
+/* Render ALIAS_LEN samples of voice 0 of @vb, interpolating with @interp, into
+ * alias_buf, a block at a time. */
+static void sampler_render(const struct kernels *k,
+                           struct voicebank *vb,
+                           enum sampler_interp interp)
+{
+    float acc[DMA_SAMPLE_CNT * VOICE_LANES] __aligned(16);
+    for (int n = 0; n < ALIAS_LEN; n += DMA_SAMPLE_CNT) {
+        for (int i = 0; i < DMA_SAMPLE_CNT * VOICE_LANES; i++) {
+            acc[i] = 0.0f;
+        }
+
+        k->sampler4[interp](vb, 0, acc, DMA_SAMPLE_CNT);
+
+        for (int i = 0; i < DMA_SAMPLE_CNT; i++) {
+            alias_buf[n + i] = acc[i * VOICE_LANES];
+        }
+    }
+}
+
+/* A bank of sampler_pcm, compressed, as a one-shot in zone 0 and looped in
+ * zone 1, packed as tools/mkbank.c would pack it. */
+#define SAMPLER_BANK_DATA \
+    ((sizeof(struct bank) + 2 * sizeof(struct bankzone) + BANK_ALIGN - 1) \
+     & ~(BANK_ALIGN - 1))
+#define SAMPLER_BANK_BLOCKS (SAMPLER_PCM_LEN / ADPCM_FRAMES)
+
+static uint8_t sampler_bank[SAMPLER_BANK_DATA
+                            + SAMPLER_BANK_BLOCKS
+                              * sizeof(struct adpcmblock)] __aligned(64);
+
+/* sampler_pcm decoded from one of those zones, laid out as a 16-bit zone
+ * would be. */
+static int16_t sampler_decoded[SAMPLER_PCM_LEN];
+
+/* Compress the @frames frames of @pcm into @out, as tools/mkbank.c does. */
+static void bench_adpcm_pack(struct adpcmblock *out,
+                             const int16_t *pcm,
+                             uint32_t frames)
+{
+    struct adpcm a = { 0, 0 };
+    for (uint32_t at = 0; at < frames; at += ADPCM_FRAMES, out++) {
+        out->first = pcm[at];
+        out->index = a.index;
+        out->reserved = 0;
+        a.last = out->first;
+        for (int i = 0; i < ADPCM_FRAMES / 2; i++) {
+            out->codes[i] = 0;
+        }
+
+        uint32_t n = frames - at < ADPCM_FRAMES ? frames - at : ADPCM_FRAMES;
+        for (uint32_t i = 1; i < n; i++) {
+            unsigned int code = adpcm_encode(&a, pcm[at + i]);
+            out->codes[(i - 1) >> 1] |= code << ((i - 1) & 1) * 4;
+        }
+    }
+}
+
+static const struct bank *bench_sampler_bank(void)
+{
+    struct bank *b = (struct bank *)sampler_bank;
+    b->magic = BANK_MAGIC;
+    b->version = BANK_VERSION;
+    b->zones = 2;
+    b->size = sizeof sampler_bank;
+    for (int key = 0; key < BANK_KEYS; key++) {
+        for (int vel = 0; vel < BANK_VELOCITIES; vel++) {
+            b->map[key][vel] = 0;
+        }
+    }
+
+    for (int n = 0; n < 2; n++) {
+        b->zone[n] = (struct bankzone) {
+            .lokey = 0,
+            .hikey = 127,
+            .lovel = 0,
+            .hivel = 127,
+            .root = 69,
+            .channels = 1,
+            .codec = BANK_ADPCM,
+            .frames = SAMPLER_PCM_LEN,
+            .loop_start = n ? SAMPLER_LOOP_START : 0,
+            .loop_end = n ? SAMPLER_LOOP_END : 0,
+            .data = { SAMPLER_BANK_DATA, SAMPLER_BANK_DATA }
+        };
+    }
+
+    bench_adpcm_pack((void *)&sampler_bank[SAMPLER_BANK_DATA],
+                     sampler_pcm,
+                     SAMPLER_PCM_LEN);
+    return b;
+}
+
+/* The sinc's spurious energy has to be under this at both frequencies. */
+#define SAMPLER_SINC_DB -65
+
+/* Check that every key and velocity of @b is mapped to the first zone that
+ * covers it, if there is one, and that every zone's sample is aligned and
+ * inside the bank. */
+static bool bench_bank_map(const struct bank *b)
+{
+    bool pass = bank_valid(b);
+    for (int key = 0; pass && key < BANK_KEYS; key++) {
+        for (int vel = 0; vel < BANK_VELOCITIES; vel++) {
+            int first = BANK_NONE;
+            for (int n = b->zones - 1; n >= 0; n--) {
+                const struct bankzone *z = &b->zone[n];
+                if (key >= z->lokey && key <= z->hikey
+                    && vel >= z->lovel && vel <= z->hivel) {
+                    first = n;
+                }
+            }
+            pass = pass && b->map[key][vel] == first;
+        }
+    }
+
+    for (int n = 0; pass && n < b->zones; n++) {
+        const struct bankzone *z = &b->zone[n];
+        pass = z->channels >= 1 && z->channels <= BANK_CHANNELS
+               && z->loop_end <= z->frames
+               && z->loop_start <= z->loop_end;
+        for (int ch = 0; pass && ch < BANK_CHANNELS; ch++) {
+            pass = z->data[ch] % BANK_ALIGN == 0
+                   && z->data[ch] + bank_bytes(z) <= b->size;
+        }
+    }
+    return pass;
+}
+
+static void bench_sampler(void)
+{
+    const struct kernels *k = kernels_select();
+    static struct voicebank vb;
+
+    /* The bank that's built in, as packed. */
+    const struct bank *b = &bank_default;
+    uint32_t frames = 0;
+    for (int n = 0; n < b->zones; n++) {
+        frames += b->zone[n].frames * b->zone[n].channels;
+    }
+    debug_printf("sampler: the bank has %u zones, %u frames and %u KB in "
+                 "all, mapped %s",
+                 b->zones,
+                 frames,
+                 b->size / 1024,
+                 bench_bank_map(b) ? "PASS" : "FAIL");
+
+    /* The root key plays the sample at exactly its own rate, and an octave
+     * up at twice it, to within the rounding of the tuning table. */
+    sampler_tune(&vb, 0, 60, tuning_words[60]);
+    bool root = vb.smp_step[0] == 1 && vb.smp_step_frac[0] == 0;
+    sampler_tune(&vb, 0, 60, tuning_words[72]);
+    int64_t rate = (int64_t)vb.smp_step[0] << 32 | vb.smp_step_frac[0];
+    int64_t off = rate - ((int64_t)2 << 32);
+    off = off < 0 ? -off : off;
+    uint32_t ppb = (uint32_t)(off * 1000000000 >> 33);
+    debug_printf("sampler: the root plays at rate 1 %s, an octave up is %u "
+                 "parts per billion off 2 %s",
+                 root ? "PASS" : "FAIL",
+                 ppb,
+                 ppb < 1000 ? "PASS" : "FAIL");
+
+    /* A voice that reaches the end of the sample falls silent there, and
+     * stops. */
+    float acc[DMA_SAMPLE_CNT * VOICE_LANES] __aligned(16);
+    bool ends = true;
+    bench_sampler_sine(61);
+    for (int interp = 0; interp < SAMPLER_INTERPS; interp++) {
+        bench_bank(&vb);
+        vb.gate[0] = 0xffffffff;
+        sampler_start(&vb, 0, sampler_pcm, SAMPLER_PCM_LEN, 0, 0);
+        sampler_tune(&vb, 0, 69, tuning_words[69]);
+        vb.smp_pos[0] = SAMPLER_PCM_LEN - DMA_SAMPLE_CNT / 2;
+        for (int i = 0; i < DMA_SAMPLE_CNT * VOICE_LANES; i++) {
+            acc[i] = 0.0f;
+        }
+
+        k->sampler4[interp](&vb, 0, acc, DMA_SAMPLE_CNT);
+        ends = ends && acc[0] != 0.0f;
+        for (int i = DMA_SAMPLE_CNT / 2 + SAMPLER_REACH;
+             i < DMA_SAMPLE_CNT;
+             i++) {
+            ends = ends && acc[i * VOICE_LANES] == 0.0f;
+        }
+        ends = ends && vb.smp_pos[0] == SAMPLER_PCM_LEN + SAMPLER_REACH;
+    }
+    debug_printf("sampler: voices stop at the end of the sample %s",
+                 ends ? "PASS" : "FAIL");
+
+    /* A sine played back at a rate that gives it an exact bin, slower than
+     * the sample so that the fractions are all different: everything outside
+     * the bin is the interpolation's error, plus the sample's own rounding
+     * at around -98dB.  Low down, a cubic is already about as good as the
+     * sinc's table of phases lets it be, so it's at the top that the sinc
+     * has to earn its keep. */
+    static const int bins[] = { 61, 491 };
+    int db[SAMPLER_INTERPS];
+    bool pass = true;
+    for (int i = 0; i < sizeof bins / sizeof bins[0]; i++) {
+        bench_sampler_sine(bins[i]);
+        for (int interp = 0; interp < SAMPLER_INTERPS; interp++) {
+            bench_bank(&vb);
+            vb.gate[0] = 0xffffffff;
+            vb.level[0] = 1.0f;
+            vb.step[0] = 0.0f;
+            sampler_start(&vb, 0, sampler_pcm, SAMPLER_PCM_LEN, 0, 0);
+            vb.smp_pos[0] = SAMPLER_REACH;
+            vb.smp_step[0] = 0;
+            vb.smp_step_frac[0] = ((uint64_t)SAMPLER_PERIOD << 32) / ALIAS_LEN;
+
+            sampler_render(k, &vb, interp);
+            db[interp] = alias_measure(bins[i]);
+        }
+
+        debug_printf("sampler at %uHz: spurious energy linear %d dB, "
+                     "hermite %d dB, sinc %d dB",
+                     bins[i] * AUDIO_SAMPLE_RATE / ALIAS_LEN,
+                     db[SAMPLER_LINEAR],
+                     db[SAMPLER_HERMITE],
+                     db[SAMPLER_SINC]);
+        pass = pass
+               && db[SAMPLER_HERMITE] < db[SAMPLER_LINEAR]
+               && db[SAMPLER_SINC] < db[SAMPLER_LINEAR]
+               && db[SAMPLER_SINC] <= SAMPLER_SINC_DB;
+    }
+    /* (That left the highest frequency's figures in db.) */
+    pass = pass && db[SAMPLER_SINC] < db[SAMPLER_HERMITE];
+    debug_printf("sampler: %s", pass ? "PASS" : "FAIL");
+
+    /* The same sine, looped over one period and played four times as fast,
+     * so that it goes round the loop four times and lands on four times the
+     * bin.  Any click where it goes back - a frame out, or the interpolation
+     * reading past the end, or before the start - would be spread right
+     * across the spectrum, so the loop should be as clean as the
+     * interpolation is, and every voice should still be inside it at the
+     * end.  What's before the loop is silenced so that reading any of it
+     * would click too, and the voice starts far enough in not to. */
+    bench_sampler_sine(61);
+    for (int m = 0; m < SAMPLER_LOOP_START; m++) {
+        sampler_pcm[m] = 0;
+    }
+    pass = true;
+    for (int interp = 0; interp < SAMPLER_INTERPS; interp++) {
+        bench_bank(&vb);
+        vb.gate[0] = 0xffffffff;
+        vb.level[0] = 1.0f;
+        vb.step[0] = 0.0f;
+        sampler_start(&vb,
+                      0,
+                      sampler_pcm,
+                      SAMPLER_PCM_LEN,
+                      SAMPLER_LOOP_START,
+                      SAMPLER_LOOP_END);
+        uint64_t fast = ((uint64_t)SAMPLER_PERIOD << 34) / ALIAS_LEN;
+        vb.smp_pos[0] = SAMPLER_LOOP_START + SAMPLER_REACH - 1;
+        vb.smp_step[0] = fast >> 32;
+        vb.smp_step_frac[0] = (uint32_t)fast;
+
+        sampler_render(k, &vb, interp);
+        db[interp] = alias_measure(61 * 4);
+        pass = pass
+               && vb.smp_pos[0] >= SAMPLER_LOOP_START
+               && vb.smp_pos[0] < vb.smp_end[0];
+    }
+    debug_printf("sampler: looping, spurious energy linear %d dB, hermite "
+                 "%d dB, sinc %d dB",
+                 db[SAMPLER_LINEAR],
+                 db[SAMPLER_HERMITE],
+                 db[SAMPLER_SINC]);
+    pass = pass
+           && db[SAMPLER_HERMITE] < db[SAMPLER_LINEAR]
+           && db[SAMPLER_SINC] <= SAMPLER_SINC_DB;
+    debug_printf("sampler: loops go round cleanly %s",
+                 pass ? "PASS" : "FAIL");
+
+    /* Voices playing a compressed zone render exactly what they would with
+     * it decoded up front - which for a loop means followed by its start, as
+     * tools/mkbank.c would pack it - from far below the root up to nearly as
+     * fast as they can go, through the end of a one-shot and round and round
+     * a loop. */
+    static const uint32_t rates[VOICE_LANES][2] = {
+        { 0, 0x5f000000 },
+        { 1, 0 },
+        { 3, 0x4ccccccc },
+        { SAMPLER_STEP_MAX - 1, 0xe0000000 }
+    };
+    static struct samplerbank sb;
+    static struct voicebank ref;
+    float acc_ref[DMA_SAMPLE_CNT * VOICE_LANES] __aligned(16);
+    bench_sampler_sine(245);
+    const struct bank *packed = bench_sampler_bank();
+    bool same = true;
+    for (int n = 0; n < packed->zones; n++) {
+        const struct bankzone *z = &packed->zone[n];
+        uint32_t len = z->loop_end ? z->loop_end + SAMPLER_GUARD : z->frames;
+        struct samplestream st;
+        samplestream_start(&st, packed, z, 0);
+        same = same && samplestream_read(&st, sampler_decoded, len) == len;
+
+        for (int interp = 0; interp < SAMPLER_INTERPS; interp++) {
+            bench_bank(&vb);
+            bench_bank(&ref);
+            for (int lane = 0; lane < VOICE_LANES; lane++) {
+                vb.gate[lane] = ref.gate[lane] = 0xffffffff;
+                sampler_play(&sb, &vb, lane, packed, z);
+                sampler_start(&ref,
+                              lane,
+                              sampler_decoded,
+                              len,
+                              z->loop_start,
+                              z->loop_end);
+                vb.smp_step[lane] = ref.smp_step[lane] = rates[lane][0];
+                vb.smp_step_frac[lane] = rates[lane][1];
+                ref.smp_step_frac[lane] = rates[lane][1];
+            }
+
+            /* (Long enough for all of them to reach the end of the
+             * one-shot.) */
+            for (int t = 0; t < SAMPLER_PCM_LEN; t += DMA_SAMPLE_CNT) {
+                for (int i = 0; i < DMA_SAMPLE_CNT * VOICE_LANES; i++) {
+                    acc[i] = 0.0f;
+                    acc_ref[i] = 0.0f;
+                }
+                sampler_fill(&sb, &vb, 0, DMA_SAMPLE_CNT);
+                k->sampler4[interp](&vb, 0, acc, DMA_SAMPLE_CNT);
+                k->sampler4[interp](&ref, 0, acc_ref, DMA_SAMPLE_CNT);
+                same = same
+                       && bench_mismatch(acc,
+                                         acc_ref,
+                                         DMA_SAMPLE_CNT * VOICE_LANES) < 0;
+            }
+        }
+    }
+    debug_printf("sampler: compressed voices sound as if decoded up front %s",
+                 same ? "PASS" : "FAIL");
+
+    /* Three octaves above the root is well within what a compressed zone can
+     * go to, four octaves isn't, and a 16-bit zone can go anywhere. */
+    struct bankzone pcm = packed->zone[0];
+    pcm.codec = BANK_PCM16;
+    bool playable = sampler_playable(&packed->zone[0], 69 + 36)
+                    && !sampler_playable(&packed->zone[0], 69 + 48)
+                    && sampler_playable(&pcm, 127);
+    debug_printf("sampler: compressed zones only start notes they can reach "
+                 "%s",
+                 playable ? "PASS" : "FAIL");
+
+    /* What the decoding costs, for four voices going round the loop at the
+     * root, so a frame a sample.  (The kernel's run between fills, to move
+     * them on, but it isn't timed.) */
+    struct benchstat bs;
+    bench_bank(&vb);
+    for (int lane = 0; lane < VOICE_LANES; lane++) {
+        vb.gate[lane] = 0xffffffff;
+        sampler_play(&sb, &vb, lane, packed, &packed->zone[1]);
+        sampler_tune(&vb, lane, 69, tuning_words[69]);
+    }
+    bench_reset(&bs);
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        bench_begin(&bs);
+        sampler_fill(&sb, &vb, 0, DMA_SAMPLE_CNT);
+        bench_end(&bs);
+        k->sampler4[SAMPLER_LINEAR](&vb, 0, acc, DMA_SAMPLE_CNT);
+    }
+    bench_report("sampler: ADPCM fill", &bs, DMA_SAMPLE_CNT * VOICE_LANES);
+
+    uint32_t per_block = bench_mean(&bs) / VOICE_LANES;
+    uint32_t budget = DMA_PERIOD_US * cycles_per_us;
+    uint32_t all = per_block * SYNTH_VOICE_COUNT;
+    debug_printf("sampler: decoding ADPCM is %u cycles a voice-block, "
+                 "%u.%02u a frame; for all %d voices that's %u.%02u%% of the "
+                 "%u us deadline",
+                 per_block,
+                 per_block / DMA_SAMPLE_CNT,
+                 per_block * 100 / DMA_SAMPLE_CNT % 100,
+                 SYNTH_VOICE_COUNT,
+                 all * 100 / budget,
+                 all * 10000 / budget % 100,
+                 DMA_PERIOD_US);
+
+    /* Throughput, four voices a little below the root, each restarted in
+     * the middle of the sample before every block so that none of them ever
+     * reaches the end of it. */
+    const struct kernels *sets[] = { &kernels_scalar, &kernels_neon };
+    int nsets = cpu_has_neon() ? 2 : 1;
+    for (int interp = 0; interp < SAMPLER_INTERPS; interp++) {
+        uint32_t per_voice_sample[2];
+        for (int set = 0; set < nsets; set++) {
+            struct benchstat b;
+            bench_bank(&vb);
+            for (int lane = 0; lane < VOICE_LANES; lane++) {
+                vb.gate[lane] = 0xffffffff;
+                vb.inc[lane] = tuning_words[64 + lane];
+            }
+            bench_samples(&vb);
+
+            bench_reset(&b);
+            for (int run = 0; run < BENCH_RUNS; run++) {
+                for (int lane = 0; lane < VOICE_LANES; lane++) {
+                    vb.smp_pos[lane] = 512 + lane * 256;
+                }
+                bench_begin(&b);
+                sets[set]->sampler4[interp](&vb, 0, acc, DMA_SAMPLE_CNT);
+                bench_end(&b);
+            }
+
+            per_voice_sample[set] = (uint32_t)(b.total * 100
+                                               / ((uint64_t)b.runs
+                                                  * DMA_SAMPLE_CNT
+                                                  * VOICE_LANES));
+        }
+
+        if (nsets > 1) {
+            debug_printf("sampler %s: scalar %u.%02u, neon %u.%02u "
+                         "cycles/voice-sample",
+                         sampler_names[interp],
+                         per_voice_sample[0] / 100,
+                         per_voice_sample[0] % 100,
+                         per_voice_sample[1] / 100,
+                         per_voice_sample[1] % 100);
+        } else {
+            debug_printf("sampler %s: scalar %u.%02u cycles/voice-sample",
+                         sampler_names[interp],
+                         per_voice_sample[0] / 100,
+                         per_voice_sample[0] % 100);
+        }
+    }
+}
+
+/* ---------------- Filters ---------------- */
+
+/* The level, in dB relative to full scale, of a sine at @note rendered through
+ * @s's filter once it's settled. */
+static int filter_level(struct synth *s, int note)
+{
+    uint32_t out[DMA_SAMPLE_CNT * 2];
+
+    synth_note_on(s, note, 127);
+    for (int i = 0; i < ALIAS_LEN; i += DMA_SAMPLE_CNT) {
+        synth_render(s, out, DMA_SAMPLE_CNT);
+    }
+
+    float energy = 0.0f;
+    for (int i = 0; i < ALIAS_LEN; i += DMA_SAMPLE_CNT) {
+        synth_render(s, out, DMA_SAMPLE_CNT);
+        for (int j = 0; j < DMA_SAMPLE_CNT; j++) {
+            float x = ((int)out[j * 2] - SAMPLE_MID)
+                      / (SAMPLE_SWING * VOICE_GAIN);
+            energy += x * x;
+        }
+    }
+    synth_note_off(s, note);
+
+    /* A full-scale sine has a mean square of 1/2. */
+    return bench_db(energy * 2 / ALIAS_LEN);
+}
+
+static void bench_filters(void)
+{
+    static struct synth s;
+
+    /* The filter's response to sines two octaves either side of a cutoff at
+     * A5, where a 12dB/octave slope should be down by ~24dB. */
+    static const struct {
+        const char *what;
+        enum filter_mode mode;
+        int pass, stop;
+    } cases[] = {
+        { "lowpass", FILTER_LOWPASS, 57, 105 },
+        { "highpass", FILTER_HIGHPASS, 105, 57 },
+    };
+
+    bool ok = true;
+    for (int i = 0; i < sizeof cases / sizeof cases[0]; i++) {
+        synth_init(&s);
+        s.patch.wave = WAVE_TABLE;
+        s.patch.morph = 0.0f;
+        s.patch.filter = cases[i].mode;
+        s.patch.cutoff = 81.0f;
+        s.patch.keytrack = 0.0f;
+        adsr_set(&s.patch.adsr, 0, 0, 100, 0);
+
+        int pass = filter_level(&s, cases[i].pass);
+        int stop = filter_level(&s, cases[i].stop);
+        debug_printf("filter %s: passband %d dB, stopband %d dB",
+                     cases[i].what,
+                     pass,
+                     stop);
+        ok = ok && pass >= -1 && pass <= 1 && stop <= -20;
+    }
+
+    debug_printf("filter response: %s", ok ? "PASS" : "FAIL");
+
+    /* The marginal cost of the filter in a full render, per voice-sample. */
+    struct benchstat b;
+    uint32_t out[DMA_SAMPLE_CNT * 2];
+    uint32_t cost[2];
+    for (int on = 0; on < 2; on++) {
+        synth_init(&s);
+        s.patch.wave = WAVE_SAW;
+        s.patch.filter = on ? FILTER_LOWPASS : FILTER_OFF;
+        s.patch.resonance = 0.5f;
+        for (int v = 0; v < SYNTH_VOICE_COUNT; v++) {
+            synth_note_on(&s, 36 + v, 127);
+        }
+
+        bench_reset(&b);
+        for (int run = 0; run < BENCH_RUNS; run++) {
+            bench_begin(&b);
+            synth_render(&s, out, DMA_SAMPLE_CNT);
+            bench_end(&b);
+        }
+        cost[on] = bench_mean(&b);
+    }
+
+    uint32_t per_voice_sample = cost[1] > cost[0]
+                                ? (cost[1] - cost[0]) * 100
+                                  / (DMA_SAMPLE_CNT * SYNTH_VOICE_COUNT)
+                                : 0;
+    debug_printf("filter %d voices: %u cycles unfiltered, %u filtered, "
+                 "%u.%02u cycles/voice-sample",
+                 SYNTH_VOICE_COUNT,
+                 cost[0],
+                 cost[1],
+                 per_voice_sample / 100,
+                 per_voice_sample % 100);
+}
+
+/* ---------------- Modulation ---------------- */
+
+/* Whether every sample in @out is silence, give or take the dither. */
+static bool mod_silent(const uint32_t *out, int len)
+{
+    for (int i = 0; i < len * 2; i++) {
+        if (out[i] < SAMPLE_MID - DITHER_PEAK
+            || out[i] > SAMPLE_MID + DITHER_PEAK) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void bench_modulation(void)
+{
+    static struct synth s;
+    struct patch p;
+    uint32_t out[DMA_SAMPLE_CNT * 2];
+
+    /* The mod wheel turning a voice down to nothing through the amplitude. */
+    synth_init(&s);
+    p = s.patch;
+    p.wave = WAVE_SAW;
+    adsr_set(&p.adsr, 0, 0, 100, 0);
+    p.mod[2] = (struct modroute) {
+        .source = MOD_WHEEL,
+        .via = MOD_ONE,
+        .dest = MOD_AMP,
+        .amount = -1.0f
+    };
+    synth_load(&s, &p);
+    synth_note_on(&s, 69, 127);
+
+    /* (Rendering a block more than the limiter holds back each time.) */
+    for (int i = 0; i < LIMITER_LATENCY + DMA_SAMPLE_CNT; i += DMA_SAMPLE_CNT) {
+        synth_render(&s, out, DMA_SAMPLE_CNT);
+    }
+    bool open = !mod_silent(out, DMA_SAMPLE_CNT);
+    synth_control_change(&s, 1, 127);
+    synth_render(&s, out, DMA_SAMPLE_CNT);
+    for (int i = 0; i < LIMITER_LATENCY + DMA_SAMPLE_CNT; i += DMA_SAMPLE_CNT) {
+        synth_render(&s, out, DMA_SAMPLE_CNT);
+    }
+    bool closed = mod_silent(out, DMA_SAMPLE_CNT);
+    debug_printf("mod wheel -> amp: %s", open && closed ? "PASS" : "FAIL");
+
+    /* A square LFO an octave deep should only ever leave the voice an octave
+     * either side of its note. */
+    synth_init(&s);
+    p = s.patch;
+    p.wave = WAVE_SAW;
+    p.lfo[0] = (struct lfopatch) { .shape = LFO_SQUARE, .rate = 20.0f };
+    p.mod[0] = (struct modroute) {
+        .source = MOD_LFO1,
+        .via = MOD_ONE,
+        .dest = MOD_PITCH,
+        .amount = 12.0f
+    };
+    synth_load(&s, &p);
+    synth_note_on(&s, 69, 127);
+    int up = 0, down = 0, other = 0;
+    for (int block = 0; block < 200; block++) {
+        synth_render(&s, out, DMA_SAMPLE_CNT);
+        up += s.bank.inc[0] == tuning_words[81];
+        down += s.bank.inc[0] == tuning_words[57];
+        other += s.bank.inc[0] != tuning_words[81]
+                 && s.bank.inc[0] != tuning_words[57];
+    }
+    debug_printf("lfo -> pitch: %d blocks up, %d down, %d elsewhere %s",
+                 up,
+                 down,
+                 other,
+                 up && down && !other ? "PASS" : "FAIL");
+
+    /* The cost of a full render as routes are added.  Each route here moves
+     * every voice every sub-block, so the pitch ones pay for a retune too. */
+    static const int counts[] = { 0, 1, 4, MOD_ROUTES };
+    uint32_t cost[sizeof counts / sizeof counts[0]];
+    for (int i = 0; i < sizeof counts / sizeof counts[0]; i++) {
+        synth_init(&s);
+        p = s.patch;
+        p.wave = WAVE_PULSE;
+        p.filter = FILTER_LOWPASS;
+        for (int r = 0; r < MOD_ROUTES; r++) {
+            p.mod[r] = (struct modroute) {
+                .source = r & 1 ? MOD_LFO2 : MOD_LFO1,
+                .via = r & 2 ? MOD_VELOCITY : MOD_ONE,
+                .dest = r % MOD_DESTS,
+                .amount = r < counts[i] ? 0.01f : 0.0f
+            };
+        }
+        synth_load(&s, &p);
+        for (int v = 0; v < SYNTH_VOICE_COUNT; v++) {
+            synth_note_on(&s, 36 + v, 100);
+        }
+
+        struct benchstat b;
+        bench_reset(&b);
+        for (int run = 0; run < BENCH_RUNS; run++) {
+            bench_begin(&b);
+            synth_render(&s, out, DMA_SAMPLE_CNT);
+            bench_end(&b);
+        }
+        cost[i] = bench_mean(&b);
+
+        char what[32];
+        mini_snprintf(what, sizeof what, "mod %d routes", counts[i]);
+        bench_report(what, &b, DMA_SAMPLE_CNT);
+    }
+
+    int last = sizeof counts / sizeof counts[0] - 1;
+    uint32_t per_route = cost[last] > cost[0]
+                         ? (cost[last] - cost[0]) * 100
+                           / (counts[last] * SYNTH_VOICE_COUNT * DMA_SAMPLE_CNT)
+                         : 0;
+    debug_printf("mod %d voices: %u.%02u cycles/route/voice-sample",
+                 SYNTH_VOICE_COUNT,
+                 per_route / 100,
+                 per_route % 100);
+}
+
+/* ---------------- Controllers ---------------- */
+
+static void bench_params(void)
+{
+    static struct synth s;
+    uint32_t out[DMA_SAMPLE_CNT * 2];
+
+    /* Slam the cutoff from one end of the knob to the other and watch it
+     * glide, a sub-block at a time, rather than jump. */
+    synth_init(&s);
+    s.patch.wave = WAVE_SAW;
+    s.patch.filter = FILTER_LOWPASS;
+    synth_note_on(&s, 48, 127);
+    synth_control_change(&s, 74, 127);
+    float from = s.patch.cutoff;
+    float to = params_scale(PARAM_CUTOFF, 127);
+    float worst = 0.0f;
+    int blocks = 0;
+    while (s.patch.cutoff != to && blocks < 1000) {
+        float before = s.patch.cutoff;
+        synth_render(&s, out, SYNTH_CONTROL_LEN);
+        float step = s.patch.cutoff - before;
+        worst = step > worst ? step : worst;
+        blocks++;
+    }
+
+    /* mini-printf doesn't do floats, so print hundredths. */
+    uint32_t jump = (to - from) * 100;
+    uint32_t largest = worst * 100;
+    debug_printf("params: cutoff %u.%02u -> %u.%02u in %d sub-blocks, largest "
+                 "step %u.%02u %s",
+                 (uint32_t)from,
+                 (uint32_t)(from * 100) % 100,
+                 (uint32_t)to,
+                 (uint32_t)(to * 100) % 100,
+                 blocks,
+                 largest / 100,
+                 largest % 100,
+                 s.patch.cutoff == to && largest <= jump * PARAM_SMOOTHING + 1
+                 ? "PASS"
+                 : "FAIL");
+
+    /* The cost of a full render with every voice sounding while 16 knobs are
+     * swept at once, with the controllers changing before every block.  (The
+     * control changes themselves are handled between blocks, as they are in
+     * the synth task, so only their effect on the render is counted.) */
+    static const int ccs[] = {
+        7, 16, 17, 18, 19, 70, 71, 72, 73, 74, 75, 76, 77, 78, 79, 80
+    };
+    const int nccs = sizeof ccs / sizeof ccs[0];
+    uint32_t cost[2];
+    for (int sweep = 0; sweep < 2; sweep++) {
+        synth_init(&s);
+        s.patch.wave = WAVE_PULSE;
+        s.patch.filter = FILTER_LOWPASS;
+        for (int v = 0; v < SYNTH_VOICE_COUNT; v++) {
+            synth_note_on(&s, 36 + v, 127);
+        }
+
+        struct benchstat b;
+        bench_reset(&b);
+        for (int run = 0; run < BENCH_RUNS; run++) {
+            for (int i = 0; sweep && i < nccs; i++) {
+                synth_control_change(&s, ccs[i], (run + i * 8) & 0x7f);
+            }
+
+            bench_begin(&b);
+            synth_render(&s, out, DMA_SAMPLE_CNT);
+            bench_end(&b);
+        }
+        cost[sweep] = bench_mean(&b);
+
+        char what[32];
+        mini_snprintf(what, sizeof what, "params %d swept", sweep ? nccs : 0);
+        bench_report(what, &b, DMA_SAMPLE_CNT);
+    }
+
+    uint32_t per_param = cost[1] > cost[0] ? (cost[1] - cost[0]) / nccs : 0;
+    debug_printf("params: ~%u cycles/parameter/block", per_param);
+}
+
+/* ---------------- Drive ---------------- */
+
+static void bench_drive(void)
+{
+    static const int factors[] = { 1, 2, 4 };
+    static struct drive d;
+    const struct kernels *k = kernels_select();
+    float buf[DMA_SAMPLE_CNT];
+    int db[3];
+
+    /* A ~5.3kHz sine driven hard enough to all but square it off: its odd
+     * harmonics go on well past Nyquist, and without oversampling every one
+     * of those folds back down. */
+    const int bin = 491;
+    for (int f = 0; f < 3; f++) {
+        struct drivepatch p = {
+            .gain = 8.0f,
+            .level = 0.5f,
+            .oversample = factors[f]
+        };
+
+        /* Once through to fill the filters, and again to measure. */
+        drive_init(&d);
+        for (int pass = 0; pass < 2; pass++) {
+            for (int n = 0; n < ALIAS_LEN; n++) {
+                alias_buf[n] = 0.25f * alias_sin[(n * bin) & (ALIAS_LEN - 1)];
+            }
+            for (int i = 0; i < ALIAS_LEN; i += DMA_SAMPLE_CNT) {
+                drive_process(&d, k, &p, 0, &alias_buf[i], DMA_SAMPLE_CNT);
+            }
+        }
+        db[f] = alias_measure(bin);
+    }
+
+    debug_printf("drive: aliasing at %uHz: 1x %d dB, 2x %d dB, 4x %d dB",
+                 bin * AUDIO_SAMPLE_RATE / ALIAS_LEN,
+                 db[0],
+                 db[1],
+                 db[2]);
+    bool ok = db[1] <= db[0] - 20 && db[2] <= db[1] - 10;
+    debug_printf("drive: oversampling %s", ok ? "PASS" : "FAIL");
+
+    /* Turned off in the middle of that sine and back up over silence, or
+     * moved to another rate, it mustn't bring back any of the sine from its
+     * filters. */
+    bool clean = true;
+    for (int f = 1; f < 3; f++) {
+        struct drivepatch p = {
+            .gain = 8.0f,
+            .level = 0.5f,
+            .oversample = factors[f]
+        };
+        for (int gap = 0; gap < 2; gap++) {
+            drive_init(&d);
+            for (int i = 0; i < DMA_SAMPLE_CNT; i++) {
+                buf[i] = 0.25f * alias_sin[(i * bin) & (ALIAS_LEN - 1)];
+            }
+            drive_process(&d, k, &p, 0, buf, DMA_SAMPLE_CNT);
+
+            if (gap) {
+                drive_bypass(&d, 0);
+            } else {
+                p.oversample = factors[3 - f];
+            }
+            for (int i = 0; i < DMA_SAMPLE_CNT; i++) {
+                buf[i] = 0.0f;
+            }
+            drive_process(&d, k, &p, 0, buf, DMA_SAMPLE_CNT);
+            for (int i = 0; i < DMA_SAMPLE_CNT; i++) {
+                clean = clean && buf[i] == 0.0f;
+            }
+            p.oversample = factors[f];
+        }
+    }
+    debug_printf("drive: nothing left over from before a gap %s",
+                 clean ? "PASS" : "FAIL");
+
+    for (int f = 0; f < 3; f++) {
+        struct drivepatch p = {
+            .gain = 8.0f,
+            .level = 0.5f,
+            .oversample = factors[f]
+        };
+        struct benchstat b;
+        drive_init(&d);
+        bench_reset(&b);
+        for (int run = 0; run < BENCH_RUNS; run++) {
+            for (int i = 0; i < DMA_SAMPLE_CNT; i++) {
+                buf[i] = (i & 8) ? 0.25f : -0.25f;
+            }
+            bench_begin(&b);
+            drive_process(&d, k, &p, 0, buf, DMA_SAMPLE_CNT);
+            bench_end(&b);
+        }
+
+        char what[32];
+        mini_snprintf(what, sizeof what, "drive %dx", factors[f]);
+        bench_report(what, &b, DMA_SAMPLE_CNT);
+
+        uint32_t share = b.worst * 1000 / (DMA_PERIOD_US * cycles_per_us);
+        debug_printf("drive %dx: worst case %u.%u%% of the block deadline "
+                     "per channel",
+                     factors[f],
+                     share / 10,
+                     share % 10);
+    }
+}
+
+/* ---------------- Delay ---------------- */
+
+static void bench_delay(void)
+{
+    static struct delay d;
+    float left[DMA_SAMPLE_CNT], right[DMA_SAMPLE_CNT];
+
+    /* An impulse through a 10ms ping-pong delay should come back exactly
+     * 441 samples later on the left, then half as loud another 441 later on
+     * the right, and nowhere else. */
+    struct delaypatch p = {
+        .wet = 1.0f,
+        .feedback = 0.5f,
+        .pingpong = true,
+        .time = 10.0f,
+        .bpm = 0.0f,
+        .beats = 0.0f,
+        .damping = 0.0f,
+        .mod_depth = 0.0f,
+        .mod_rate = 0.0f
+    };
+    delay_init(&d, (float *)fxmem);
+
+    /* Let the delay time settle before the impulse goes in. */
+    for (int block = 0; block < 2000; block++) {
+        for (int i = 0; i < DMA_SAMPLE_CNT; i++) {
+            left[i] = 0.0f;
+            right[i] = 0.0f;
+        }
+        delay_process(&d, &p, left, right, DMA_SAMPLE_CNT);
+    }
+
+    bool ok = true;
+    int at = 0;
+    for (int block = 0; block < 30; block++) {
+        for (int i = 0; i < DMA_SAMPLE_CNT; i++) {
+            left[i] = block == 0 && i == 0 ? 1.0f : 0.0f;
+            right[i] = left[i];
+        }
+        delay_process(&d, &p, left, right, DMA_SAMPLE_CNT);
+        for (int i = 0; i < DMA_SAMPLE_CNT; i++, at++) {
+            float l = at == 0 || at == 441 ? 1.0f : 0.0f;
+            float r = at == 0 ? 1.0f : at == 882 ? 0.5f : 0.0f;
+            float el = left[i] - l, er = right[i] - r;
+            ok = ok && el < 1e-4f && el > -1e-4f && er < 1e-4f && er > -1e-4f;
+        }
+    }
+    debug_printf("delay: ping-pong impulse response %s", ok ? "PASS" : "FAIL");
+
+    /* The cost per block doesn't depend on the settings, but measure it with
+     * everything turned on anyway, tempo-synced to a long time with the
+     * wobble going, so that the taps stray across plenty of cache lines. */
+    p = (struct delaypatch) {
+        .wet = 0.5f,
+        .feedback = 0.9f,
+        .pingpong = true,
+        .time = 0.0f,
+        .bpm = 60.0f,
+        .beats = 1.0f,
+        .damping = 0.5f,
+        .mod_depth = 5.0f,
+        .mod_rate = 3.0f
+    };
+    struct benchstat b;
+    bench_reset(&b);
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        for (int i = 0; i < DMA_SAMPLE_CNT; i++) {
+            left[i] = (i & 8) ? 0.5f : -0.5f;
+            right[i] = left[i];
+        }
+        bench_begin(&b);
+        delay_process(&d, &p, left, right, DMA_SAMPLE_CNT);
+        bench_end(&b);
+    }
+    bench_report("delay", &b, DMA_SAMPLE_CNT);
+
+    uint32_t share = b.worst * 1000 / (DMA_PERIOD_US * cycles_per_us);
+    debug_printf("delay: worst case %u.%u%% of the block deadline",
+                 share / 10,
+                 share % 10);
+}
+
+/* ---------------- Reverb ---------------- */
+
+static void bench_reverb(void)
+{
+    static struct reverb r;
+    float *mem = (float *)fxmem + 2 * DELAY_LEN;
+    float left[DMA_SAMPLE_CNT], right[DMA_SAMPLE_CNT];
+
+    /* With no damping, an impulse's tail should fall by 60dB over the decay
+     * time.  Compare 50ms windows half a second apart, well after the first
+     * echoes, for a 0.5s decay. */
+    struct reverbpatch p = {
+        .wet = 1.0f,
+        .size = 1.0f,
+        .decay = 0.5f,
+        .damping = 0.0f,
+        .lines = REVERB_LINES,
+        .order = 0
+    };
+    reverb_init(&r, mem);
+
+    const int window = AUDIO_SAMPLE_RATE / 20 / DMA_SAMPLE_CNT;
+    const int early = AUDIO_SAMPLE_RATE / 10 / DMA_SAMPLE_CNT;
+    const int late = early + AUDIO_SAMPLE_RATE / 2 / DMA_SAMPLE_CNT;
+    float energy[2] = { 0.0f, 0.0f };
+    for (int block = 0; block < late + window; block++) {
+        for (int i = 0; i < DMA_SAMPLE_CNT; i++) {
+            left[i] = block == 0 && i == 0 ? 1.0f : 0.0f;
+            right[i] = 0.0f;
+        }
+        reverb_process(&r, kernels_select(), &p, left, right, DMA_SAMPLE_CNT);
+
+        for (int w = 0; w < 2; w++) {
+            int start = w ? late : early;
+            if (block >= start && block < start + window) {
+                for (int i = 0; i < DMA_SAMPLE_CNT; i++) {
+                    energy[w] += left[i] * left[i] + right[i] * right[i];
+                }
+            }
+        }
+    }
+    int drop = bench_db(energy[0] + 1e-30f) - bench_db(energy[1] + 1e-30f);
+    debug_printf("reverb: tail fell %d dB in 0.5s (expected 60) %s",
+                 drop,
+                 drop >= 54 && drop <= 66 ? "PASS" : "FAIL");
+
+    /* The cost per block of each setting of the quality knob, so that it can
+     * be weighed against the voices it would leave room for. */
+    const struct kernels *sets[] = { &kernels_scalar, &kernels_neon };
+    int nsets = cpu_has_neon() ? 2 : 1;
+    for (int c = 0; c < FDN_CONFIGS; c++) {
+        p = (struct reverbpatch) {
+            .wet = 0.3f,
+            .size = 2.0f,
+            .decay = 2.0f,
+            .damping = 0.4f,
+            .lines = c & 1 ? REVERB_LINES : 4,
+            .order = c / 2
+        };
+
+        uint32_t cost[2] = { 0, 0 };
+        uint32_t worst = 0;
+        for (int set = 0; set < nsets; set++) {
+            reverb_init(&r, mem);
+            struct benchstat b;
+            bench_reset(&b);
+            for (int run = 0; run < BENCH_RUNS; run++) {
+                for (int i = 0; i < DMA_SAMPLE_CNT; i++) {
+                    left[i] = (i & 4) ? 0.25f : -0.25f;
+                    right[i] = -left[i];
+                }
+                bench_begin(&b);
+                reverb_process(&r, sets[set], &p, left, right, DMA_SAMPLE_CNT);
+                bench_end(&b);
+            }
+            cost[set] = bench_mean(&b);
+            worst = b.worst;
+        }
+
+        /* The deadline share is for the kernels the synth would use. */
+        uint32_t share = worst * 1000 / (DMA_PERIOD_US * cycles_per_us);
+        debug_printf("reverb %d lines, order %d damping: mean %u cycles "
+                     "scalar, %u neon, worst %u.%u%% of the block deadline",
+                     p.lines,
+                     p.order,
+                     cost[0],
+                     cost[1],
+                     share / 10,
+                     share % 10);
+    }
+}
+
+/* ---------------- Unison and chorus ---------------- */
+
+/* The levels of @s's left and right channels in dB, relative to a full-scale
+ * saw at full velocity, over a second of @note once it has settled.  The
+ * copies beat against each other, so anything shorter is at the mercy of
+ * where in the beats it falls. */
+static void unison_level(struct synth *s, int note, int db[2])
+{
+    uint32_t out[DMA_SAMPLE_CNT * 2];
+    float energy[2] = { 0.0f, 0.0f };
+    int samples = 0;
+
+    synth_note_on(s, note, 127);
+    for (int i = 0; i < ALIAS_LEN; i += DMA_SAMPLE_CNT) {
+        synth_render(s, out, DMA_SAMPLE_CNT);
+    }
+    for (; samples < AUDIO_SAMPLE_RATE; samples += DMA_SAMPLE_CNT) {
+        synth_render(s, out, DMA_SAMPLE_CNT);
+        for (int j = 0; j < DMA_SAMPLE_CNT * 2; j++) {
+            float x = ((int)out[j] - SAMPLE_MID) / (SAMPLE_SWING * VOICE_GAIN);
+            energy[j & 1] += x * x;
+        }
+    }
+    synth_note_off(s, note);
+
+    /* A full-scale saw has a mean square of 1/3. */
+    db[0] = bench_db(energy[0] * 3 / samples);
+    db[1] = bench_db(energy[1] * 3 / samples);
+}
+
+/* Whether the two channels of every sample in @out are the same, but for
+ * their dither. */
+static bool stereo_same(const uint32_t *out, int len)
+{
+    for (int i = 0; i < len; i++) {
+        int diff = (int)out[i * 2] - (int)out[i * 2 + 1];
+        if (diff < -2 * DITHER_PEAK || diff > 2 * DITHER_PEAK) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void bench_unison(void)
+{
+    static struct synth s;
+    uint32_t out[DMA_SAMPLE_CNT * 2];
+
+    /* Seven copies should sound about as loud as the one, however they're
+     * spread, and with no spread at all they should be exactly mono. */
+    int single[2], spread[2];
+    synth_init(&s);
+    s.patch.wave = WAVE_SAW;
+    adsr_set(&s.patch.adsr, 0, 0, 100, 0);
+    unison_level(&s, 60, single);
+
+    s.patch.unison = 7;
+    s.patch.detune = 0.5f;
+    unison_level(&s, 60, spread);
+
+    /* (Until the limiter's caught up, what's coming out is still the last
+     * note.) */
+    s.patch.spread = 0.0f;
+    synth_note_on(&s, 60, 127);
+    bool mono = true;
+    for (int block = 0; block < 100; block++) {
+        synth_render(&s, out, DMA_SAMPLE_CNT);
+        mono = mono
+               && (block * DMA_SAMPLE_CNT < LIMITER_LATENCY
+                   || stereo_same(out, DMA_SAMPLE_CNT));
+    }
+    synth_note_off(&s, 60);
+
+    debug_printf("unison: one saw %d/%d dB, seven spread %d/%d dB, "
+                 "unspread %s",
+                 single[0],
+                 single[1],
+                 spread[0],
+                 spread[1],
+                 mono ? "mono" : "stereo");
+    bool ok = mono;
+    for (int ch = 0; ch < 2; ch++) {
+        int diff = spread[ch] - single[ch];
+        ok = ok && diff >= -2 && diff <= 2;
+    }
+    debug_printf("unison: level and spread %s", ok ? "PASS" : "FAIL");
+
+    /* What unison saves over playing the same copies as voices of their own:
+     * a chord of four notes of seven copies each, against 28 voices, with
+     * the filter on as it usually would be for a supersaw. */
+    const int notes = 4, copies = 7;
+    uint32_t cost[2];
+    uint32_t worst = 0;
+    for (int unison = 0; unison < 2; unison++) {
+        synth_init(&s);
+        s.patch.wave = WAVE_SAW;
+        s.patch.filter = FILTER_LOWPASS;
+        s.patch.unison = unison ? copies : 1;
+        for (int v = 0; v < (unison ? notes : notes * copies); v++) {
+            synth_note_on(&s, 48 + v, 127);
+        }
+
+        struct benchstat b;
+        bench_reset(&b);
+        for (int run = 0; run < BENCH_RUNS; run++) {
+            bench_begin(&b);
+            synth_render(&s, out, DMA_SAMPLE_CNT);
+            bench_end(&b);
+        }
+        cost[unison] = bench_mean(&b);
+        worst = b.worst;
+    }
+
+    uint32_t ratio = cost[1] * 100 / cost[0];
+    uint32_t share = worst * 1000 / (DMA_PERIOD_US * cycles_per_us);
+    debug_printf("unison: %d notes x %d copies mean %u cycles, as %d voices "
+                 "%u (%u%%), worst %u.%u%% of the block deadline",
+                 notes,
+                 copies,
+                 cost[1],
+                 notes * copies,
+                 cost[0],
+                 ratio,
+                 share / 10,
+                 share % 10);
+
+    /* An impulse through the chorus with the sweep stopped should come back
+     * exactly once, at the delay time, in both channels. */
+    static struct chorus c;
+    float left[DMA_SAMPLE_CNT], right[DMA_SAMPLE_CNT];
+    struct choruspatch p = {
+        .wet = 0.5f,
+        .rate = 0.0f,
+        .delay = 10.0f,
+        .depth = 0.0f
+    };
+    chorus_init(&c, (float *)fxmem + 2 * DELAY_LEN + REVERB_LINES * REVERB_LEN);
+
+    ok = true;
+    int at = -DMA_SAMPLE_CNT;
+    for (int block = 0; block < 20; block++) {
+        for (int i = 0; i < DMA_SAMPLE_CNT; i++) {
+            left[i] = at + i == 0 ? 1.0f : 0.0f;
+            right[i] = left[i];
+        }
+        chorus_process(&c, &p, left, right, DMA_SAMPLE_CNT);
+
+        /* (The first block lets the delay time ramp into place.) */
+        for (int i = 0; block > 0 && i < DMA_SAMPLE_CNT; i++) {
+            float expect = at + i == 0 ? 1.0f : at + i == 441 ? 0.5f : 0.0f;
+            ok = ok && left[i] == expect && right[i] == expect;
+        }
+        at += DMA_SAMPLE_CNT;
+    }
+    debug_printf("chorus: impulse response %s", ok ? "PASS" : "FAIL");
+
+    p = (struct choruspatch) {
+        .wet = 0.5f,
+        .rate = 0.8f,
+        .delay = 7.0f,
+        .depth = 3.0f
+    };
+    struct benchstat b;
+    bench_reset(&b);
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        for (int i = 0; i < DMA_SAMPLE_CNT; i++) {
+            left[i] = (i & 8) ? 0.5f : -0.5f;
+            right[i] = -left[i];
+        }
+        bench_begin(&b);
+        chorus_process(&c, &p, left, right, DMA_SAMPLE_CNT);
+        bench_end(&b);
+    }
+    bench_report("chorus", &b, DMA_SAMPLE_CNT);
+}
+
+/* ---------------- Limiter ---------------- */
+
+/* Whether every sample in @out is one the PWM can play. */
+static bool limiter_fits(const uint32_t *out, int len)
+{
+    for (int i = 0; i < len * 2; i++) {
+        if (out[i] > AUDIO_PWM_RANGE
+            || out[i] < 2 * SAMPLE_MID - AUDIO_PWM_RANGE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void bench_limiter(void)
+{
+    static struct limiter l;
+    static struct synth s;
+    const struct kernels *k = kernels_select();
+    float left[DMA_SAMPLE_CNT], right[DMA_SAMPLE_CNT];
+    uint32_t out[DMA_SAMPLE_CNT * 2];
+
+    /* Something quiet should come out exactly as it went in, exactly
+     * LIMITER_LATENCY samples later. */
+    limiter_init(&l);
+    bool ok = true;
+    for (int at = 0; at < 4 * DMA_SAMPLE_CNT; at += DMA_SAMPLE_CNT) {
+        for (int i = 0; i < DMA_SAMPLE_CNT; i++) {
+            left[i] = at + i == 5 ? 0.5f : 0.0f;
+            right[i] = at + i == 5 ? -0.25f : 0.0f;
+        }
+        limiter_process(&l, left, right, DMA_SAMPLE_CNT);
+        for (int i = 0; i < DMA_SAMPLE_CNT; i++) {
+            bool due = at + i == 5 + LIMITER_LATENCY;
+            ok = ok
+                 && left[i] == (due ? 0.5f : 0.0f)
+                 && right[i] == (due ? -0.25f : 0.0f);
+        }
+    }
+    debug_printf("limiter: latency %d samples (%u us), %s",
+                 LIMITER_LATENCY,
+                 LIMITER_LATENCY * 1000000 / AUDIO_SAMPLE_RATE,
+                 ok ? "PASS" : "FAIL");
+
+    /* A sine that comes in at two and a half times full scale out of
+     * silence, with a spike of four times on top, should still all be
+     * playable, where on its own it would have been clipped. */
+    limiter_init(&l);
+    struct dither d;
+    dither_init(&d);
+    int over = 0;
+    ok = true;
+    for (int at = 0; at < ALIAS_LEN; at += DMA_SAMPLE_CNT) {
+        for (int i = 0; i < DMA_SAMPLE_CNT; i++) {
+            int n = at + i;
+            float x = 2.5f * alias_sin[(n * 61) & (ALIAS_LEN - 1)];
+            left[i] = n < ALIAS_LEN / 4 ? 0.0f : n == ALIAS_LEN / 2 ? 4.0f : x;
+            right[i] = -left[i];
+        }
+        k->interleave(out, left, right, DMA_SAMPLE_CNT);
+        over += !limiter_fits(out, DMA_SAMPLE_CNT);
+
+        limiter_process(&l, left, right, DMA_SAMPLE_CNT);
+        k->quantize(&d, out, left, right, DMA_SAMPLE_CNT);
+        ok = ok && limiter_fits(out, DMA_SAMPLE_CNT);
+    }
+    /* (The reduction is a gain, so twice its dB as a power.) */
+    int reduction = bench_db(limiter_reduction(&l));
+    debug_printf("limiter: %d of %d blocks unplayable without it, "
+                 "%d dB at most with it, %s",
+                 over,
+                 ALIAS_LEN / DMA_SAMPLE_CNT,
+                 reduction * 2,
+                 ok && over > 0 ? "PASS" : "FAIL");
+
+    /* And every voice at once, full velocity. */
+    synth_init(&s);
+    s.patch.wave = WAVE_SAW;
+    adsr_set(&s.patch.adsr, 0, 0, 100, 0);
+    for (int v = 0; v < SYNTH_VOICE_COUNT; v++) {
+        synth_note_on(&s, 36 + v, 127);
+    }
+    limiter_reduction(&s.limiter);
+    ok = true;
+    for (int block = 0; block < 200; block++) {
+        synth_render(&s, out, DMA_SAMPLE_CNT);
+        ok = ok && limiter_fits(out, DMA_SAMPLE_CNT);
+    }
+    debug_printf("limiter: %d voices turned down %d dB at most, %s",
+                 SYNTH_VOICE_COUNT,
+                 bench_db(limiter_reduction(&s.limiter)) * 2,
+                 ok ? "PASS" : "FAIL");
+
+    /* The queue's worst case is a falling ramp the length of the window,
+     * then a sample louder than all of it, which knocks the lot out. */
+    limiter_init(&l);
+    struct benchstat b;
+    bench_reset(&b);
+    uint32_t n = 0;
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        for (int i = 0; i < DMA_SAMPLE_CNT; i++, n++) {
+            uint32_t step = n % (LIMITER_AHEAD + 1);
+            left[i] = step == LIMITER_AHEAD ? 1.5f : 1.0f - step / 128.0f;
+            right[i] = left[i];
+        }
+        bench_begin(&b);
+        limiter_process(&l, left, right, DMA_SAMPLE_CNT);
+        bench_end(&b);
+    }
+    bench_report("limiter", &b, DMA_SAMPLE_CNT);
+
+    uint32_t share = b.worst * 1000 / (DMA_PERIOD_US * cycles_per_us);
+    debug_printf("limiter: worst case %u.%u%% of the block deadline",
+                 share / 10,
+                 share % 10);
+}
+
+/* ---------------- Timing ---------------- */
+
+/* Notes arrive at pseudo-random points in a run of blocks.  Either they're
+ * acted on the moment they arrive, which is how it was before they had
+ * timestamps and puts them at the start of the next block rendered, or
+ * they're queued with their arrival times for synth_render_timed().  Each
+ * note's onset is found in the output, and the spread of the delays from
+ * arrival to onset is the jitter.  The notes are far enough apart for each to
+ * have died away before the next. */
+#define TIMING_NOTES 64
+#define TIMING_GAP 8
+
+/* The system timer at the end of block @b, the first having started at 0. */
+static uint32_t timing_clock(int b)
+{
+    return (uint64_t)b * DMA_SAMPLE_CNT * 1000000 / AUDIO_SAMPLE_RATE;
+}
+
+/* Play the notes through @s, timed or not, and return the least and most
+ * delay, in samples, and how many of the notes were found. */
+static int timing_run(struct synth *s, bool timed, int *least, int *most)
+{
+    /* (Raw MIDI, status byte first: note on and off on channel 1.) */
+    uint8_t on[3] = { 0x90, 60, 127 };
+    uint8_t off[3] = { 0x80, 60, 0 };
+    uint32_t out[DMA_SAMPLE_CNT * 2];
+    uint32_t seed = 1;
+    int arrival = -1;
+    int found = 0;
+
+    /* No attack, so that the onset is the sample after the note starts, on
+     * whatever sub-block it's ramped over; and no release, so it's gone well
+     * before the next. */
+    synth_init(s);
+    struct patch p = s->patch;
+    adsr_set(&p.adsr, 0, 0, 100, 0);
+    synth_load(s, &p);
+
+    *least = DMA_SAMPLE_CNT * TIMING_GAP;
+    *most = -*least;
+    for (int b = 1; b <= TIMING_NOTES * TIMING_GAP; b++) {
+        if (b % TIMING_GAP == 1) {
+            seed = seed * DITHER_MUL + DITHER_ADD;
+            int pos = (seed >> 16) % DMA_SAMPLE_CNT;
+            uint32_t us = (pos * 1000000 + AUDIO_SAMPLE_RATE - 1)
+                          / AUDIO_SAMPLE_RATE;
+            if (timed) {
+                synth_queue(s, timing_clock(b - 1) + us, on);
+            } else {
+                synth_midi(s, on);
+            }
+            arrival = (b - 1) * DMA_SAMPLE_CNT + pos;
+        } else if (b % TIMING_GAP == 3) {
+            synth_midi(s, off);
+        }
+
+        if (timed) {
+            synth_render_timed(s, out, DMA_SAMPLE_CNT, timing_clock(b));
+        } else {
+            synth_render(s, out, DMA_SAMPLE_CNT);
+        }
+
+        for (int i = 0; arrival >= 0 && i < DMA_SAMPLE_CNT; i++) {
+            int x = (int)out[i * 2] - SAMPLE_MID;
+            if (x > 2 * DITHER_PEAK || x < -2 * DITHER_PEAK) {
+                int delay = (b - 1) * DMA_SAMPLE_CNT + i - arrival;
+                *least = delay < *least ? delay : *least;
+                *most = delay > *most ? delay : *most;
+                arrival = -1;
+                found++;
+            }
+        }
+    }
+
+    return found;
+}
+
+static void bench_timing(void)
+{
+    static struct synth s;
+    int least[2], most[2];
+    int found = timing_run(&s, false, &least[0], &most[0]);
+    found += timing_run(&s, true, &least[1], &most[1]);
+
+    /* The delays include the limiter's look-ahead.  Timestamps can't do
+     * better than the system timer's microseconds, which are a fraction of a
+     * sample. */
+    debug_printf("timing: note on to onset %d..%d samples when acted on at "
+                 "once, %d..%d when timestamped",
+                 least[0],
+                 most[0],
+                 least[1],
+                 most[1]);
+    debug_printf("timing: jitter %d samples, was %d %s",
+                 most[1] - least[1],
+                 most[0] - least[0],
+                 found == 2 * TIMING_NOTES && most[1] - least[1] <= 1
+                 ? "PASS"
+                 : "FAIL");
+
+    /* Nothing queued is left behind by an untimed render, which has nowhere
+     * to put it but its start. */
+    uint8_t on[3] = { 0x90, 60, 127 };
+    uint32_t out[DMA_SAMPLE_CNT * 2];
+    synth_init(&s);
+    for (int i = 0; i < SYNTH_EVENTS / 2; i++) {
+        synth_queue(&s, timing_clock(1000), on);
+    }
+    synth_render(&s, out, DMA_SAMPLE_CNT);
+    debug_printf("timing: %d messages left queued by an untimed render %s",
+                 s.event_count,
+                 s.event_count == 0 ? "PASS" : "FAIL");
+}
+
+/* ---------------- Cores ---------------- */
+
+/* The sounding voice groups are dealt out between this core and the workers
+ * (see synth_block()), so a full load should render up to 1 + WORKER_COUNT
+ * times as fast, less what it costs to hand the work over and wait for it,
+ * once per control sub-block.  That cost is measured on its own first, with a
+ * job that does nothing.  Then every voice plays a filtered saw, rendered on
+ * one core, then more.  The output should be the same every time, bar
+ * rounding, since only the order the groups are summed in changes - so
+ * against the one-core render, no sample of the first CORES_CHECK blocks
+ * should be off by more than the odd LSB that tips the dither. */
+#define CORES_CHECK 64
+#define CORES_TOLERANCE 2
+
+static uint32_t cores_out[CORES_CHECK][DMA_SAMPLE_CNT * 2];
+
+static void cores_idle(void *arg)
+{
+}
+
+/* Render @voices voices on @cores cores, comparing the output against
+ * cores_out unless it's the one-core render, which fills it in.  Returns the
+ * biggest difference seen. */
+static int cores_render(struct synth *s,
+                        int cores,
+                        int voices,
+                        struct benchstat *b)
+{
+    uint32_t out[DMA_SAMPLE_CNT * 2];
+    int worst = 0;
+
+    synth_init(s);
+    struct patch p = s->patch;
+    p.wave = WAVE_SAW;
+    p.filter = FILTER_LOWPASS;
+    p.resonance = 0.5f;
+    synth_load(s, &p);
+    s->cores = cores;
+    for (int v = 0; v < voices; v++) {
+        synth_note_on(s, 36 + v, 127);
+    }
+
+    bench_reset(b);
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        bench_begin(b);
+        synth_render(s, out, DMA_SAMPLE_CNT);
+        bench_end(b);
+
+        for (int i = 0; run < CORES_CHECK && i < DMA_SAMPLE_CNT * 2; i++) {
+            if (cores == 1) {
+                cores_out[run][i] = out[i];
+                continue;
+            }
+            int d = (int)out[i] - (int)cores_out[run][i];
+            d = d < 0 ? -d : d;
+            worst = d > worst ? d : worst;
+        }
+    }
+
+    return worst;
+}
+
+static void bench_cores(void)
+{
+    static struct synth s;
+    struct benchstat b;
+
+    bench_reset(&b);
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        bench_begin(&b);
+        for (int w = 0; w < WORKER_COUNT; w++) {
+            worker_post(w, cores_idle, NULL);
+        }
+        for (int w = 0; w < WORKER_COUNT; w++) {
+            worker_wait(w);
+        }
+        bench_end(&b);
+    }
+
+    int forks = (DMA_SAMPLE_CNT + SYNTH_CONTROL_LEN - 1) / SYNTH_CONTROL_LEN;
+    uint32_t sync = bench_mean(&b) * forks;
+    uint32_t budget = DMA_PERIOD_US * cycles_per_us;
+    debug_printf("cores: fork and join of %d workers: mean %u cycles, "
+                 "worst %u cycles; %u cycles a block (%u.%02u%% of %u us)",
+                 WORKER_COUNT,
+                 bench_mean(&b),
+                 b.worst,
+                 sync,
+                 sync * 100 / budget,
+                 sync * 10000 / budget % 100,
+                 DMA_PERIOD_US);
+
+    /* Extrapolate from the cost of no voices at all and the marginal cost of
+     * the full load to see how many voices would fit in the deadline. */
+    cores_render(&s, 1, 0, &b);
+    uint32_t fixed = bench_mean(&b);
+    debug_printf("cores: no voices: mean %u cycles", fixed);
+
+    uint32_t single = 0;
+    int worst = 0;
+    for (int cores = 1; cores <= 1 + WORKER_COUNT; cores++) {
+        int d = cores_render(&s, cores, SYNTH_VOICE_COUNT, &b);
+        worst = d > worst ? d : worst;
+
+        uint32_t mean = bench_mean(&b);
+        single = cores == 1 ? mean : single;
+        uint32_t speedup = (uint64_t)single * 100 / mean;
+        uint32_t per_voice = mean > fixed
+                             ? (mean - fixed) / SYNTH_VOICE_COUNT
+                             : 1;
+        per_voice = per_voice ? per_voice : 1;
+
+        char what[48];
+        mini_snprintf(what,
+                      sizeof what,
+                      "cores: %d voices on %d",
+                      SYNTH_VOICE_COUNT,
+                      cores);
+        bench_report(what, &b, DMA_SAMPLE_CNT);
+        debug_printf("cores: %d: speed-up %u.%02ux, ~%u cycles/voice, "
+                     "~%u voices fit in %u us",
+                     cores,
+                     speedup / 100,
+                     speedup % 100,
+                     per_voice,
+                     budget > fixed ? (budget - fixed) / per_voice : 0,
+                     DMA_PERIOD_US);
+    }
+
+    debug_printf("cores: output differs from one core's by at most %d %s",
+                 worst,
+                 worst <= CORES_TOLERANCE ? "PASS" : "FAIL");
+}
+
+/* ---------------- Sample ---------------- */
+
+/* samplesrc() used to convert the whole sample to the driver's format at boot,
+ * into a 500000-word array in the bss, before it could answer its first
+ * request.  That loop is timed here over a chunk of the sample, and
+ * scaled up to the whole sample to see how long startup was held up for.
+ * Now the sample stays as it's stored in the bank, and each block is read -
+ * decoded, if it's compressed - and widened as it's played, which should be
+ * next to nothing against the deadline.  The kernels should agree with the
+ * old loop exactly. */
+#define SAMPLE_CHUNK 4096
+#define SAMPLE_LEGACY_WORDS 500000
+
+static int16_t sample_l[SAMPLE_CHUNK];
+static int16_t sample_r[SAMPLE_CHUNK];
+static int16_t sample_raw[SAMPLE_CHUNK * 2];
+static uint32_t sample_legacy[SAMPLE_CHUNK * 2];
+static uint32_t sample_out[SAMPLE_CHUNK * 2];
+
+/* A chunk of the sample packed as ADPCM, as tools/mkbank.c -e adpcm would
+ * pack it, in a bank of its own. */
+#define SAMPLE_ADPCM_DATA \
+    ((sizeof(struct bank) + sizeof(struct bankzone) + BANK_ALIGN - 1) \
+     & ~(BANK_ALIGN - 1))
+#define SAMPLE_ADPCM_BYTES \
+    (SAMPLE_CHUNK / ADPCM_FRAMES * sizeof(struct adpcmblock))
+
+static uint8_t sample_adpcm[SAMPLE_ADPCM_DATA
+                            + 2 * SAMPLE_ADPCM_BYTES] __aligned(64);
+
+/* How far under the original the noise ADPCM adds has to be, in dB.  IMA
+ * ADPCM manages 20-30 on real material, so this only catches it coming out
+ * garbled. */
+#define SAMPLE_ADPCM_SNR 15
+
+/* Read the next @n frames of @left and @right into @l and @r, going back to
+ * the start at the end, as samplesrc() does with a compressed zone. */
+static void sample_read(struct samplestream *left,
+                        struct samplestream *right,
+                        int16_t *l,
+                        int16_t *r,
+                        uint32_t n)
+{
+    for (uint32_t j = 0; j < n;) {
+        uint32_t got = samplestream_read(left, &l[j], n - j);
+        samplestream_read(right, &r[j], got);
+        j += got;
+        if (j < n) {
+            samplestream_seek(left, 0);
+            samplestream_seek(right, 0);
+        }
+    }
+}
+
+/* Frame @i of the ADPCM channel @b, decoded from the top of its block in
+ * one go rather than as a stream. */
+static int16_t sample_adpcm_frame(const struct adpcmblock *b, uint32_t i)
+{
+    struct adpcm a;
+    b += i / ADPCM_FRAMES;
+    int16_t x = adpcm_block(&a, b);
+    for (uint32_t k = 1; k <= i % ADPCM_FRAMES; k++) {
+        unsigned int code = b->codes[(k - 1) >> 1] >> ((k - 1) & 1) * 4;
+        x = adpcm_decode(&a, code & 0xf);
+    }
+    return x;
+}
+
+/* The bank that's built in is kept at 16 bits, since ADPCM is lossy, but
+ * other banks can have compressed zones.  So a chunk from the middle of the
+ * sample is packed as ADPCM, and read back through a stream in reads of odd
+ * lengths that start and end all over the blocks, with a seek into the
+ * middle of one to finish.  It should come out exactly as decoding each
+ * block from its top does, and near enough the original. */
+static void bench_sample_adpcm(const struct bankzone *z)
+{
+    uint32_t n = z->frames < SAMPLE_CHUNK ? z->frames : SAMPLE_CHUNK;
+    struct samplestream left, right;
+    samplestream_start(&left, &bank_default, z, 0);
+    samplestream_start(&right, &bank_default, z, 1);
+    samplestream_seek(&left, (z->frames - n) / 2);
+    samplestream_seek(&right, (z->frames - n) / 2);
+    samplestream_read(&left, sample_l, n);
+    samplestream_read(&right, sample_r, n);
+
+    struct bank *b = (struct bank *)sample_adpcm;
+    b->magic = BANK_MAGIC;
+    b->version = BANK_VERSION;
+    b->zones = 1;
+    b->size = sizeof sample_adpcm;
+    b->zone[0] = (struct bankzone) {
+        .lokey = 0,
+        .hikey = 127,
+        .lovel = 0,
+        .hivel = 127,
+        .root = z->root,
+        .channels = 2,
+        .codec = BANK_ADPCM,
+        .frames = n,
+        .data = { SAMPLE_ADPCM_DATA, SAMPLE_ADPCM_DATA + SAMPLE_ADPCM_BYTES }
+    };
+    bench_adpcm_pack((void *)&sample_adpcm[SAMPLE_ADPCM_DATA], sample_l, n);
+    bench_adpcm_pack((void *)&sample_adpcm[SAMPLE_ADPCM_DATA
+                                           + SAMPLE_ADPCM_BYTES],
+                     sample_r,
+                     n);
+
+    const struct bankzone *packed = &b->zone[0];
+    int16_t *l = &sample_raw[0], *r = &sample_raw[SAMPLE_CHUNK];
+    samplestream_start(&left, b, packed, 0);
+    samplestream_start(&right, b, packed, 1);
+    bool same = true;
+    for (uint32_t j = 0, len = 1; same && j < n; len = len * 7 % 257 + 1) {
+        len = len < n - j ? len : n - j;
+        same = samplestream_read(&left, &l[j], len) == len
+               && samplestream_read(&right, &r[j], len) == len;
+        j += len;
+    }
+    same = same && samplestream_read(&left, l, 1) == 0;
+
+    float signal[2] = { 0.0f, 0.0f }, noise[2] = { 0.0f, 0.0f };
+    for (int ch = 0; ch < 2; ch++) {
+        const struct adpcmblock *blocks = bank_data(b, packed, ch);
+        const int16_t *in = ch ? sample_r : sample_l;
+        const int16_t *out = ch ? r : l;
+        for (uint32_t i = 0; same && i < n; i++) {
+            float d = out[i] - in[i];
+            same = out[i] == sample_adpcm_frame(blocks, i);
+            signal[ch] += (float)in[i] * in[i];
+            noise[ch] += d * d;
+        }
+    }
+
+    int16_t x;
+    uint32_t at = n / 2 + ADPCM_FRAMES / 3;
+    samplestream_seek(&left, at);
+    same = same
+           && (at >= n
+               || (samplestream_read(&left, &x, 1) == 1
+                   && x == sample_adpcm_frame(bank_data(b, packed, 0), at)));
+
+    int snr[2];
+    bool near = true;
+    for (int ch = 0; ch < 2; ch++) {
+        snr[ch] = signal[ch] > 0.0f
+                  ? bench_db(signal[ch] / (noise[ch] + 1.0f))
+                  : 0;
+        near = near && (signal[ch] == 0.0f || snr[ch] >= SAMPLE_ADPCM_SNR);
+    }
+    debug_printf("sample: %u frames as ADPCM stream as they decode %s, "
+                 "SNR %d dB left, %d dB right %s",
+                 n,
+                 same ? "PASS" : "FAIL",
+                 snr[0],
+                 snr[1],
+                 near ? "PASS" : "FAIL");
+}
+
+static void bench_sample(void)
+{
+    /* It plays the first zone of the bank.  (A short sample is repeated to
+     * fill the chunk.) */
+    const struct bankzone *z = &bank_default.zone[0];
+    uint32_t frames = z->frames;
+    uint32_t bytes = bank_bytes(z) * z->channels;
+    struct samplestream left, right;
+    samplestream_start(&left, &bank_default, z, 0);
+    samplestream_start(&right, &bank_default, z, 1);
+    sample_read(&left, &right, sample_l, sample_r, SAMPLE_CHUNK);
+    for (int i = 0; i < SAMPLE_CHUNK; i++) {
+        sample_raw[i * 2] = sample_l[i];
+        sample_raw[i * 2 + 1] = sample_r[i];
+    }
+
+    struct benchstat b;
+    bench_reset(&b);
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        bench_begin(&b);
+        for (int i = 0; i < SAMPLE_CHUNK * 2; i++) {
+            sample_legacy[i] = (uint32_t)(sample_raw[i] + (-INT16_MIN)) >> 4;
+        }
+        bench_end(&b);
+    }
+    bench_report("sample: boot-time conversion", &b, SAMPLE_CHUNK * 2);
+
+    uint32_t us = (uint64_t)bench_mean(&b) * frames
+                  / SAMPLE_CHUNK / cycles_per_us;
+    debug_printf("sample: %u frames, %u KB read-only; converting them at "
+                 "boot took ~%u us and %u KB of bss, and as words they'd "
+                 "take %u KB",
+                 frames,
+                 bytes / 1024,
+                 us,
+                 SAMPLE_LEGACY_WORDS * 4 / 1024,
+                 frames * 8 / 1024);
+
+    const struct kernels *sets[] = { &kernels_scalar, &kernels_neon };
+    int nsets = cpu_has_neon() ? 2 : 1;
+    uint32_t budget = DMA_PERIOD_US * cycles_per_us;
+    for (int set = 0; set < nsets; set++) {
+        const struct kernels *k = sets[set];
+
+        k->pcm16(sample_out, sample_l, sample_r, SAMPLE_CHUNK);
+        bool same = bench_mismatch(sample_out,
+                                   sample_legacy,
+                                   SAMPLE_CHUNK * 2) < 0;
+
+        /* Block by block through the chunk, as samplesrc() would. */
+        bench_reset(&b);
+        for (int run = 0; run < BENCH_RUNS; run++) {
+            int at = run * DMA_SAMPLE_CNT % SAMPLE_CHUNK;
+            bench_begin(&b);
+            k->pcm16(sample_out, &sample_l[at], &sample_r[at], DMA_SAMPLE_CNT);
+            bench_end(&b);
+        }
+
+        char what[32];
+        mini_snprintf(what, sizeof what, "sample: %s pcm16", k->name);
+        bench_report(what, &b, DMA_SAMPLE_CNT);
+
+        uint32_t mean = bench_mean(&b);
+        debug_printf("sample: %s widening is %u.%02u%% of the %u us "
+                     "deadline %s",
+                     k->name,
+                     mean * 100 / budget,
+                     mean * 10000 / budget % 100,
+                     DMA_PERIOD_US,
+                     same ? "PASS" : "FAIL");
+    }
+
+    /* What storing it compressed saves, and what it costs to read it a
+     * block at a time. */
+    bench_reset(&b);
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        bench_begin(&b);
+        sample_read(&left, &right, sample_l, sample_r, DMA_SAMPLE_CNT);
+        bench_end(&b);
+    }
+    bench_report("sample: reading a block", &b, DMA_SAMPLE_CNT * 2);
+
+    uint32_t raw = frames * z->channels * sizeof(int16_t);
+    uint32_t mean = bench_mean(&b);
+    debug_printf("sample: stored as %s, %u.%02u:1; reading a block is "
+                 "%u.%02u%% of the %u us deadline",
+                 z->codec == BANK_ADPCM ? "ADPCM" : "16-bit PCM",
+                 raw / bytes,
+                 raw * 100 / bytes % 100,
+                 mean * 100 / budget,
+                 mean * 10000 / budget % 100,
+                 DMA_PERIOD_US);
+
+    bench_sample_adpcm(z);
+}
+
+/* ---------------- Polyphony ---------------- */
+
+static void bench_polyphony(void)
+{
+    static const int counts[] = { 1, 2, 4, 8, 16, 32, 64 };
+
+    static struct synth s;
+    uint32_t out[DMA_SAMPLE_CNT * 2];
+    struct benchstat b;
+    uint32_t single = 0, full = 0;
+    int fullcount = 0;
+
+    synth_init(&s);
+    debug_printf("render: using %s kernels on %d cores",
+                 s.kernels->name,
+                 s.cores);
+
+    for (int i = 0; i < sizeof counts / sizeof counts[0]; i++) {
+        int n = counts[i];
+        if (n > SYNTH_VOICE_COUNT) {
+            break;
+        }
+
+        synth_init(&s);
+        for (int v = 0; v < n; v++) {
+            synth_note_on(&s, 36 + v, 127);
+        }
+
+        bench_reset(&b);
+        for (int run = 0; run < BENCH_RUNS; run++) {
+            bench_begin(&b);
+            synth_render(&s, out, DMA_SAMPLE_CNT);
+            bench_end(&b);
+        }
+
+        char what[32];
+        mini_snprintf(what, sizeof what, "render %d voices", n);
+        bench_report(what, &b, DMA_SAMPLE_CNT);
+
+        single = n == 1 ? b.worst : single;
+        full = b.worst;
+        fullcount = n;
+    }
+
+    /* Extrapolate linearly from the cost of the first voice and the marginal
+     * cost of the rest to see how many would fit in the deadline. */
+    if (fullcount > 1 && full > single) {
+        uint32_t per_voice = (full - single) / (fullcount - 1);
+        uint32_t fixed = single > per_voice ? single - per_voice : 0;
+        uint32_t budget = DMA_PERIOD_US * cycles_per_us;
+        debug_printf("render: worst case %u us at %d voices, "
+                     "~%u cycles/voice, ~%u voices fit in %u us",
+                     full / cycles_per_us,
+                     fullcount,
+                     per_voice,
+                     (budget - fixed) / per_voice,
+                     DMA_PERIOD_US);
+    }
+}
+
+void bench(void)
+{
+    bench_calibrate();
+
+    bench_oscillators();
+    bench_aliasing();
+    bench_kernels();
+    bench_dither();
+    bench_layout();
+    bench_wavetables();
+    bench_envelopes();
+    bench_fm();
+    bench_additive();
+    bench_sampler();
+    bench_filters();
+    bench_modulation();
+    bench_params();
+    bench_drive();
+    bench_delay();
+    bench_reverb();
+    bench_unison();
+    bench_limiter();
+    bench_timing();
+    bench_cores();
+    bench_sample();
+    bench_polyphony();
+
+    debug_printf("bench: done");
+    Exit();
+}
+
+#endif
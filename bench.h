@@ -0,0 +1,9 @@
+#ifndef SXLHLG_BENCH_H
+#define SXLHLG_BENCH_H
+
+/* Measure the cost of the synth's render path on the real hardware and report
+ * it over the UART.  This runs in place of the audio tasks rather than
+ * alongside them, so that nothing else competes for the core. */
+void bench(void);
+
+#endif
@@ -0,0 +1,57 @@
+#include <stdint.h>
+
+#include "blep.h"
+
+/* A naive oscillator jumps instantaneously at each discontinuity, and an
+ * instantaneous step has energy at every frequency - including all of the ones
+ * above Nyquist, which fold back down into the audible band as inharmonic
+ * aliases.  The PolyBLEP trick [1] is to subtract, in the two samples either
+ * side of each step, a 2nd-order polynomial approximation of the difference
+ * between an ideal step and a band-limited one (a 'BLEP').  That doesn't
+ * band-limit the waveform perfectly, but it knocks the aliases down by a lot
+ * for a couple of multiplies per sample, which is the right trade for a synth
+ * that wants to run 32 voices inside a 725us block.
+ *
+ * [1] V. Valimaki and A. Huovilainen, "Antialiasing Oscillators in Subtractive
+ *     Synthesis", IEEE Signal Processing Magazine, 2007. */
+
+void blep_saw(struct osc *o, float *out, int len)
+{
+    uint32_t phase = o->phase;
+    uint32_t inc = o->inc;
+    float dt = inc * PHASE_SCALE;
+    float inv_dt = 1.0f / dt;
+
+    /* The saw ramps from -1 up to 1 and then falls back down, so the step at
+     * the wrap is downward. */
+    for (int i = 0; i < len; i++) {
+        float t = phase * PHASE_SCALE;
+        out[i] = t + t - 1.0f - polyblep(t, dt, inv_dt);
+        phase += inc;
+    }
+
+    o->phase = phase;
+}
+
+void blep_pulse(struct osc *o, uint32_t width, float *out, int len)
+{
+    uint32_t phase = o->phase;
+    uint32_t inc = o->inc;
+    float dt = inc * PHASE_SCALE;
+    float inv_dt = 1.0f / dt;
+
+    /* A pulse has two steps per cycle: up at phase 0 and down at @width.  The
+     * second one is corrected with the same polynomial, evaluated at the phase
+     * relative to the falling edge (which the accumulator conveniently wraps
+     * for us). */
+    for (int i = 0; i < len; i++) {
+        float t = phase * PHASE_SCALE;
+        float t2 = (uint32_t)(phase - width) * PHASE_SCALE;
+        float sample = phase < width ? 1.0f : -1.0f;
+        sample += polyblep(t, dt, inv_dt) - polyblep(t2, dt, inv_dt);
+        out[i] = sample;
+        phase += inc;
+    }
+
+    o->phase = phase;
+}
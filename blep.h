@@ -0,0 +1,42 @@
+#ifndef SXLHLG_BLEP_H
+#define SXLHLG_BLEP_H
+
+#include <stdint.h>
+
+#include "osc.h"
+
+/* Band-limited versions of the classic analog waveforms, built on the same
+ * phase accumulator as the naive oscillators.  Each writes @len samples of the
+ * unit-amplitude waveform to @out. */
+
+void blep_saw(struct osc *o, float *out, int len);
+
+/* @width is the fraction of the cycle spent high, in the same 0.32 fixed point
+ * as the phase. */
+void blep_pulse(struct osc *o, uint32_t width, float *out, int len);
+
+static inline void blep_square(struct osc *o, float *out, int len)
+{
+    blep_pulse(o, 0x80000000, out, len);
+}
+
+/* Convert 0.32 fixed point to a float in [0, 1]. */
+#define PHASE_SCALE (1.0f / 4294967296.0f)
+
+/* The correction to apply at phase @t (in cycles) for a unit upward step at
+ * phase 0, given the phase increment @dt and its reciprocal.  This is shared
+ * with the NEON kernels so that their scalar tails agree bit-for-bit. */
+static inline float polyblep(float t, float dt, float inv_dt)
+{
+    if (t < dt) {
+        float x = t * inv_dt;
+        return x + x - x * x - 1.0f;
+    } else if (t > 1.0f - dt) {
+        float x = (t - 1.0f) * inv_dt;
+        return x * x + x + x + 1.0f;
+    }
+
+    return 0.0f;
+}
+
+#endif
@@ -50,6 +50,10 @@
 /* How large should the stack allocated for handling FIQ exceptions be? */
 #define CONFIG_FIQ_STACK_SIZE CONFIG_TASK_STACK_SIZE
 
+/* How large should the stacks the worker cores (2 and 3) run their jobs on
+ * be? (see worker.h) */
+#define CONFIG_WORKER_STACK_SIZE CONFIG_TASK_STACK_SIZE
+
 /* How big should the chunks in the USPi platform mempool be? */
 #define CONFIG_USPI_MEMPOOL_SIZE 4096
 
@@ -65,4 +69,29 @@
 /* Should the timer interrupt be enabled? */
 //#define CONFIG_ENABLE_TIMER
 
+/* How many notes can the synth sound at once? */
+#define CONFIG_SYNTH_VOICE_COUNT 32
+
+/* How many samples long should each channel of the synth's delay be?  Must be a
+ * power of two. */
+#define CONFIG_SYNTH_DELAY_LEN (1 << 16) /* ~1.5s */
+
+/* How many samples long should each of the synth's reverb lines be?  Must be a
+ * power of two. */
+#define CONFIG_SYNTH_REVERB_LEN (1 << 13) /* ~190ms */
+
+/* How many samples long should each channel of the synth's chorus be?  Must be a
+ * power of two. */
+#define CONFIG_SYNTH_CHORUS_LEN (1 << 11) /* ~46ms */
+
+/* How much memory should be set aside at startup for the synth's effects? (Two
+ * delay lines, eight reverb lines and two chorus lines of floats.) */
+#define CONFIG_FX_MEMORY_SIZE \
+    ((2 * CONFIG_SYNTH_DELAY_LEN + 8 * CONFIG_SYNTH_REVERB_LEN \
+      + 2 * CONFIG_SYNTH_CHORUS_LEN) * 4)
+
+/* Should the application run the synth benchmarks and report the results over
+ * the UART instead of making any sound? */
+//#define CONFIG_SYNTH_BENCH
+
 #endif
@@ -0,0 +1,55 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "cpu.h"
+
+/* MVFR1 (Section B6.1.39 of the ARM Architecture Reference Manual) describes
+ * which parts of Advanced SIMD are implemented.  We need the integer and
+ * single-precision floating point instructions as well as the loads and
+ * stores. */
+#define MVFR1_ASIMD_LDST_SHIFT 8
+#define MVFR1_ASIMD_INT_SHIFT 12
+#define MVFR1_ASIMD_SPFP_SHIFT 16
+#define MVFR1_FIELD_MASK 0xf
+
+/* Even when it's implemented, Advanced SIMD can be disabled separately from the
+ * VFP by the CPACR. */
+#define CPACR_ASEDIS (1 << 31)
+
+/* NEON always flushes denormals to zero, whatever the FPSCR says.  Asking the
+ * VFP to do the same keeps the scalar kernels agreeing with the NEON ones, and
+ * keeps the decaying tails of recursive filters from ever getting slow. */
+#define FPSCR_FZ (1 << 24)
+
+static bool neon;
+
+uint8_t *cpu_init(uint8_t *pool)
+{
+    uint32_t mvfr1, cpacr;
+    asm volatile ("vmrs %0, mvfr1" : "=r" (mvfr1));
+    asm volatile ("mrc p15, 0, %0, c1, c0, 2" : "=r" (cpacr));
+
+    neon = ((mvfr1 >> MVFR1_ASIMD_LDST_SHIFT) & MVFR1_FIELD_MASK)
+           && ((mvfr1 >> MVFR1_ASIMD_INT_SHIFT) & MVFR1_FIELD_MASK)
+           && ((mvfr1 >> MVFR1_ASIMD_SPFP_SHIFT) & MVFR1_FIELD_MASK)
+           && !(cpacr & CPACR_ASEDIS);
+
+    /* The engine doesn't save the FPSCR across context switches either, so
+     * setting it once here sets it for every task on this core.  Each core
+     * has its own, though, so the workers set theirs too (see worker.c). */
+    cpu_init_fp();
+
+    return pool;
+}
+
+void cpu_init_fp(void)
+{
+    uint32_t fpscr;
+    asm volatile ("vmrs %0, fpscr" : "=r" (fpscr));
+    asm volatile ("vmsr fpscr, %0" : : "r" (fpscr | FPSCR_FZ));
+}
+
+bool cpu_has_neon(void)
+{
+    return neon;
+}
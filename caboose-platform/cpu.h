@@ -0,0 +1,20 @@
+#ifndef CABOOSE_PLATFORM_CPU_H
+#define CABOOSE_PLATFORM_CPU_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Probe the optional features of the core we're running on, and set up the
+ * floating point unit.  The ID registers are only readable from privileged
+ * modes, so we do this once during platform initialization and cache the
+ * answers for userspace. */
+uint8_t *cpu_init(uint8_t *pool);
+
+/* Set up the floating point unit of the core we're running on the same way
+ * cpu_init() does, for cores that don't run it. */
+void cpu_init_fp(void);
+
+/* Is the Advanced SIMD (NEON) unit present and enabled? */
+bool cpu_has_neon(void);
+
+#endif
@@ -0,0 +1,14 @@
+#include <stdint.h>
+
+#include <caboose/config.h>
+#include <caboose/util.h>
+
+#include "fxmem.h"
+
+uint8_t *fxmem;
+
+uint8_t *fxmem_init(uint8_t *pool)
+{
+    fxmem = (uint8_t *)ALIGN((uintptr_t)pool, 64);
+    return fxmem + CONFIG_FX_MEMORY_SIZE;
+}
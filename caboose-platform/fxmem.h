@@ -0,0 +1,14 @@
+#ifndef CABOOSE_PLATFORM_FXMEM_H
+#define CABOOSE_PLATFORM_FXMEM_H
+
+#include <stdint.h>
+
+/* The memory set aside at startup for the synth's effects: their delay lines
+ * run to hundreds of kilobytes, far too much for a task stack, and there's no
+ * allocator to ask for it later.  CONFIG_FX_MEMORY_SIZE bytes, aligned to a
+ * cache line.  It isn't cleared - that's up to whoever uses it. */
+extern uint8_t *fxmem;
+
+uint8_t *fxmem_init(uint8_t *pool);
+
+#endif
@@ -8,6 +8,7 @@
 
 struct usbmidipkt {
     uint32_t len;
+    uint32_t stamp;     /* the system timer when the packet arrived */
     uint8_t __aligned(4) packet[CONFIG_USB_PACKET_BUF_SIZE];
 };
 
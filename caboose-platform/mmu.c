@@ -98,7 +98,9 @@ struct mmu_section_descriptor {
     uint32_t domain : 4;        /* see section 3.5 */
     uint32_t impl2 : 1;         /* don't touch, should be 0 */
     uint32_t access : 2;        /* see section 3.4 */
-    uint32_t impl3 : 8;         /* don't touch, should be 0 */
+    uint32_t impl3 : 4;         /* don't touch, should be 0 */
+    uint32_t shareable : 1;     /* kept coherent between the cores */
+    uint32_t impl4 : 3;         /* don't touch, should be 0 */
     uint32_t baseaddr : 12;     /* base address of the described section */
 };
 
@@ -136,6 +138,11 @@ void mmu_init(void *tablemem)
             .impl2 = 0,
             .access = 0b10, /* system access only */
             .impl3 = 0,
+            /* The worker cores render from the same state as the main core
+             * (see worker.h), and it's only because RAM is shareable that
+             * their caches are kept coherent with each other's. */
+            .shareable = 1,
+            .impl4 = 0,
             .baseaddr = i
         };
     }
@@ -151,6 +158,8 @@ void mmu_init(void *tablemem)
             .impl2 = 0,
             .access = 0b10,
             .impl3 = 0,
+            .shareable = 0,
+            .impl4 = 0,
             .baseaddr = i
         };
     }
@@ -194,6 +203,8 @@ void mmu_mark_strongly_ordered(void *tablemem, void *section)
         .impl2 = 0,
         .access = 0b10,
         .impl3 = 0,
+        .shareable = 0,
+        .impl4 = 0,
         .baseaddr = secnum /* identity-mapped, as before */
     };
 
@@ -2,17 +2,20 @@
 #include <caboose/state.h>
 #include <caboose/syscall.h>
 
+#include "cpu.h"
 #include "debug.h"
 #include "frames.h"
+#include "fxmem.h"
 #include "ipi.h"
 #include "irq.h"
 #include "mmu.h"
 #include "pl011-uart.h"
 #include "platform-events.h"
-#include "secondary.h"
+#include "pmu.h"
 #include "syscalltable.h"
 #include "timer.h"
 #include "usb.h"
+#include "worker.h"
 
 extern uint8_t bss_start;
 extern uint8_t bss_end;
@@ -69,6 +72,7 @@ void platform_init(uint8_t *pool)
     /* Bring the UART up first so that debug logging is available to the rest of
      * the initialization routines. */
     pool = uart0_init(pool);
+    pool = cpu_init(pool);
 
     void *pagetable;
     pool = mmu_pagetable_alloc(pool, &pagetable);
@@ -77,13 +81,12 @@ void platform_init(uint8_t *pool)
     pool = irq_init(pool);
     pool = ipi_init(pool);
     pool = timer_init(pool);
+    pool = pmu_init(pool);
+    pool = fxmem_init(pool);
     pool = usb_init(pool);
 
-    /* Put the unused cores to sleep.  Would be good if there was some way I
-     * could automatically do this, but for now this just has to be kept in sync
-     * with the behaviour of the rest of the platform code manually. */
-    secondary_start(2, NULL);
-    secondary_start(3, NULL);
+    /* And cores 2 and 3 wait for work from this one. */
+    pool = worker_init(pool);
 
     /* Hand it over to the generic kernel initialization, which will start the
      * scheduler when it's ready. */
@@ -0,0 +1,31 @@
+#include "barriers.h"
+#include "pmu.h"
+
+/* The Cortex-A7 implements the ARMv7 Performance Monitors Extension (Chapter C12
+ * of the ARM Architecture Reference Manual, and Chapter 11 of the Cortex-A7
+ * TRM).  Mostly we want the cycle counter, which gives us a far finer-grained
+ * clock than the 1MHz system timer for measuring how long the synth's inner
+ * loops take, but the event counters are handy for counting cache misses
+ * too. */
+
+#define PMCR_E (1 << 0)         /* enable all counters */
+#define PMCR_C (1 << 2)         /* reset the cycle counter */
+
+#define PMCNTEN_C (1 << 31)     /* cycle counter enable */
+
+#define PMUSERENR_EN (1 << 0)   /* permit user mode access */
+
+uint8_t *pmu_init(uint8_t *pool)
+{
+    /* Let user mode tasks read the counters directly, rather than making them
+     * pay for a syscall around every measurement. */
+    asm volatile ("mcr p15, 0, %0, c9, c14, 0" :: "r" (PMUSERENR_EN));
+
+    /* Reset and enable the cycle counter.  PMCR.D is left clear so that it
+     * counts every cycle rather than every 64th. */
+    asm volatile ("mcr p15, 0, %0, c9, c12, 0" :: "r" (PMCR_E | PMCR_C));
+    asm volatile ("mcr p15, 0, %0, c9, c12, 1" :: "r" (PMCNTEN_C));
+    isb();
+
+    return pool;
+}
@@ -0,0 +1,43 @@
+#ifndef CABOOSE_PLATFORM_PMU_H
+#define CABOOSE_PLATFORM_PMU_H
+
+#include <stdint.h>
+
+/* Start the Performance Monitors Extension cycle counter on this core and make
+ * it readable from user mode. */
+uint8_t *pmu_init(uint8_t *pool);
+
+/* Read the free-running CPU cycle counter.  It wraps every few seconds at the
+ * default clock, so only differences between nearby reads mean anything. */
+static inline uint32_t pmu_cycles(void)
+{
+    uint32_t ccnt;
+    asm volatile ("mrc p15, 0, %0, c9, c13, 0" : "=r" (ccnt));
+    return ccnt;
+}
+
+/* A few of the common architectural events (Section C12.8 of the ARM
+ * Architecture Reference Manual) that we can count on the Cortex-A7's four
+ * event counters. */
+#define PMU_EVENT_L1D_REFILL 0x03
+#define PMU_EVENT_L1D_ACCESS 0x04
+
+/* Program event counter @counter to count @event and start it. */
+static inline void pmu_event_start(uint32_t counter, uint32_t event)
+{
+    asm volatile ("mcr p15, 0, %0, c9, c12, 5" :: "r" (counter));
+    asm volatile ("isb" ::: "memory");
+    asm volatile ("mcr p15, 0, %0, c9, c13, 1" :: "r" (event));
+    asm volatile ("mcr p15, 0, %0, c9, c12, 1" :: "r" (1 << counter));
+}
+
+static inline uint32_t pmu_event_read(uint32_t counter)
+{
+    uint32_t count;
+    asm volatile ("mcr p15, 0, %0, c9, c12, 5" :: "r" (counter));
+    asm volatile ("isb" ::: "memory");
+    asm volatile ("mrc p15, 0, %0, c9, c13, 2" : "=r" (count));
+    return count;
+}
+
+#endif
@@ -75,6 +75,11 @@ static void uspi_packet_handler(unsigned cable, unsigned length, uint8_t *p)
 {
     USPI_PLATFORM_ASSERT(length <= CONFIG_USB_PACKET_BUF_SIZE);
 
+    /* Timestamp the packet first thing, so that neither waiting for the main
+     * core below nor the trip through userspace counts against it: the synth
+     * uses this to place the message at the right sample. */
+    uint32_t stamp = timer_read();
+
     /* Synchronize access to the inter-core buffer by waiting until the main
      * core has completed processing the last IPI we pinged them with. */
     while (ipi_pending(IPI_USB)) {
@@ -83,6 +88,7 @@ static void uspi_packet_handler(unsigned cable, unsigned length, uint8_t *p)
 
     /* Copy the new packet into the communication buffer. */
     midisync.len = length;
+    midisync.stamp = stamp;
     memcpy(midisync.packet, p, length);
 
     /* Make sure that we're entirely finished writing it... */
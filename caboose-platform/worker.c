@@ -0,0 +1,121 @@
+#include <caboose/platform.h>
+
+#include "barriers.h"
+#include "bcm2836.h"
+#include "cpu.h"
+#include "mmu.h"
+#include "secondary.h"
+#include "worker.h"
+
+/* The first of the worker cores; they're the last ones. */
+#define WORKER_CORE 2
+
+/* Mailbox 1 only ever holds this (or nothing). */
+#define WORKER_BUSY 1
+
+#define wfe() asm volatile ("wfe" ::: "memory")
+#define sev() asm volatile ("sev" ::: "memory")
+
+struct worker {
+    void (*job)(void *arg);
+    void *arg;
+} __aligned(64);
+
+static struct worker workers[WORKER_COUNT];
+
+/* Read by the workers before their MMUs (and caches) are on. */
+void *worker_stacks[WORKER_COUNT];
+static void *worker_pagetables[WORKER_COUNT];
+
+static const uint32_t worker_set1[WORKER_COUNT] = {
+    ARM_LOCAL_MAILBOX1_SET2,
+    ARM_LOCAL_MAILBOX1_SET3
+};
+
+static const uint32_t worker_clr1[WORKER_COUNT] = {
+    ARM_LOCAL_MAILBOX1_CLR2,
+    ARM_LOCAL_MAILBOX1_CLR3
+};
+
+void worker_start(void);
+
+uint8_t *worker_init(uint8_t *pool)
+{
+    for (int w = 0; w < WORKER_COUNT; w++) {
+        pool = (uint8_t *)ALIGN((uintptr_t)pool, 8);
+        pool += CONFIG_WORKER_STACK_SIZE;
+        worker_stacks[w] = pool;
+
+        pool = mmu_pagetable_alloc(pool, &worker_pagetables[w]);
+
+        /* The worker clears its mailbox once it's up, which is when it's
+         * safe to post it anything: until its caches are on, it wouldn't see
+         * the job that was posted. */
+        volatile uint32_t *set1 = (uint32_t *)worker_set1[w];
+        *set1 = WORKER_BUSY;
+    }
+
+    /* As for core 1 (see usb_init()), make sure what the workers read before
+     * their caches are on has made it out to main memory. */
+    cache_clean_range(worker_stacks, sizeof worker_stacks);
+    cache_clean_range(worker_pagetables, sizeof worker_pagetables);
+
+    for (int w = 0; w < WORKER_COUNT; w++) {
+        secondary_start(WORKER_CORE + w, worker_start);
+    }
+
+    return pool;
+}
+
+/* Called from worker_start on each worker core, never to return. */
+void worker_main(uint8_t coreno)
+{
+    int w = coreno - WORKER_CORE;
+    volatile uint32_t *clr1 = (uint32_t *)worker_clr1[w];
+
+    mmu_init(worker_pagetables[w]);
+
+    /* The FPSCR is this core's own, and the jobs have to flush denormals
+     * just as they would on the main core, or their output would differ. */
+    cpu_init_fp();
+    dsb();
+    *clr1 = WORKER_BUSY;
+
+    while (true) {
+        while (!*clr1) {
+            wfe();
+        }
+
+        /* The job was written before the mailbox was set. */
+        dmb();
+        workers[w].job(workers[w].arg);
+
+        /* And what it did has to be seen before the mailbox is cleared. */
+        dsb();
+        *clr1 = WORKER_BUSY;
+    }
+}
+
+void worker_post(int w, void (*job)(void *arg), void *arg)
+{
+    ASSERT(w >= 0 && w < WORKER_COUNT);
+    worker_wait(w);
+
+    workers[w].job = job;
+    workers[w].arg = arg;
+
+    volatile uint32_t *set1 = (uint32_t *)worker_set1[w];
+    dsb();
+    *set1 = WORKER_BUSY;
+    dsb();
+    sev();
+}
+
+void worker_wait(int w)
+{
+    volatile uint32_t *clr1 = (uint32_t *)worker_clr1[w];
+    while (*clr1) {
+        /* spin */
+    }
+    dmb();
+}
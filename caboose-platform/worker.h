@@ -0,0 +1,33 @@
+#ifndef CABOOSE_PLATFORM_WORKER_H
+#define CABOOSE_PLATFORM_WORKER_H
+
+#include <stdint.h>
+
+/* Cores 2 and 3 have nothing of their own to do, so they're put to work on
+ * jobs handed to them by the main core: it posts a function and an argument to
+ * a worker, carries on with something else, and waits for the worker to finish
+ * when it needs the result - a fork and a join.
+ *
+ * Each worker has its own mailbox 1 (see secondary.c for what a mailbox is),
+ * which is set while it has a job, and which the worker clears when it's done.
+ * A worker waits for a job with wfe rather than spinning, so that it isn't
+ * hammering the bus in between, and the main core sends it an event once the
+ * mailbox is set.  The main core spins on the mailbox while it waits, since
+ * it's got nothing better to do.
+ *
+ * Jobs run with interrupts masked, in SVC mode, with a stack of their own and
+ * the VFP and NEON enabled.  They see memory coherently with the main core, so
+ * they're free to read (and write) whatever it does, as long as it's not the
+ * same things at the same time. */
+#define WORKER_COUNT 2
+
+uint8_t *worker_init(uint8_t *pool);
+
+/* Have worker @w run @job(@arg).  If it's still busy with the last one, or
+ * still coming up, this waits for it first. */
+void worker_post(int w, void (*job)(void *arg), void *arg);
+
+/* Wait for worker @w to finish the last job posted to it. */
+void worker_wait(int w);
+
+#endif
@@ -0,0 +1,72 @@
+#include <stdint.h>
+
+#include "audio.h"
+#include "chorus.h"
+#include "fxline.h"
+#include "lfo.h"
+
+void chorus_init(struct chorus *c, float *mem)
+{
+    c->line[0] = mem;
+    c->line[1] = mem + CHORUS_LEN;
+    for (int i = 0; i < 2 * CHORUS_LEN; i++) {
+        mem[i] = 0.0f;
+    }
+
+    c->pos = 0;
+    c->phase = 0;
+    c->time[0] = FX_SAMPLES_PER_MS;
+    c->time[1] = FX_SAMPLES_PER_MS;
+}
+
+void chorus_process(struct chorus *c,
+                    const struct choruspatch *p,
+                    float *left,
+                    float *right,
+                    int len)
+{
+    /* The sweep is kept at least a sample clear of the write position and
+     * inside the line at the other end. */
+    float base = fx_clamp(p->delay * FX_SAMPLES_PER_MS,
+                          1.0f,
+                          CHORUS_LEN - 2.0f);
+    float depth = fx_clamp(p->depth * FX_SAMPLES_PER_MS,
+                           0.0f,
+                           base - 1.0f < CHORUS_LEN - 2.0f - base
+                           ? base - 1.0f
+                           : CHORUS_LEN - 2.0f - base);
+
+    float rate = fx_clamp(p->rate, 0.0f, 20.0f);
+    c->phase += (uint32_t)(rate * (4294967296.0f / AUDIO_SAMPLE_RATE)) * len;
+    float end[2] = {
+        base + depth * lfo_lookup(lfo_rounded, c->phase),
+        base + depth * lfo_lookup(lfo_rounded, c->phase + 0x40000000)
+    };
+    float step[2] = {
+        (end[0] - c->time[0]) / len,
+        (end[1] - c->time[1]) / len
+    };
+
+    float *l = c->line[0];
+    float *r = c->line[1];
+    uint32_t pos = c->pos;
+    float tl = c->time[0];
+    float tr = c->time[1];
+    float wet = p->wet;
+
+    for (int i = 0; i < len; i++) {
+        float xl = left[i], xr = right[i];
+        l[pos & CHORUS_MASK] = xl;
+        r[pos & CHORUS_MASK] = xr;
+        left[i] = xl + wet * fxline_tap(l, CHORUS_MASK, pos, tl);
+        right[i] = xr + wet * fxline_tap(r, CHORUS_MASK, pos, tr);
+
+        pos++;
+        tl += step[0];
+        tr += step[1];
+    }
+
+    c->pos = pos & CHORUS_MASK;
+    c->time[0] = end[0];
+    c->time[1] = end[1];
+}
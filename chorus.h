@@ -0,0 +1,52 @@
+#ifndef SXLHLG_CHORUS_H
+#define SXLHLG_CHORUS_H
+
+#include <stdint.h>
+
+#include <caboose/config.h>
+
+/* A stereo chorus on the mix: each channel is joined by a copy of itself from
+ * a few milliseconds ago, with the delay time swept back and forth by an LFO
+ * so that the copy is slightly detuned.  The two channels' sweeps are a
+ * quarter of a cycle apart, which is what spreads a mono signal out.
+ *
+ * The sweep's shape comes from the lfo_rounded table (see lfo.h) rather than
+ * being computed, and like the delay's it's only looked up once per block,
+ * with the delay time ramped sample by sample in between.
+ *
+ * The lines are CONFIG_SYNTH_CHORUS_LEN samples each, a power of two, in the
+ * memory the platform sets aside at startup (see caboose-platform/fxmem.h),
+ * after the reverb's. */
+#define CHORUS_LEN CONFIG_SYNTH_CHORUS_LEN
+#define CHORUS_MASK (CHORUS_LEN - 1)
+
+#if CHORUS_LEN & CHORUS_MASK
+#error "CONFIG_SYNTH_CHORUS_LEN must be a power of two"
+#endif
+
+struct choruspatch {
+    float wet;          /* the level of the delayed copy, [0, 1]; 0 is off */
+    float rate;         /* of the sweep, Hz */
+    float delay;        /* the middle of the sweep, ms */
+    float depth;        /* how far either side of it the sweep goes, ms */
+};
+
+struct chorus {
+    float *line[2];
+    uint32_t pos;       /* where the next sample is written */
+    uint32_t phase;     /* of the sweep, 0.32 fixed point */
+    float time[2];      /* each channel's delay where this block starts */
+};
+
+/* Set up @c to use the 2 * CHORUS_LEN floats at @mem, and clear them. */
+void chorus_init(struct chorus *c, float *mem);
+
+/* Run @len samples of the mix in @left and @right through @c with settings
+ * @p, in place. */
+void chorus_process(struct chorus *c,
+                    const struct choruspatch *p,
+                    float *left,
+                    float *right,
+                    int len);
+
+#endif
@@ -0,0 +1,105 @@
+#include <stdint.h>
+
+#include "audio.h"
+#include "delay.h"
+#include "fm.h"
+#include "fxline.h"
+
+/* The delay time glides this fraction of the way to its setting each block,
+ * so that turning the time knob bends the pitch of the repeats rather than
+ * clicking. */
+#define DELAY_SMOOTHING 0.02f
+#define DELAY_SNAP 0.01f
+
+void delay_init(struct delay *d, float *mem)
+{
+    d->line[0] = mem;
+    d->line[1] = mem + DELAY_LEN;
+    for (int i = 0; i < 2 * DELAY_LEN; i++) {
+        mem[i] = 0.0f;
+    }
+
+    d->pos = 0;
+    d->base = FX_SAMPLES_PER_MS;
+    d->time = FX_SAMPLES_PER_MS;
+    d->mod_phase = 0;
+    d->tone[0] = 0.0f;
+    d->tone[1] = 0.0f;
+}
+
+void delay_process(struct delay *d,
+                   const struct delaypatch *p,
+                   float *left,
+                   float *right,
+                   int len)
+{
+    /* Work out where the delay time should be by the end of the block.  Taps
+     * are never less than a sample back (or they'd read what was about to be
+     * overwritten), and never so far back that the wobble could take them
+     * off the end of the line. */
+    float depth = fx_clamp(p->mod_depth * FX_SAMPLES_PER_MS,
+                           0.0f,
+                           DELAY_LEN / 4);
+    float target = p->bpm > 0.0f
+                   ? p->beats * (60.0f * AUDIO_SAMPLE_RATE) / p->bpm
+                   : p->time * FX_SAMPLES_PER_MS;
+    target = fx_clamp(target, 1.0f + depth, DELAY_LEN - 2.0f - depth);
+
+    /* Closing in a fixed fraction of the way at a time, the steps would
+     * eventually drop below the precision of the time itself and stall short
+     * of it, so the last hundredth of a sample is a snap. */
+    float diff = target - d->base;
+    d->base = diff < DELAY_SNAP && diff > -DELAY_SNAP
+              ? target
+              : d->base + diff * DELAY_SMOOTHING;
+
+    float rate = fx_clamp(p->mod_rate, 0.0f, 20.0f);
+    d->mod_phase += (uint32_t)(rate * (4294967296.0f / AUDIO_SAMPLE_RATE))
+                    * len;
+    float end = fx_clamp(d->base + depth * fm_sine(d->mod_phase),
+                         1.0f,
+                         DELAY_LEN - 2.0f);
+    float step = (end - d->time) / len;
+
+    /* Ping-pong feeds only the left line, from both sides of the input, and
+     * then each line from the other, where a plain stereo delay feeds each
+     * line from its own side and itself.  Either way it's the same arithmetic
+     * with different coefficients, so there's nothing to branch on in the
+     * loop. */
+    float fb = fx_clamp(p->feedback, 0.0f, DELAY_MAX_FEEDBACK);
+    float self = p->pingpong ? 0.0f : fb;
+    float cross = p->pingpong ? fb : 0.0f;
+    float send = p->pingpong ? 0.0f : 1.0f;
+    float both = p->pingpong ? 0.5f : 1.0f;
+    float other = p->pingpong ? 0.5f : 0.0f;
+    float bright = 1.0f - fx_clamp(p->damping, 0.0f, 0.95f);
+    float wet = p->wet;
+
+    float *l = d->line[0];
+    float *r = d->line[1];
+    uint32_t pos = d->pos;
+    float time = d->time;
+    float tl = d->tone[0];
+    float tr = d->tone[1];
+
+    for (int i = 0; i < len; i++) {
+        float dl = fxline_tap(l, DELAY_MASK, pos, time);
+        float dr = fxline_tap(r, DELAY_MASK, pos, time);
+        tl += (dl - tl) * bright;
+        tr += (dr - tr) * bright;
+
+        float xl = left[i], xr = right[i];
+        l[pos & DELAY_MASK] = (xl * both + xr * other) + self * tl + cross * tr;
+        r[pos & DELAY_MASK] = xr * send + self * tr + cross * tl;
+        left[i] = xl + wet * dl;
+        right[i] = xr + wet * dr;
+
+        pos++;
+        time += step;
+    }
+
+    d->pos = pos & DELAY_MASK;
+    d->time = end;
+    d->tone[0] = tl;
+    d->tone[1] = tr;
+}
@@ -0,0 +1,70 @@
+#ifndef SXLHLG_DELAY_H
+#define SXLHLG_DELAY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <caboose/config.h>
+
+/* A stereo delay on the mix, with feedback, ping-pong and tempo sync.
+ *
+ * The two delay lines are circular buffers of a fixed power-of-two length, so
+ * that wrapping an index around is a mask rather than a division, and they
+ * live in the memory the platform sets aside at startup (see
+ * caboose-platform/fxmem.h): nothing is allocated while the synth runs.
+ *
+ * Like everything else, the delay's settings are only looked at once per
+ * block.  The delay time glides towards its setting, and can be wobbled by a
+ * sine for a tape-like chorus, so the taps fall between samples; they're read
+ * with linear interpolation, the delay time ramping sample by sample just like
+ * the voices' levels.
+ *
+ * The work per sample is the same whatever the settings, so the cost of a
+ * block is fixed: no branches, and the same handful of loads and stores. */
+#define DELAY_LEN CONFIG_SYNTH_DELAY_LEN
+#define DELAY_MASK (DELAY_LEN - 1)
+
+#if DELAY_LEN & DELAY_MASK
+#error "CONFIG_SYNTH_DELAY_LEN must be a power of two"
+#endif
+
+/* The longest the feedback can be turned up, so that the repeats always die
+ * away eventually. */
+#define DELAY_MAX_FEEDBACK 0.95f
+
+struct delaypatch {
+    float wet;          /* the level of the repeats, [0, 1]; 0 is off */
+    float feedback;     /* [0, DELAY_MAX_FEEDBACK] */
+    bool pingpong;      /* repeats alternate between left and right */
+
+    /* The delay time is @beats at @bpm if @bpm is set, @time otherwise. */
+    float time;         /* ms */
+    float bpm;
+    float beats;
+
+    float damping;      /* how much darker each repeat is, [0, 1) */
+    float mod_depth;    /* ms */
+    float mod_rate;     /* Hz */
+};
+
+struct delay {
+    float *line[2];
+    uint32_t pos;       /* where the next sample is written */
+    float base;         /* the set delay time, smoothed, in samples */
+    float time;         /* the delay time where this block starts */
+    uint32_t mod_phase;
+    float tone[2];      /* the feedback damping filters' states */
+};
+
+/* Set up @d to use the 2 * DELAY_LEN floats at @mem, and clear them. */
+void delay_init(struct delay *d, float *mem);
+
+/* Run @len samples of the mix in @left and @right through @d with settings
+ * @p, adding the repeats onto them in place. */
+void delay_process(struct delay *d,
+                   const struct delaypatch *p,
+                   float *left,
+                   float *right,
+                   int len);
+
+#endif
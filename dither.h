@@ -0,0 +1,56 @@
+#ifndef SXLHLG_DITHER_H
+#define SXLHLG_DITHER_H
+
+#include <stdint.h>
+
+#include <caboose/util.h>
+
+/* The mix is carried as floats right up to the end of the render, and
+ * quantized just once, to the PWM's 12 bits.  Truncating it there would turn
+ * the rounding error into distortion that follows the signal - harsh on quiet
+ * notes and the tails of releases and reverb - so instead it's dithered and
+ * noise shaped:
+ *
+ * - TPDF dither, the difference of two uniform random numbers of an LSB each,
+ *   is added before rounding, which makes the error independent of the signal
+ *   (just noise).
+ *
+ * - The error is fed back through a second-order filter, so that the noise in
+ *   the output is the error shaped by (1 - z^-1)^2: pushed up towards Nyquist,
+ *   where it's far less audible, and out of the bottom few kHz, where the
+ *   12-bit floor would otherwise be plain to hear.
+ *
+ * Each channel's error feeds into its next sample, so that's a recurrence that
+ * has to run a sample at a time.  The two channels go side by side, though,
+ * and the random numbers for a sample - two per channel - are generated four
+ * lanes at once. */
+
+/* The furthest the dither and shaped error can move an output sample from its
+ * exact value, in LSBs: each rounding error is at most an LSB and a half (half
+ * an LSB of rounding on top of the dither's one), and what reaches the output
+ * is the latest one, less twice the one before, plus the one before that. */
+#define DITHER_PEAK 6
+
+struct dither {
+    uint32_t seed[4];   /* one generator per lane */
+    float e1[2];        /* each channel's last error */
+    float e2[2];        /* and the one before that */
+} __aligned(16);
+
+static inline void dither_init(struct dither *d)
+{
+    /* Any four different seeds will do. */
+    for (int i = 0; i < 4; i++) {
+        d->seed[i] = 0x9e3779b9 * (i + 1);
+    }
+    d->e1[0] = d->e1[1] = 0.0f;
+    d->e2[0] = d->e2[1] = 0.0f;
+}
+
+/* Each lane's generator is this LCG, whose top 24 bits make a uniform float in
+ * [0, 1). */
+#define DITHER_MUL 1664525u
+#define DITHER_ADD 1013904223u
+#define DITHER_SCALE (1.0f / 16777216.0f)
+
+#endif
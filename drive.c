@@ -0,0 +1,136 @@
+#include "drive.h"
+
+static void drive_clear(struct drive *d, int channel)
+{
+    for (int stage = 0; stage < 2; stage++) {
+        for (int i = 0; i < HALFBAND_MAX; i++) {
+            d->up[channel][stage][i] = 0.0f;
+        }
+        for (int i = 0; i < 2 * HALFBAND_MAX; i++) {
+            d->down[channel][stage][i] = 0.0f;
+        }
+    }
+}
+
+void drive_init(struct drive *d)
+{
+    for (int ch = 0; ch < 2; ch++) {
+        drive_clear(d, ch);
+        d->oversample[ch] = 0;
+    }
+}
+
+void drive_bypass(struct drive *d, int channel)
+{
+    d->oversample[channel] = 0;
+}
+
+/* The most samples any one filter is run over at once: the second stage's
+ * downsampler, at four times the rate. */
+#define DRIVE_SCRATCH (2 * HALFBAND_MAX + 4 * DRIVE_CHUNK)
+
+/* The kernels want the filter's history just before the new samples, so the
+ * two are copied into one buffer, and the end of it becomes the history for
+ * next time.  @held is how many samples of history there are. */
+static void with_history(float *x,
+                         const float *hist,
+                         const float *in,
+                         int held,
+                         int len)
+{
+    for (int i = 0; i < held; i++) {
+        x[i] = hist[i];
+    }
+    for (int i = 0; i < len; i++) {
+        x[held + i] = in[i];
+    }
+}
+
+static void keep_history(float *hist, const float *x, int held, int len)
+{
+    for (int i = 0; i < held; i++) {
+        hist[i] = x[len + i];
+    }
+}
+
+static void up(const struct kernels *k,
+               const float *coef,
+               int taps,
+               float *hist,
+               float *out,
+               const float *in,
+               int len)
+{
+    float x[DRIVE_SCRATCH];
+    with_history(x, hist, in, taps - 1, len);
+    k->halfband_up(coef, taps, out, x, len);
+    keep_history(hist, x, taps - 1, len);
+}
+
+/* @len is the number of samples coming out, at the lower rate. */
+static void down(const struct kernels *k,
+                 const float *coef,
+                 int taps,
+                 float *hist,
+                 float *out,
+                 const float *in,
+                 int len)
+{
+    float x[DRIVE_SCRATCH];
+    with_history(x, hist, in, 2 * (taps - 1), 2 * len);
+    k->halfband_down(coef, taps, out, x, len);
+    keep_history(hist, x, 2 * (taps - 1), 2 * len);
+}
+
+void drive_process(struct drive *d,
+                   const struct kernels *k,
+                   const struct drivepatch *p,
+                   int channel,
+                   float *buf,
+                   int len)
+{
+    float twice[2 * DRIVE_CHUNK];
+    float four[4 * DRIVE_CHUNK];
+    float (*hist_up)[HALFBAND_MAX] = d->up[channel];
+    float (*hist_down)[2 * HALFBAND_MAX] = d->down[channel];
+
+    if (d->oversample[channel] != p->oversample) {
+        drive_clear(d, channel);
+        d->oversample[channel] = p->oversample;
+    }
+
+    for (int i = 0; i < len; i += DRIVE_CHUNK) {
+        int n = len - i < DRIVE_CHUNK ? len - i : DRIVE_CHUNK;
+        float *x = &buf[i];
+
+        switch (p->oversample) {
+        case 4:
+            up(k, halfband_long, HALFBAND_LONG, hist_up[0], twice, x, n);
+            up(k,
+               halfband_short,
+               HALFBAND_SHORT,
+               hist_up[1],
+               four,
+               twice,
+               2 * n);
+            k->drive(four, p->gain, p->level, 4 * n);
+            down(k,
+                 halfband_short,
+                 HALFBAND_SHORT,
+                 hist_down[1],
+                 twice,
+                 four,
+                 2 * n);
+            down(k, halfband_long, HALFBAND_LONG, hist_down[0], x, twice, n);
+            break;
+        case 2:
+            up(k, halfband_long, HALFBAND_LONG, hist_up[0], twice, x, n);
+            k->drive(twice, p->gain, p->level, 2 * n);
+            down(k, halfband_long, HALFBAND_LONG, hist_down[0], x, twice, n);
+            break;
+        default:
+            k->drive(x, p->gain, p->level, n);
+            break;
+        }
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef SXLHLG_DRIVE_H
+#define SXLHLG_DRIVE_H
+
+#include "halfband.h"
+#include "kernels.h"
+
+/* Overdrive on the mix, before the other effects: a soft clipper, pushed
+ * harder the more the mix is turned up into it.
+ *
+ * Clipping makes harmonics, and the ones above Nyquist would fold back down
+ * as inharmonic aliases, so the clipper can be run at two or four times the
+ * sample rate: the mix is upsampled through half-band filters (see
+ * halfband.h), clipped, and filtered back down, which takes away everything
+ * that would otherwise have aliased below ~26kHz (2x) or ~70kHz (4x, folding
+ * back no lower than ~18kHz).  Each doubling costs both filters, and the
+ * clipper is run over twice as many samples. */
+#define DRIVE_CHUNK 32
+
+struct drivepatch {
+    float gain;         /* into the clipper; 0 is off */
+    float level;        /* of what comes out of it */
+    int oversample;     /* 1, 2 or 4 */
+};
+
+struct drive {
+    /* The history of each channel's filters, by stage: the upsamplers' at
+     * the lower rate, and the downsamplers' at the higher. */
+    float up[2][2][HALFBAND_MAX];
+    float down[2][2][2 * HALFBAND_MAX];
+
+    /* The oversampling each channel's history was built up at, or 0 if it
+     * was bypassed since.  History from another rate, or from before a gap,
+     * would come out as a click, so it's cleared first. */
+    int oversample[2];
+};
+
+void drive_init(struct drive *d);
+
+/* @channel of the mix went past @d without going through it. */
+void drive_bypass(struct drive *d, int channel);
+
+/* Run @len samples of @channel of the mix in @buf through @d with settings @p,
+ * in place. */
+void drive_process(struct drive *d,
+                   const struct kernels *k,
+                   const struct drivepatch *p,
+                   int channel,
+                   float *buf,
+                   int len);
+
+#endif
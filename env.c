@@ -0,0 +1,85 @@
+#include "audio.h"
+#include "env.h"
+
+float adsr_rate(int ms)
+{
+    /* A zero time would mean an infinite rate, so jump in a single sample. */
+    int samples = ms * AUDIO_SAMPLE_RATE / 1000;
+    return samples > 0 ? 1.0f / samples : 1.0f;
+}
+
+void adsr_set(struct adsr *a,
+              int attack_ms,
+              int decay_ms,
+              int sustain_pct,
+              int release_ms)
+{
+    a->attack = adsr_rate(attack_ms);
+    a->decay = adsr_rate(decay_ms);
+    a->sustain = sustain_pct / 100.0f;
+    a->release = adsr_rate(release_ms);
+}
+
+float env_advance(struct env *e, const struct adsr *a, int len)
+{
+    /* A block can span the end of a segment, in which case whatever's left of
+     * it carries on into the next. */
+    float value = e->value;
+    float left = len;
+
+    while (left > 0.0f) {
+        switch (e->stage) {
+        case ENV_IDLE:
+            value = 0.0f;
+            left = 0.0f;
+            break;
+        case ENV_ATTACK:
+        {
+            float need = (1.0f - value) / a->attack;
+            if (need > left) {
+                value += a->attack * left;
+                left = 0.0f;
+            } else {
+                value = 1.0f;
+                left -= need;
+                e->stage = ENV_DECAY;
+            }
+            break;
+        }
+        case ENV_DECAY:
+        {
+            float need = (value - a->sustain) / a->decay;
+            if (need > left) {
+                value -= a->decay * left;
+                left = 0.0f;
+            } else {
+                value = a->sustain;
+                left -= need;
+                e->stage = ENV_SUSTAIN;
+            }
+            break;
+        }
+        case ENV_SUSTAIN:
+            /* The sustain level may have been changed under us. */
+            value = a->sustain;
+            left = 0.0f;
+            break;
+        case ENV_RELEASE:
+        {
+            float need = value / a->release;
+            if (need > left) {
+                value -= a->release * left;
+                left = 0.0f;
+            } else {
+                value = 0.0f;
+                left = 0.0f;
+                e->stage = ENV_IDLE;
+            }
+            break;
+        }
+        }
+    }
+
+    e->value = value;
+    return value;
+}
@@ -0,0 +1,78 @@
+#ifndef SXLHLG_ENV_H
+#define SXLHLG_ENV_H
+
+#include <stdbool.h>
+
+/* ADSR envelopes.  These run at control rate: the synth advances each voice's
+ * envelope once per block to find the level it should reach by the end of it,
+ * and the render kernels ramp linearly towards that level sample by sample.
+ * That's plenty smooth enough not to click, and it keeps the stage logic out of
+ * the inner loops entirely.
+ *
+ * All of the segments are linear in amplitude, so that they finish in exactly
+ * the time asked for and the release has a definite end at which the voice can
+ * be given back. */
+
+/* The envelope settings, shared by every voice. */
+struct adsr {
+    /* Rates are in full scale per sample: a full-scale release takes 1 /
+     * release samples. */
+    float attack;
+    float decay;
+    float sustain;  /* level, in [0, 1] */
+    float release;
+};
+
+enum env_stage {
+    ENV_IDLE,
+    ENV_ATTACK,
+    ENV_DECAY,
+    ENV_SUSTAIN,
+    ENV_RELEASE
+};
+
+struct env {
+    enum env_stage stage;
+    float value;
+};
+
+/* The rate of a full-scale segment lasting @ms milliseconds. */
+float adsr_rate(int ms);
+
+/* Configure @a with segment times in milliseconds and a sustain level in
+ * percent. */
+void adsr_set(struct adsr *a,
+              int attack_ms,
+              int decay_ms,
+              int sustain_pct,
+              int release_ms);
+
+static inline void env_reset(struct env *e)
+{
+    e->stage = ENV_IDLE;
+    e->value = 0.0f;
+}
+
+/* (Re)start the attack from wherever the envelope is now, so that retriggering
+ * a sounding voice doesn't click. */
+static inline void env_gate_on(struct env *e)
+{
+    e->stage = ENV_ATTACK;
+}
+
+static inline void env_gate_off(struct env *e)
+{
+    if (e->stage != ENV_IDLE) {
+        e->stage = ENV_RELEASE;
+    }
+}
+
+static inline bool env_idle(const struct env *e)
+{
+    return e->stage == ENV_IDLE;
+}
+
+/* Advance @e by @len samples and return its value at the end of them. */
+float env_advance(struct env *e, const struct adsr *a, int len);
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef SXLHLG_FM_H
+#define SXLHLG_FM_H
+
+#include <stdint.h>
+
+#include "env.h"
+
+/* DX-style FM voices: four sine operators per voice, each with its own
+ * frequency ratio, output level and envelope, wired together by one of
+ * FM_ALGORITHMS fixed algorithms.  The last operator can modulate itself. */
+#define FM_OPS 4
+#define FM_ALGORITHMS 8
+
+/* An algorithm says which operators modulate each operator, and which are
+ * heard.  Operators only ever modulate operators with a lower number, so they
+ * can be computed from the last down to the first. */
+struct fmalgorithm {
+    uint8_t mods[FM_OPS];   /* bit n set if operator n modulates this one */
+    uint8_t carriers;       /* bit n set if operator n is heard */
+};
+
+/* The numbering here starts at 0, so "3 -> 2" means the last operator
+ * modulates the second to last. */
+static const struct fmalgorithm fm_algorithms[FM_ALGORITHMS] = {
+    /* 3 -> 2 -> 1 -> 0 */
+    { .mods = { 1 << 1, 1 << 2, 1 << 3, 0 }, .carriers = 1 << 0 },
+    /* (2 + 3) -> 1 -> 0 */
+    { .mods = { 1 << 1, (1 << 2) | (1 << 3), 0, 0 }, .carriers = 1 << 0 },
+    /* (1 + (3 -> 2)) -> 0 */
+    { .mods = { (1 << 1) | (1 << 2), 0, 1 << 3, 0 }, .carriers = 1 << 0 },
+    /* (1 -> 0) + (3 -> 2) */
+    { .mods = { 1 << 1, 0, 1 << 3, 0 }, .carriers = (1 << 0) | (1 << 2) },
+    /* 3 -> (0 + 1 + 2) */
+    {
+        .mods = { 1 << 3, 1 << 3, 1 << 3, 0 },
+        .carriers = (1 << 0) | (1 << 1) | (1 << 2)
+    },
+    /* 0 + (3 -> 2 -> 1) */
+    { .mods = { 0, 1 << 2, 1 << 3, 0 }, .carriers = (1 << 0) | (1 << 1) },
+    /* 0 + 1 + (3 -> 2) */
+    {
+        .mods = { 0, 0, 1 << 3, 0 },
+        .carriers = (1 << 0) | (1 << 1) | (1 << 2)
+    },
+    /* 0 + 1 + 2 + 3 */
+    { .mods = { 0, 0, 0, 0 }, .carriers = 0xf }
+};
+
+/* How far a modulator at full level pushes its target's phase, in cycles. */
+#define FM_INDEX 2.0f
+
+/* A modulation in cycles is scaled by this and truncated to an integer, then
+ * shifted up into a phase offset: the whole cycles fall off the top, which is
+ * exactly the wrap-around we want. */
+#define FM_PHASE_SHIFT 8
+#define FM_PHASE_SCALE (FM_INDEX * (1 << (32 - FM_PHASE_SHIFT)))
+
+/* The settings of one operator. */
+struct fmop {
+    float ratio;    /* frequency, relative to the note */
+    float level;    /* [0, 1] */
+    struct adsr adsr;
+};
+
+struct fmpatch {
+    int algorithm;
+    float feedback; /* [0, 1] */
+    struct fmop op[FM_OPS];
+};
+
+/* The 7th-order odd polynomial for sin(pi / 2 * x) on [-1, 1] that every
+ * operator shares.  The coefficients are a minimax fit, good to 6e-7. */
+#define FM_SIN_C1 1.57079101f
+#define FM_SIN_C3 -0.645892879f
+#define FM_SIN_C5 0.079434409f
+#define FM_SIN_C7 -0.00433313542f
+
+/* Convert 0.32 fixed point to a float in [-1, 1] once the phase has been
+ * reinterpreted as signed. */
+#define FM_SIN_SCALE (1.0f / 2147483648.0f)
+
+/* The sine of 0.32 fixed-point @phase.  The phase is folded into the quarter
+ * cycles either side of zero, where the polynomial is accurate, without any
+ * branches: that's what the NEON version has to do too. */
+static inline float fm_sine(uint32_t phase)
+{
+    float x = (int32_t)phase * FM_SIN_SCALE;
+    float a = x < 0.0f ? -x : x;
+    float d = 0.5f - a;
+    float u = 0.5f - (d < 0.0f ? -d : d);
+    u = x < 0.0f ? -u : u;
+    u = u + u;
+
+    float u2 = u * u;
+    return u * (((FM_SIN_C7 * u2 + FM_SIN_C5) * u2 + FM_SIN_C3) * u2
+                + FM_SIN_C1);
+}
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef SXLHLG_FXLINE_H
+#define SXLHLG_FXLINE_H
+
+#include <stdint.h>
+
+#include "audio.h"
+
+/* What the effects that are built on delay lines (see fxmem.h) have in
+ * common.  Their lines are a power of two long, so that a position wraps
+ * around with a mask, and their times are in samples, as floats. */
+#define FX_SAMPLES_PER_MS (AUDIO_SAMPLE_RATE / 1000.0f)
+
+static inline float fx_clamp(float x, float min, float max)
+{
+    x = x < min ? min : x;
+    return x > max ? max : x;
+}
+
+/* The sample @time samples before @pos in @line, which wraps at @mask,
+ * interpolated linearly between the two either side of it. */
+static inline float fxline_tap(const float *line,
+                               uint32_t mask,
+                               uint32_t pos,
+                               float time)
+{
+    int whole = (int)time;
+    float frac = time - whole;
+    float a = line[(pos - whole) & mask];
+    float b = line[(pos - whole - 1) & mask];
+    return a + (b - a) * frac;
+}
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef SXLHLG_HALFBAND_H
+#define SXLHLG_HALFBAND_H
+
+/* Half-band filters, for changing the sample rate by a factor of two.  A
+ * half-band lowpass is symmetric about a quarter of the sample rate, which
+ * makes every other one of its taps zero, bar the middle one, which is a
+ * half.  Splitting it into polyphase branches - one for the even samples at
+ * the higher rate and one for the odd - leaves one branch that's nothing but
+ * the middle tap, a plain (delayed) copy, and the other with only the nonzero
+ * taps.  So going up or down by two costs only those taps per sample at the
+ * lower rate: a quarter of a plain FIR of the same length.
+ *
+ * The taps are a Kaiser-windowed sinc, worked out on the build host by
+ * tools/mkhalfband.c.  Each table is a filter's nonzero taps either side of
+ * the middle, the furthest first; since the filter is symmetric, the order
+ * the history is read in doesn't matter.
+ *
+ * Going 1x <-> 2x has to be sharp, cutting off between the top of the audible
+ * band and the old Nyquist, so it has the long filter.  Going 2x <-> 4x, it's
+ * only the images around 88.2kHz that need to go, and the short filter does. */
+#define HALFBAND_LONG 32
+#define HALFBAND_SHORT 8
+#define HALFBAND_MAX HALFBAND_LONG
+
+/* At 88.2kHz, flat (to within ~0.01dB) to ~17.6kHz and at least ~75dB down
+ * from ~26.5kHz. */
+extern const float halfband_long[HALFBAND_LONG];
+
+/* At 176.4kHz, flat to ~17.6kHz too and at least ~65dB down from ~70.6kHz,
+ * which covers the images of everything the long filter lets through. */
+extern const float halfband_short[HALFBAND_SHORT];
+
+#endif
@@ -0,0 +1,1163 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <arm_neon.h>
+
+#include "blep.h"
+#include "fm.h"
+#include "kernels.h"
+#include "sampler.h"
+#include "wavetable.h"
+
+/* NEON implementations of the render kernels.  This is the only file built with
+ * -mfpu=neon-vfpv4: if the rest of the tree were, the compiler would be free to
+ * auto-vectorize code in tasks other than the synth, and the engine doesn't
+ * preserve the NEON registers across context switches.
+ *
+ * Each kernel does as many groups of 4 samples as it can and then hands the
+ * remainder to the scalar reference.  Every lane performs exactly the same
+ * sequence of IEEE single-precision operations as the reference does for that
+ * sample, so the output is bit-identical - which the benchmarks check. */
+
+/* Four lanes of polyblep() from blep.h.  Both polynomials are evaluated for
+ * every lane and the right one is selected afterwards, so there are no
+ * branches. */
+static inline float32x4_t polyblep4(float32x4_t t,
+                                    float32x4_t dt,
+                                    float32x4_t inv_dt,
+                                    float32x4_t limit)
+{
+    float32x4_t one = vdupq_n_f32(1.0f);
+
+    float32x4_t x = vmulq_f32(t, inv_dt);
+    float32x4_t rise = vsubq_f32(vsubq_f32(vaddq_f32(x, x), vmulq_f32(x, x)),
+                                 one);
+
+    float32x4_t y = vmulq_f32(vsubq_f32(t, one), inv_dt);
+    float32x4_t fall = vaddq_f32(vaddq_f32(vaddq_f32(vmulq_f32(y, y), y), y),
+                                 one);
+
+    float32x4_t blep = vbslq_f32(vcgtq_f32(t, limit), fall, vdupq_n_f32(0.0f));
+    return vbslq_f32(vcltq_f32(t, dt), rise, blep);
+}
+
+/* The phases of the next 4 samples. */
+static inline uint32x4_t phase4(uint32_t phase, uint32_t inc)
+{
+    uint32_t lanes[4] = {
+        phase,
+        phase + inc,
+        phase + 2 * inc,
+        phase + 3 * inc
+    };
+    return vld1q_u32(lanes);
+}
+
+static void neon_saw(struct osc *o, float *out, int len)
+{
+    uint32_t inc = o->inc;
+    float dt = inc * PHASE_SCALE;
+    float inv_dt = 1.0f / dt;
+    int vlen = len & ~3;
+
+    uint32x4_t phase = phase4(o->phase, inc);
+    uint32x4_t step = vdupq_n_u32(inc * 4);
+    float32x4_t vdt = vdupq_n_f32(dt);
+    float32x4_t vinv_dt = vdupq_n_f32(inv_dt);
+    float32x4_t limit = vdupq_n_f32(1.0f - dt);
+    float32x4_t one = vdupq_n_f32(1.0f);
+
+    for (int i = 0; i < vlen; i += 4) {
+        float32x4_t t = vmulq_n_f32(vcvtq_f32_u32(phase), PHASE_SCALE);
+        float32x4_t naive = vsubq_f32(vaddq_f32(t, t), one);
+        float32x4_t blep = polyblep4(t, vdt, vinv_dt, limit);
+        vst1q_f32(&out[i], vsubq_f32(naive, blep));
+        phase = vaddq_u32(phase, step);
+    }
+
+    o->phase += vlen * inc;
+    blep_saw(o, &out[vlen], len - vlen);
+}
+
+static void neon_pulse(struct osc *o, uint32_t width, float *out, int len)
+{
+    uint32_t inc = o->inc;
+    float dt = inc * PHASE_SCALE;
+    float inv_dt = 1.0f / dt;
+    int vlen = len & ~3;
+
+    uint32x4_t phase = phase4(o->phase, inc);
+    uint32x4_t step = vdupq_n_u32(inc * 4);
+    uint32x4_t vwidth = vdupq_n_u32(width);
+    float32x4_t vdt = vdupq_n_f32(dt);
+    float32x4_t vinv_dt = vdupq_n_f32(inv_dt);
+    float32x4_t limit = vdupq_n_f32(1.0f - dt);
+    float32x4_t high = vdupq_n_f32(1.0f);
+    float32x4_t low = vdupq_n_f32(-1.0f);
+
+    for (int i = 0; i < vlen; i += 4) {
+        float32x4_t t = vmulq_n_f32(vcvtq_f32_u32(phase), PHASE_SCALE);
+        float32x4_t t2 = vmulq_n_f32(vcvtq_f32_u32(vsubq_u32(phase, vwidth)),
+                                     PHASE_SCALE);
+        float32x4_t naive = vbslq_f32(vcltq_u32(phase, vwidth), high, low);
+        float32x4_t blep = vsubq_f32(polyblep4(t, vdt, vinv_dt, limit),
+                                     polyblep4(t2, vdt, vinv_dt, limit));
+        vst1q_f32(&out[i], vaddq_f32(naive, blep));
+        phase = vaddq_u32(phase, step);
+    }
+
+    o->phase += vlen * inc;
+    blep_pulse(o, width, &out[vlen], len - vlen);
+}
+
+/* Everything each voice group kernel needs about its four voices, loaded once
+ * per block. */
+struct lanes {
+    uint32x4_t phase;
+    uint32x4_t inc;
+    float32x4_t dt;
+    float32x4_t inv_dt;
+    float32x4_t limit;
+    float32x4_t level;
+    float32x4_t step;
+    uint32x4_t gate;
+};
+
+static inline void lanes_load(struct lanes *l, struct voicebank *vb, int group)
+{
+    int base = group * VOICE_LANES;
+    l->phase = vld1q_u32(&vb->phase[base]);
+    l->inc = vld1q_u32(&vb->inc[base]);
+    l->dt = vmulq_n_f32(vcvtq_f32_u32(l->inc), PHASE_SCALE);
+    l->inv_dt = vld1q_f32(&vb->inv_dt[base]);
+    l->limit = vsubq_f32(vdupq_n_f32(1.0f), l->dt);
+    l->level = vld1q_f32(&vb->level[base]);
+    l->step = vld1q_f32(&vb->step[base]);
+    l->gate = vld1q_u32(&vb->gate[base]);
+}
+
+/* Scale by each voice's level, mask off the voices that aren't sounding and
+ * add the result into this sample's lanes of the accumulator, then ramp the
+ * levels on towards the end of the block. */
+static inline void lanes_accumulate(struct lanes *l,
+                                    float32x4_t sample,
+                                    float *acc)
+{
+    sample = vbslq_f32(l->gate,
+                       vmulq_f32(sample, l->level),
+                       vdupq_n_f32(0.0f));
+    vst1q_f32(acc, vaddq_f32(vld1q_f32(acc), sample));
+    l->level = vaddq_f32(l->level, l->step);
+}
+
+static void neon_saw4(struct voicebank *vb, int group, float *acc, int len)
+{
+    struct lanes l;
+    lanes_load(&l, vb, group);
+    float32x4_t one = vdupq_n_f32(1.0f);
+
+    for (int i = 0; i < len; i++) {
+        float32x4_t t = vmulq_n_f32(vcvtq_f32_u32(l.phase), PHASE_SCALE);
+        float32x4_t naive = vsubq_f32(vaddq_f32(t, t), one);
+        float32x4_t blep = polyblep4(t, l.dt, l.inv_dt, l.limit);
+        lanes_accumulate(&l, vsubq_f32(naive, blep), &acc[i * VOICE_LANES]);
+        l.phase = vaddq_u32(l.phase, l.inc);
+    }
+
+    vst1q_u32(&vb->phase[group * VOICE_LANES], l.phase);
+}
+
+static void neon_pulse4(struct voicebank *vb, int group, float *acc, int len)
+{
+    struct lanes l;
+    lanes_load(&l, vb, group);
+    uint32x4_t vwidth = vld1q_u32(&vb->width[group * VOICE_LANES]);
+    float32x4_t high = vdupq_n_f32(1.0f);
+    float32x4_t low = vdupq_n_f32(-1.0f);
+
+    for (int i = 0; i < len; i++) {
+        float32x4_t t = vmulq_n_f32(vcvtq_f32_u32(l.phase), PHASE_SCALE);
+        float32x4_t t2 = vmulq_n_f32(vcvtq_f32_u32(vsubq_u32(l.phase, vwidth)),
+                                     PHASE_SCALE);
+        float32x4_t naive = vbslq_f32(vcltq_u32(l.phase, vwidth), high, low);
+        float32x4_t blep = vsubq_f32(polyblep4(t, l.dt, l.inv_dt, l.limit),
+                                     polyblep4(t2, l.dt, l.inv_dt, l.limit));
+        lanes_accumulate(&l, vaddq_f32(naive, blep), &acc[i * VOICE_LANES]);
+        l.phase = vaddq_u32(l.phase, l.inc);
+    }
+
+    vst1q_u32(&vb->phase[group * VOICE_LANES], l.phase);
+}
+
+/* Transpose the four points each lane wants, one lane's to a register in @r,
+ * so that p[n] holds point n for all four lanes. */
+static inline void points_transpose(const float32x4_t r[4], float32x4_t p[4])
+{
+    float32x4x2_t t01 = vtrnq_f32(r[0], r[1]);
+    float32x4x2_t t23 = vtrnq_f32(r[2], r[3]);
+    p[0] = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+    p[1] = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+    p[2] = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+    p[3] = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+}
+
+/* The four consecutive points of one row starting at each lane's index,
+ * transposed.  There's no gather load, but the points each lane wants are
+ * contiguous, so four unaligned loads and a 4x4 transpose get us there. */
+static inline void table_points(const float *rows[VOICE_LANES],
+                                uint32x4_t j,
+                                float32x4_t p[4])
+{
+    float32x4_t r[4] = {
+        vld1q_f32(rows[0] + vgetq_lane_u32(j, 0)),
+        vld1q_f32(rows[1] + vgetq_lane_u32(j, 1)),
+        vld1q_f32(rows[2] + vgetq_lane_u32(j, 2)),
+        vld1q_f32(rows[3] + vgetq_lane_u32(j, 3))
+    };
+    points_transpose(r, p);
+}
+
+/* Four lanes of wavetable_cubic(). */
+static inline float32x4_t cubic4(const float32x4_t p[4], float32x4_t x)
+{
+    float32x4_t c1 = vmulq_n_f32(vsubq_f32(p[2], p[0]), 0.5f);
+    float32x4_t c2 = vsubq_f32(vaddq_f32(vsubq_f32(p[0],
+                                                   vmulq_n_f32(p[1], 2.5f)),
+                                         vaddq_f32(p[2], p[2])),
+                               vmulq_n_f32(p[3], 0.5f));
+    float32x4_t c3 = vaddq_f32(vmulq_n_f32(vsubq_f32(p[3], p[0]), 0.5f),
+                               vmulq_n_f32(vsubq_f32(p[1], p[2]), 1.5f));
+
+    float32x4_t y = vaddq_f32(vmulq_f32(c3, x), c2);
+    y = vaddq_f32(vmulq_f32(y, x), c1);
+    return vaddq_f32(vmulq_f32(y, x), p[1]);
+}
+
+static inline float32x4_t linear4(const float32x4_t p[4], float32x4_t x)
+{
+    return vaddq_f32(p[1], vmulq_f32(vsubq_f32(p[2], p[1]), x));
+}
+
+static inline void neon_table(struct voicebank *vb,
+                              int group,
+                              const struct wavetable *wt,
+                              float morph,
+                              bool cubic,
+                              float *acc,
+                              int len)
+{
+    struct lanes l;
+    lanes_load(&l, vb, group);
+
+    float blend;
+    int frame = wavetable_frame(morph, &blend);
+
+    /* Each voice may be playing from a different level. */
+    const float *a[VOICE_LANES];
+    const float *b[VOICE_LANES];
+    for (int lane = 0; lane < VOICE_LANES; lane++) {
+        int level = wavetable_level(vb->inc[group * VOICE_LANES + lane]);
+        a[lane] = wt->row[level][frame];
+        b[lane] = a[lane] + WAVETABLE_ROW;
+    }
+
+    uint32x4_t mask = vdupq_n_u32(WAVETABLE_FRAC_MASK);
+
+    for (int i = 0; i < len; i++) {
+        uint32x4_t j = vshrq_n_u32(l.phase, 32 - WAVETABLE_BITS);
+        float32x4_t x = vmulq_n_f32(vcvtq_f32_u32(vandq_u32(l.phase, mask)),
+                                    WAVETABLE_FRAC_SCALE);
+
+        float32x4_t pa[4], pb[4];
+        table_points(a, j, pa);
+        table_points(b, j, pb);
+
+        float32x4_t sa = cubic ? cubic4(pa, x) : linear4(pa, x);
+        float32x4_t sb = cubic ? cubic4(pb, x) : linear4(pb, x);
+        float32x4_t sample = vaddq_f32(sa,
+                                       vmulq_n_f32(vsubq_f32(sb, sa), blend));
+        lanes_accumulate(&l, sample, &acc[i * VOICE_LANES]);
+        l.phase = vaddq_u32(l.phase, l.inc);
+    }
+
+    vst1q_u32(&vb->phase[group * VOICE_LANES], l.phase);
+}
+
+static void neon_table4(struct voicebank *vb,
+                        int group,
+                        const struct wavetable *wt,
+                        float morph,
+                        float *acc,
+                        int len)
+{
+    neon_table(vb, group, wt, morph, false, acc, len);
+}
+
+static void neon_table4_cubic(struct voicebank *vb,
+                              int group,
+                              const struct wavetable *wt,
+                              float morph,
+                              float *acc,
+                              int len)
+{
+    neon_table(vb, group, wt, morph, true, acc, len);
+}
+
+/* Four lanes of fm_sine(). */
+static inline float32x4_t sine4(uint32x4_t phase)
+{
+    float32x4_t zero = vdupq_n_f32(0.0f);
+    float32x4_t half = vdupq_n_f32(0.5f);
+
+    float32x4_t x = vmulq_n_f32(vcvtq_f32_s32(vreinterpretq_s32_u32(phase)),
+                                FM_SIN_SCALE);
+    float32x4_t u = vsubq_f32(half, vabsq_f32(vsubq_f32(half, vabsq_f32(x))));
+    u = vbslq_f32(vcltq_f32(x, zero), vnegq_f32(u), u);
+    u = vaddq_f32(u, u);
+
+    float32x4_t u2 = vmulq_f32(u, u);
+    float32x4_t p = vaddq_f32(vmulq_n_f32(u2, FM_SIN_C7),
+                              vdupq_n_f32(FM_SIN_C5));
+    p = vaddq_f32(vmulq_f32(p, u2), vdupq_n_f32(FM_SIN_C3));
+    p = vaddq_f32(vmulq_f32(p, u2), vdupq_n_f32(FM_SIN_C1));
+    return vmulq_f32(u, p);
+}
+
+/* As for scalar_fm(), every FM kernel is this with a constant @alg. */
+static inline __attribute__((always_inline)) void neon_fm(
+    struct voicebank *vb,
+    int group,
+    float feedback,
+    float *acc,
+    int len,
+    const int alg)
+{
+    const struct fmalgorithm *a = &fm_algorithms[alg];
+    float carrier_gain = 1.0f / __builtin_popcount(a->carriers);
+    float fbk = feedback * 0.5f;
+
+    struct lanes l;
+    lanes_load(&l, vb, group);
+
+    int base = group * VOICE_LANES;
+    float32x4_t fb1 = vld1q_f32(&vb->fm_fb1[base]);
+    float32x4_t fb2 = vld1q_f32(&vb->fm_fb2[base]);
+
+    uint32x4_t phase[FM_OPS], inc[FM_OPS];
+    float32x4_t oplevel[FM_OPS], opstep[FM_OPS];
+    for (int op = 0; op < FM_OPS; op++) {
+        phase[op] = vld1q_u32(&vb->fm_phase[op][base]);
+        inc[op] = vld1q_u32(&vb->fm_inc[op][base]);
+        oplevel[op] = vld1q_f32(&vb->fm_level[op][base]);
+        opstep[op] = vld1q_f32(&vb->fm_step[op][base]);
+    }
+
+    for (int i = 0; i < len; i++) {
+        float32x4_t out[FM_OPS];
+        for (int op = FM_OPS - 1; op >= 0; op--) {
+            float32x4_t mod = op == FM_OPS - 1
+                              ? vmulq_n_f32(vaddq_f32(fb1, fb2), fbk)
+                              : vdupq_n_f32(0.0f);
+            for (int src = op + 1; src < FM_OPS; src++) {
+                if (a->mods[op] & (1 << src)) {
+                    mod = vaddq_f32(mod, out[src]);
+                }
+            }
+
+            int32x4_t cycles = vcvtq_s32_f32(vmulq_n_f32(mod, FM_PHASE_SCALE));
+            uint32x4_t offset = vshlq_n_u32(vreinterpretq_u32_s32(cycles),
+                                            FM_PHASE_SHIFT);
+            out[op] = vmulq_f32(sine4(vaddq_u32(phase[op], offset)),
+                                oplevel[op]);
+            oplevel[op] = vaddq_f32(oplevel[op], opstep[op]);
+            phase[op] = vaddq_u32(phase[op], inc[op]);
+        }
+
+        fb2 = fb1;
+        fb1 = out[FM_OPS - 1];
+
+        float32x4_t sum = vdupq_n_f32(0.0f);
+        for (int op = 0; op < FM_OPS; op++) {
+            if (a->carriers & (1 << op)) {
+                sum = vaddq_f32(sum, out[op]);
+            }
+        }
+
+        lanes_accumulate(&l,
+                         vmulq_n_f32(sum, carrier_gain),
+                         &acc[i * VOICE_LANES]);
+    }
+
+    for (int op = 0; op < FM_OPS; op++) {
+        vst1q_u32(&vb->fm_phase[op][base], phase[op]);
+    }
+    vst1q_f32(&vb->fm_fb1[base], fb1);
+    vst1q_f32(&vb->fm_fb2[base], fb2);
+}
+
+#define NEON_FM(alg)                                                        \
+    static void neon_fm##alg(struct voicebank *vb,                          \
+                             int group,                                     \
+                             float feedback,                                \
+                             float *acc,                                    \
+                             int len)                                       \
+    {                                                                       \
+        neon_fm(vb, group, feedback, acc, len, alg);                        \
+    }
+
+NEON_FM(0)
+NEON_FM(1)
+NEON_FM(2)
+NEON_FM(3)
+NEON_FM(4)
+NEON_FM(5)
+NEON_FM(6)
+NEON_FM(7)
+
+/* The @n frames, 4 or 8, from @at of the @frames of @data, widened to floats
+ * four to a register in @f.  They're one load away unless they run off either
+ * end of the sample, in which case they're gathered one at a time with the
+ * silence either side filled in. */
+static inline void sampler_frames(const int16_t *data,
+                                  uint32_t frames,
+                                  uint32_t at,
+                                  const int n,
+                                  float32x4_t f[])
+{
+    const int16_t *src;
+    int16_t edge[SAMPLER_SINC_TAPS];
+    if (at < frames && frames - at >= (uint32_t)n) {
+        src = &data[at];
+    } else {
+        for (int k = 0; k < n; k++) {
+            edge[k] = at + k < frames ? data[at + k] : 0;
+        }
+        src = edge;
+    }
+
+    if (n == 4) {
+        int32x4_t x = vmovl_s16(vld1_s16(src));
+        f[0] = vmulq_n_f32(vcvtq_f32_s32(x), 1.0f / 32768.0f);
+    } else {
+        int16x8_t x = vld1q_s16(src);
+        f[0] = vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(x))),
+                           1.0f / 32768.0f);
+        f[1] = vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(x))),
+                           1.0f / 32768.0f);
+    }
+}
+
+/* As for scalar_sampler(), every sampler kernel is this with a constant
+ * @interp.  The positions are advanced four voices at a time, but each
+ * voice's frames have to be fetched from wherever in its sample it's got to.
+ * The linear and cubic kernels transpose them as table_points() does.  The
+ * sinc's eight taps fill two registers for a single voice, so it multiplies
+ * them out a voice at a time and pairs the sums up into lanes at the end. */
+static inline __attribute__((always_inline)) void neon_sampler(
+    struct voicebank *vb,
+    int group,
+    float *acc,
+    int len,
+    const enum sampler_interp interp)
+{
+    struct lanes l;
+    lanes_load(&l, vb, group);
+
+    int base = group * VOICE_LANES;
+    uint32x4_t pos = vld1q_u32(&vb->smp_pos[base]);
+    uint32x4_t frac = vld1q_u32(&vb->smp_frac[base]);
+    uint32x4_t step = vld1q_u32(&vb->smp_step[base]);
+    uint32x4_t step_frac = vld1q_u32(&vb->smp_step_frac[base]);
+    uint32x4_t end = vld1q_u32(&vb->smp_end[base]);
+    uint32x4_t loop = vld1q_u32(&vb->smp_loop[base]);
+    const int16_t *const *data = &vb->smp_data[base];
+    const uint32_t *frames = &vb->smp_frames[base];
+
+    for (int i = 0; i < len; i++) {
+        uint32_t at[VOICE_LANES], row[VOICE_LANES];
+        vst1q_u32(at, pos);
+        vst1q_u32(row, vshrq_n_u32(frac, 32 - SAMPLER_SINC_BITS));
+
+        float32x4_t sample;
+        if (interp == SAMPLER_SINC) {
+            float32x2_t half[VOICE_LANES];
+            for (int lane = 0; lane < VOICE_LANES; lane++) {
+                float32x4_t t[2];
+                sampler_frames(data[lane],
+                               frames[lane],
+                               at[lane] - (SAMPLER_REACH - 1),
+                               SAMPLER_SINC_TAPS,
+                               t);
+
+                const float *c = sampler_sinc[row[lane]];
+                float32x4_t s = vaddq_f32(vmulq_f32(t[0], vld1q_f32(c)),
+                                          vmulq_f32(t[1], vld1q_f32(c + 4)));
+                half[lane] = vadd_f32(vget_low_f32(s), vget_high_f32(s));
+            }
+            sample = vcombine_f32(vpadd_f32(half[0], half[1]),
+                                  vpadd_f32(half[2], half[3]));
+        } else {
+            float32x4_t r[4], q[4];
+            for (int lane = 0; lane < VOICE_LANES; lane++) {
+                sampler_frames(data[lane],
+                               frames[lane],
+                               at[lane] - 1,
+                               4,
+                               &r[lane]);
+            }
+            points_transpose(r, q);
+
+            float32x4_t x = vmulq_n_f32(vcvtq_f32_u32(vshrq_n_u32(frac, 8)),
+                                        1.0f / 16777216.0f);
+            sample = interp == SAMPLER_LINEAR ? linear4(q, x) : cubic4(q, x);
+        }
+
+        lanes_accumulate(&l, sample, &acc[i * VOICE_LANES]);
+
+        /* A carry out of the fraction compares as all ones, which is minus
+         * one, so subtracting it adds the carry.  Going past the end goes
+         * back by the loop, if there is one, and then stops there if that
+         * wasn't enough. */
+        uint32x4_t next = vaddq_u32(frac, step_frac);
+        pos = vsubq_u32(vaddq_u32(pos, step), vcltq_u32(next, frac));
+        pos = vsubq_u32(pos, vandq_u32(vcgeq_u32(pos, end), loop));
+        pos = vminq_u32(pos, end);
+        frac = next;
+    }
+
+    vst1q_u32(&vb->smp_pos[base], pos);
+    vst1q_u32(&vb->smp_frac[base], frac);
+}
+
+#define NEON_SAMPLER(name, interp)                                          \
+    static void neon_sampler_##name(struct voicebank *vb,                   \
+                                    int group,                              \
+                                    float *acc,                             \
+                                    int len)                                \
+    {                                                                       \
+        neon_sampler(vb, group, acc, len, interp);                          \
+    }
+
+NEON_SAMPLER(linear, SAMPLER_LINEAR)
+NEON_SAMPLER(hermite, SAMPLER_HERMITE)
+NEON_SAMPLER(sinc, SAMPLER_SINC)
+
+/* Four of one voice's unison copies: their phases, increments and the
+ * polyblep's constants. */
+struct copies {
+    uint32x4_t phase;
+    uint32x4_t inc;
+    float32x4_t dt;
+    float32x4_t inv_dt;
+    float32x4_t limit;
+};
+
+static inline void copies_load(struct copies *c,
+                               struct voicebank *vb,
+                               int v,
+                               int first)
+{
+    c->phase = vld1q_u32(&vb->uni_phase[v][first]);
+    c->inc = vld1q_u32(&vb->uni_inc[v][first]);
+    c->dt = vmulq_n_f32(vcvtq_f32_u32(c->inc), PHASE_SCALE);
+    c->inv_dt = vld1q_f32(&vb->uni_inv_dt[v][first]);
+    c->limit = vsubq_f32(vdupq_n_f32(1.0f), c->dt);
+}
+
+/* The next sample of each of the four copies, advancing their phases. */
+static inline float32x4_t copies_saw(struct copies *c)
+{
+    float32x4_t t = vmulq_n_f32(vcvtq_f32_u32(c->phase), PHASE_SCALE);
+    float32x4_t naive = vsubq_f32(vaddq_f32(t, t), vdupq_n_f32(1.0f));
+    float32x4_t blep = polyblep4(t, c->dt, c->inv_dt, c->limit);
+    c->phase = vaddq_u32(c->phase, c->inc);
+    return vsubq_f32(naive, blep);
+}
+
+/* One voice at a time, with its copies across the lanes: each sample, the
+ * panned copies are folded down to a left and right pair, which is scaled by
+ * the voice's level and added into its lane of the outputs.  The fold is the
+ * only horizontal step, and it's shared by both channels. */
+static inline __attribute__((always_inline)) void neon_unison(
+    struct voicebank *vb,
+    int group,
+    const float pan[2][UNISON_MAX],
+    float *left,
+    float *right,
+    int len,
+    const bool eight)
+{
+    float32x4_t pla = vld1q_f32(&pan[0][0]);
+    float32x4_t plb = vld1q_f32(&pan[0][VOICE_LANES]);
+    float32x4_t pra = vld1q_f32(&pan[1][0]);
+    float32x4_t prb = vld1q_f32(&pan[1][VOICE_LANES]);
+
+    for (int voice = 0; voice < VOICE_LANES; voice++) {
+        int v = group * VOICE_LANES + voice;
+        if (!vb->gate[v]) {
+            continue;
+        }
+
+        struct copies a, b;
+        copies_load(&a, vb, v, 0);
+        copies_load(&b, vb, v, VOICE_LANES);
+        float level = vb->level[v];
+        float step = vb->step[v];
+
+        for (int i = 0; i < len; i++) {
+            float32x4_t sa = copies_saw(&a);
+            float32x4_t l = vmulq_f32(sa, pla);
+            float32x4_t r = vmulq_f32(sa, pra);
+            if (eight) {
+                float32x4_t sb = copies_saw(&b);
+                l = vaddq_f32(l, vmulq_f32(sb, plb));
+                r = vaddq_f32(r, vmulq_f32(sb, prb));
+            }
+
+            float32x2_t lh = vadd_f32(vget_low_f32(l), vget_high_f32(l));
+            float32x2_t rh = vadd_f32(vget_low_f32(r), vget_high_f32(r));
+            float32x2_t lr = vmul_n_f32(vpadd_f32(lh, rh), level);
+            left[i * VOICE_LANES + voice] += vget_lane_f32(lr, 0);
+            right[i * VOICE_LANES + voice] += vget_lane_f32(lr, 1);
+            level += step;
+        }
+
+        vst1q_u32(&vb->uni_phase[v][0], a.phase);
+        if (eight) {
+            vst1q_u32(&vb->uni_phase[v][VOICE_LANES], b.phase);
+        }
+    }
+}
+
+static void neon_unison4(struct voicebank *vb,
+                         int group,
+                         int copies,
+                         const float pan[2][UNISON_MAX],
+                         float *left,
+                         float *right,
+                         int len)
+{
+    if (copies > VOICE_LANES) {
+        neon_unison(vb, group, pan, left, right, len, true);
+    } else {
+        neon_unison(vb, group, pan, left, right, len, false);
+    }
+}
+
+/* Four of a voice's partials, in one register per quantity. */
+struct partials {
+    float32x4_t re, im, cr, ci, amp, step;
+};
+
+static inline void partials_load(struct partials *q,
+                                 const struct additivevoice *v,
+                                 const float *amp,
+                                 int first)
+{
+    q->re = vld1q_f32(&v->re[first]);
+    q->im = vld1q_f32(&v->im[first]);
+    q->cr = vld1q_f32(&v->rot_re[first]);
+    q->ci = vld1q_f32(&v->rot_im[first]);
+    q->amp = vld1q_f32(&amp[first]);
+    q->step = vld1q_f32(&v->step[first]);
+}
+
+static inline void partials_store(const struct partials *q,
+                                  struct additivevoice *v,
+                                  float *amp,
+                                  int first)
+{
+    vst1q_f32(&v->re[first], q->re);
+    vst1q_f32(&v->im[first], q->im);
+    vst1q_f32(&amp[first], q->amp);
+}
+
+/* The next sample of each of the four partials, rotating their phasors on. */
+static inline float32x4_t partials_next(struct partials *q)
+{
+    float32x4_t out = vmulq_f32(q->amp, q->im);
+    q->amp = vaddq_f32(q->amp, q->step);
+    float32x4_t re = vsubq_f32(vmulq_f32(q->re, q->cr),
+                               vmulq_f32(q->im, q->ci));
+    q->im = vaddq_f32(vmulq_f32(q->re, q->ci), vmulq_f32(q->im, q->cr));
+    q->re = re;
+    return out;
+}
+
+/* Eight partials at a time, kept in registers for a whole chunk: each one's
+ * recurrence is serial, so two registers' worth of them are interleaved to
+ * keep the pipeline busy.  Every sample of the chunk has a register's worth of
+ * running sums on the stack that the passes add into, and those are folded
+ * down to the voice's samples at the end. */
+static void neon_additive4(struct voicebank *vb,
+                           struct additivebank *ab,
+                           int group,
+                           float *acc,
+                           int len)
+{
+    for (int voice = 0; voice < VOICE_LANES; voice++) {
+        int i = group * VOICE_LANES + voice;
+        struct additivevoice *v = &ab->voice[i];
+        if (!vb->gate[i]) {
+            continue;
+        }
+
+        float amp[ADDITIVE_PARTIALS] __aligned(16);
+        for (int p = 0; p < v->count; p += VOICE_LANES) {
+            vst1q_f32(&amp[p], vld1q_f32(&v->amp[p]));
+        }
+        float level = vb->level[i];
+        float step = vb->step[i];
+
+        for (int at = 0; at < len; at += ADDITIVE_CHUNK) {
+            int n = len - at < ADDITIVE_CHUNK ? len - at : ADDITIVE_CHUNK;
+            float sum[ADDITIVE_CHUNK * VOICE_LANES] __aligned(16);
+            for (int t = 0; t < n; t++) {
+                vst1q_f32(&sum[t * VOICE_LANES], vdupq_n_f32(0.0f));
+            }
+
+            for (int p = 0; p < v->count; p += ADDITIVE_PACK) {
+                struct partials a, b;
+                partials_load(&a, v, amp, p);
+                partials_load(&b, v, amp, p + VOICE_LANES);
+                for (int t = 0; t < n; t++) {
+                    float *x = &sum[t * VOICE_LANES];
+                    float32x4_t s = vaddq_f32(vld1q_f32(x), partials_next(&a));
+                    vst1q_f32(x, vaddq_f32(s, partials_next(&b)));
+                }
+                partials_store(&a, v, amp, p);
+                partials_store(&b, v, amp, p + VOICE_LANES);
+            }
+
+            for (int t = 0; t < n; t++) {
+                float32x4_t s = vld1q_f32(&sum[t * VOICE_LANES]);
+                float32x2_t h = vadd_f32(vget_low_f32(s), vget_high_f32(s));
+                h = vmul_n_f32(vpadd_f32(h, h), level);
+                acc[(at + t) * VOICE_LANES + voice] += vget_lane_f32(h, 0);
+                level += step;
+            }
+        }
+
+        for (int p = 0; p < v->count; p += VOICE_LANES) {
+            float32x4_t re = vld1q_f32(&v->re[p]);
+            float32x4_t im = vld1q_f32(&v->im[p]);
+            float32x4_t m = vaddq_f32(vmulq_f32(re, re), vmulq_f32(im, im));
+            float32x4_t g = vsubq_f32(vdupq_n_f32(1.5f),
+                                      vmulq_n_f32(m, 0.5f));
+            vst1q_f32(&v->re[p], vmulq_f32(re, g));
+            vst1q_f32(&v->im[p], vmulq_f32(im, g));
+        }
+    }
+}
+
+static void neon_svf4(struct voicebank *vb,
+                      int group,
+                      int channel,
+                      const struct svfmix *mix,
+                      float *buf,
+                      int len)
+{
+    int base = group * VOICE_LANES;
+    float32x4_t a1 = vld1q_f32(&vb->svf_a1[base]);
+    float32x4_t a2 = vld1q_f32(&vb->svf_a2[base]);
+    float32x4_t a3 = vld1q_f32(&vb->svf_a3[base]);
+    float32x4_t ic1 = vld1q_f32(&vb->svf_ic1[channel][base]);
+    float32x4_t ic2 = vld1q_f32(&vb->svf_ic2[channel][base]);
+
+    /* The recurrence runs along each voice, so there's no parallelism to be had
+     * within one - but a sample's four lanes are four independent voices. */
+    for (int i = 0; i < len; i++) {
+        float *x = &buf[i * VOICE_LANES];
+        float32x4_t v0 = vld1q_f32(x);
+        float32x4_t v3 = vsubq_f32(v0, ic2);
+        float32x4_t v1 = vaddq_f32(vmulq_f32(a1, ic1), vmulq_f32(a2, v3));
+        float32x4_t v2 = vaddq_f32(vaddq_f32(ic2, vmulq_f32(a2, ic1)),
+                                   vmulq_f32(a3, v3));
+        ic1 = vsubq_f32(vaddq_f32(v1, v1), ic1);
+        ic2 = vsubq_f32(vaddq_f32(v2, v2), ic2);
+
+        float32x4_t out = vaddq_f32(vmulq_n_f32(v0, mix->high),
+                                    vmulq_n_f32(v1, mix->band));
+        vst1q_f32(x, vaddq_f32(out, vmulq_n_f32(v2, mix->low)));
+    }
+
+    vst1q_f32(&vb->svf_ic1[channel][base], ic1);
+    vst1q_f32(&vb->svf_ic2[channel][base], ic2);
+}
+
+/* The 4-point Hadamard butterflies on one register, as scalar_hadamard4()
+ * does them.  The first stage pairs the low half with the high; the second
+ * pairs neighbours, taking the sums in the even lanes and the differences in
+ * the odd ones. */
+static inline float32x4_t hadamard4(float32x4_t v)
+{
+    float32x2_t lo = vget_low_f32(v);
+    float32x2_t hi = vget_high_f32(v);
+    v = vcombine_f32(vadd_f32(lo, hi), vsub_f32(lo, hi));
+
+    float32x4_t swapped = vrev64q_f32(v);
+    uint32x4_t odd = vreinterpretq_u32_u64(vdupq_n_u64(0xffffffff00000000ull));
+    return vbslq_f32(odd, vsubq_f32(swapped, v), vaddq_f32(v, swapped));
+}
+
+/* One step of each line's damping filters. */
+static inline float32x4_t fdn_damp(float32x4_t x,
+                                   float32x4_t lp[REVERB_MAX_ORDER],
+                                   float damp,
+                                   int order)
+{
+    for (int o = 0; o < order; o++) {
+        lp[o] = vaddq_f32(lp[o], vmulq_n_f32(vsubq_f32(x, lp[o]), damp));
+        x = lp[o];
+    }
+    return x;
+}
+
+/* Lines 0-3 are in one register and 4-7 (if there are that many) in the
+ * other, so the whole network for a sample is a few instructions on two
+ * registers. */
+static inline void neon_fdn_body(struct fdn *f,
+                                 float *taps,
+                                 float *left,
+                                 float *right,
+                                 int len,
+                                 int lines,
+                                 int order)
+{
+    bool eight = lines == REVERB_LINES;
+    float32x4_t lpa[REVERB_MAX_ORDER], lpb[REVERB_MAX_ORDER];
+    for (int o = 0; o < order; o++) {
+        lpa[o] = vld1q_f32(&f->lp[o][0]);
+        lpb[o] = eight ? vld1q_f32(&f->lp[o][4]) : vdupq_n_f32(0.0f);
+    }
+    float32x4_t ga = vld1q_f32(&f->gain[0]);
+    float32x4_t gb = vld1q_f32(&f->gain[4]);
+
+    for (int t = 0; t < len; t++) {
+        float *x = &taps[t * REVERB_LINES];
+        float32x4_t a = fdn_damp(vld1q_f32(x), lpa, f->damp, order);
+        float32x4_t b = vdupq_n_f32(0.0f);
+
+        /* The left output is the sum of the even lines and the right the
+         * odd ones, which is just folding the registers in half. */
+        float32x4_t sum = a;
+        if (eight) {
+            b = fdn_damp(vld1q_f32(&x[4]), lpb, f->damp, order);
+            sum = vaddq_f32(a, b);
+        }
+        float32x2_t lr = vadd_f32(vget_low_f32(sum), vget_high_f32(sum));
+
+        if (eight) {
+            float32x4_t s = vaddq_f32(a, b);
+            b = hadamard4(vsubq_f32(a, b));
+            a = hadamard4(s);
+        } else {
+            a = hadamard4(a);
+        }
+
+        float32x2_t in = vld1_lane_f32(&left[t], vdup_n_f32(0.0f), 0);
+        in = vld1_lane_f32(&right[t], in, 1);
+        float32x4_t in4 = vcombine_f32(in, in);
+        vst1q_f32(x, vaddq_f32(in4, vmulq_f32(ga, a)));
+        if (eight) {
+            vst1q_f32(&x[4], vaddq_f32(in4, vmulq_f32(gb, b)));
+        }
+
+        float32x2_t out = vadd_f32(in, vmul_n_f32(lr, f->out));
+        vst1_lane_f32(&left[t], out, 0);
+        vst1_lane_f32(&right[t], out, 1);
+    }
+
+    for (int o = 0; o < order; o++) {
+        vst1q_f32(&f->lp[o][0], lpa[o]);
+        if (eight) {
+            vst1q_f32(&f->lp[o][4], lpb[o]);
+        }
+    }
+}
+
+static void neon_fdn(struct fdn *f,
+                     float *taps,
+                     float *left,
+                     float *right,
+                     int len)
+{
+    int order = f->order;
+    if (f->lines == REVERB_LINES) {
+        if (order == 0) {
+            neon_fdn_body(f, taps, left, right, len, REVERB_LINES, 0);
+        } else if (order == 1) {
+            neon_fdn_body(f, taps, left, right, len, REVERB_LINES, 1);
+        } else {
+            neon_fdn_body(f, taps, left, right, len, REVERB_LINES, 2);
+        }
+    } else {
+        if (order == 0) {
+            neon_fdn_body(f, taps, left, right, len, 4, 0);
+        } else if (order == 1) {
+            neon_fdn_body(f, taps, left, right, len, 4, 1);
+        } else {
+            neon_fdn_body(f, taps, left, right, len, 4, 2);
+        }
+    }
+}
+
+static void neon_reduce(float *mix, const float *acc, int len)
+{
+    int vlen = len & ~3;
+    for (int i = 0; i < vlen; i += 4) {
+        /* VLD4 de-interleaves four samples' worth of lanes so that each
+         * register holds one lane across four consecutive samples. */
+        float32x4x4_t lanes = vld4q_f32(&acc[i * VOICE_LANES]);
+        float32x4_t sum = vaddq_f32(vaddq_f32(lanes.val[0], lanes.val[1]),
+                                    vaddq_f32(lanes.val[2], lanes.val[3]));
+        vst1q_f32(&mix[i], sum);
+    }
+
+    kernels_scalar.reduce(&mix[vlen], &acc[vlen * VOICE_LANES], len - vlen);
+}
+
+/* The half-band filters go four output samples at a time, a tap at a time, so
+ * that each lane adds up its own sample's taps in the same order as the scalar
+ * kernel and there's nothing to add across lanes at the end. */
+static void neon_halfband_up(const float *coef,
+                             int taps,
+                             float *out,
+                             const float *x,
+                             int len)
+{
+    int vlen = len & ~3;
+    for (int i = 0; i < vlen; i += 4) {
+        float32x4_t acc = vdupq_n_f32(0.0f);
+        for (int k = 0; k < taps; k++) {
+            acc = vmlaq_n_f32(acc, vld1q_f32(&x[i + k]), coef[k]);
+        }
+
+        float32x4x2_t phases = {
+            { vld1q_f32(&x[i + taps / 2 - 1]), vaddq_f32(acc, acc) }
+        };
+        vst2q_f32(&out[2 * i], phases);
+    }
+
+    kernels_scalar.halfband_up(coef,
+                               taps,
+                               &out[2 * vlen],
+                               &x[vlen],
+                               len - vlen);
+}
+
+/* Going down, the even and odd samples are pulled apart as they're loaded. */
+static void neon_halfband_down(const float *coef,
+                               int taps,
+                               float *out,
+                               const float *x,
+                               int len)
+{
+    int vlen = len & ~3;
+    for (int i = 0; i < vlen; i += 4) {
+        float32x4_t acc = vdupq_n_f32(0.0f);
+        for (int k = 0; k < taps; k++) {
+            acc = vmlaq_n_f32(acc, vld2q_f32(&x[2 * (i + k)]).val[0], coef[k]);
+        }
+
+        float32x4_t centre = vld2q_f32(&x[2 * (i + taps / 2 - 1)]).val[1];
+        vst1q_f32(&out[i], vaddq_f32(acc, vmulq_n_f32(centre, 0.5f)));
+    }
+
+    kernels_scalar.halfband_down(coef,
+                                 taps,
+                                 &out[vlen],
+                                 &x[2 * vlen],
+                                 len - vlen);
+}
+
+static void neon_drive(float *buf, float gain, float level, int len)
+{
+    float32x4_t high = vdupq_n_f32(1.0f);
+    float32x4_t low = vdupq_n_f32(-1.0f);
+    float32x4_t three_halves = vdupq_n_f32(1.5f);
+
+    int vlen = len & ~3;
+    for (int i = 0; i < vlen; i += 4) {
+        float32x4_t v = vmulq_n_f32(vld1q_f32(&buf[i]), gain);
+        v = vmaxq_f32(vminq_f32(v, high), low);
+        float32x4_t t = vsubq_f32(three_halves,
+                                  vmulq_n_f32(vmulq_f32(v, v), 0.5f));
+        vst1q_f32(&buf[i], vmulq_n_f32(vmulq_f32(v, t), level));
+    }
+
+    kernels_scalar.drive(&buf[vlen], gain, level, len - vlen);
+}
+
+static void neon_gain(float *buf, float gain, int len)
+{
+    int vlen = len & ~3;
+    for (int i = 0; i < vlen; i += 4) {
+        vst1q_f32(&buf[i], vmulq_n_f32(vld1q_f32(&buf[i]), gain));
+    }
+
+    kernels_scalar.gain(&buf[vlen], gain, len - vlen);
+}
+
+static void neon_mix(float *dst, const float *src, int len)
+{
+    int vlen = len & ~3;
+    for (int i = 0; i < vlen; i += 4) {
+        vst1q_f32(&dst[i], vaddq_f32(vld1q_f32(&dst[i]), vld1q_f32(&src[i])));
+    }
+
+    kernels_scalar.mix(&dst[vlen], &src[vlen], len - vlen);
+}
+
+static inline uint32x4_t neon_pwm(float32x4_t sample)
+{
+    sample = vmaxq_f32(vminq_f32(sample, vdupq_n_f32(1.0f)),
+                       vdupq_n_f32(-1.0f));
+
+    /* Like the C cast, VCVT truncates towards zero. */
+    int32x4_t swing = vcvtq_s32_f32(vmulq_n_f32(sample, SAMPLE_SWING));
+    return vreinterpretq_u32_s32(vaddq_s32(vdupq_n_s32(SAMPLE_MID), swing));
+}
+
+static void neon_interleave(uint32_t *out,
+                            const float *left,
+                            const float *right,
+                            int len)
+{
+    int vlen = len & ~3;
+
+    for (int i = 0; i < vlen; i += 4) {
+        /* VST2 interleaves its two registers as it stores them, which gives us
+         * the left/right pairs for free. */
+        uint32x4x2_t stereo = {
+            { neon_pwm(vld1q_f32(&left[i])), neon_pwm(vld1q_f32(&right[i])) }
+        };
+        vst2q_u32(&out[i * 2], stereo);
+    }
+
+    kernels_scalar.interleave(&out[vlen * 2],
+                              &left[vlen],
+                              &right[vlen],
+                              len - vlen);
+}
+
+/* Eight samples of each channel at a time.  Adding 32768 to a 16-bit sample
+ * is the same as flipping its top bit, after which it's unsigned, so it can
+ * be shifted down and zero-extended to 32 bits as it is. */
+static void neon_pcm16(uint32_t *out,
+                       const int16_t *left,
+                       const int16_t *right,
+                       int len)
+{
+    int vlen = len & ~7;
+    uint16x8_t bias = vdupq_n_u16(0x8000);
+
+    for (int i = 0; i < vlen; i += 8) {
+        uint16x8_t l = veorq_u16(vreinterpretq_u16_s16(vld1q_s16(&left[i])),
+                                 bias);
+        uint16x8_t r = veorq_u16(vreinterpretq_u16_s16(vld1q_s16(&right[i])),
+                                 bias);
+        l = vshrq_n_u16(l, 4);
+        r = vshrq_n_u16(r, 4);
+
+        uint32x4x2_t low = {
+            { vmovl_u16(vget_low_u16(l)), vmovl_u16(vget_low_u16(r)) }
+        };
+        uint32x4x2_t high = {
+            { vmovl_u16(vget_high_u16(l)), vmovl_u16(vget_high_u16(r)) }
+        };
+        vst2q_u32(&out[i * 2], low);
+        vst2q_u32(&out[i * 2 + 8], high);
+    }
+
+    kernels_scalar.pcm16(&out[vlen * 2],
+                         &left[vlen],
+                         &right[vlen],
+                         len - vlen);
+}
+
+/* Both channels of the noise shaper side by side, one sample at a time, as
+ * scalar_shape() does them.  The results are already in left/right order, so
+ * each sample's pair is stored straight out. */
+static void neon_quantize(struct dither *d,
+                          uint32_t *out,
+                          const float *left,
+                          const float *right,
+                          int len)
+{
+    uint32x4_t seed = vld1q_u32(d->seed);
+    uint32x4_t mul = vdupq_n_u32(DITHER_MUL);
+    uint32x4_t add = vdupq_n_u32(DITHER_ADD);
+    float32x2_t e1 = vld1_f32(d->e1);
+    float32x2_t e2 = vld1_f32(d->e2);
+    float32x2_t high = vdup_n_f32(1.0f);
+    float32x2_t low = vdup_n_f32(-1.0f);
+    float32x2_t offset = vdup_n_f32(SAMPLE_MID + 0.5f);
+    int32x2_t mid = vdup_n_s32(SAMPLE_MID);
+
+    for (int i = 0; i < len; i++) {
+        /* Lanes 0 and 1 are the first random number of each channel, and 2
+         * and 3 the second. */
+        seed = vmlaq_u32(add, seed, mul);
+        float32x4_t u = vmulq_n_f32(vcvtq_f32_u32(vshrq_n_u32(seed, 8)),
+                                    DITHER_SCALE);
+        float32x2_t dither = vsub_f32(vget_low_f32(u), vget_high_f32(u));
+
+        float32x2_t x = vld1_lane_f32(&left[i], vdup_n_f32(0.0f), 0);
+        x = vld1_lane_f32(&right[i], x, 1);
+        x = vmax_f32(vmin_f32(x, high), low);
+
+        float32x2_t v = vadd_f32(vsub_f32(vmul_n_f32(x, SAMPLE_SWING),
+                                          vadd_f32(e1, e1)),
+                                 e2);
+        int32x2_t q = vcvt_s32_f32(vadd_f32(vadd_f32(v, dither), offset));
+        e2 = e1;
+        e1 = vsub_f32(vcvt_f32_s32(vsub_s32(q, mid)), v);
+
+        q = vmax_s32(vmin_s32(q, vdup_n_s32(SAMPLE_HIGH)),
+                     vdup_n_s32(SAMPLE_LOW));
+        vst1_u32(&out[i * 2], vreinterpret_u32_s32(q));
+    }
+
+    vst1q_u32(d->seed, seed);
+    vst1_f32(d->e1, e1);
+    vst1_f32(d->e2, e2);
+}
+
+const struct kernels kernels_neon = {
+    .name = "neon",
+    .saw = neon_saw,
+    .pulse = neon_pulse,
+    .saw4 = neon_saw4,
+    .pulse4 = neon_pulse4,
+    .table4 = neon_table4,
+    .table4_cubic = neon_table4_cubic,
+    .fm4 = {
+        neon_fm0,
+        neon_fm1,
+        neon_fm2,
+        neon_fm3,
+        neon_fm4,
+        neon_fm5,
+        neon_fm6,
+        neon_fm7
+    },
+    .unison4 = neon_unison4,
+    .additive4 = neon_additive4,
+    .sampler4 = {
+        [SAMPLER_LINEAR] = neon_sampler_linear,
+        [SAMPLER_HERMITE] = neon_sampler_hermite,
+        [SAMPLER_SINC] = neon_sampler_sinc
+    },
+    .svf4 = neon_svf4,
+    .fdn = neon_fdn,
+    .reduce = neon_reduce,
+    .halfband_up = neon_halfband_up,
+    .halfband_down = neon_halfband_down,
+    .drive = neon_drive,
+    .gain = neon_gain,
+    .mix = neon_mix,
+    .interleave = neon_interleave,
+    .pcm16 = neon_pcm16,
+    .quantize = neon_quantize
+};
@@ -0,0 +1,752 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <caboose-platform/cpu.h>
+
+#include "blep.h"
+#include "fm.h"
+#include "kernels.h"
+#include "sampler.h"
+#include "wavetable.h"
+
+/* The scalar voice-group kernels do each lane in turn, with exactly the
+ * arithmetic of one NEON lane. */
+static void scalar_saw4(struct voicebank *vb, int group, float *acc, int len)
+{
+    for (int lane = 0; lane < VOICE_LANES; lane++) {
+        int v = group * VOICE_LANES + lane;
+        uint32_t phase = vb->phase[v];
+        uint32_t inc = vb->inc[v];
+        float dt = inc * PHASE_SCALE;
+        float inv_dt = vb->inv_dt[v];
+        float level = vb->level[v];
+        float step = vb->step[v];
+        bool gate = vb->gate[v];
+
+        for (int i = 0; i < len; i++) {
+            float t = phase * PHASE_SCALE;
+            float sample = t + t - 1.0f - polyblep(t, dt, inv_dt);
+            acc[i * VOICE_LANES + lane] += gate ? sample * level : 0.0f;
+            level += step;
+            phase += inc;
+        }
+
+        vb->phase[v] = phase;
+    }
+}
+
+static void scalar_pulse4(struct voicebank *vb, int group, float *acc, int len)
+{
+    for (int lane = 0; lane < VOICE_LANES; lane++) {
+        int v = group * VOICE_LANES + lane;
+        uint32_t phase = vb->phase[v];
+        uint32_t inc = vb->inc[v];
+        uint32_t width = vb->width[v];
+        float dt = inc * PHASE_SCALE;
+        float inv_dt = vb->inv_dt[v];
+        float level = vb->level[v];
+        float step = vb->step[v];
+        bool gate = vb->gate[v];
+
+        for (int i = 0; i < len; i++) {
+            float t = phase * PHASE_SCALE;
+            float t2 = (uint32_t)(phase - width) * PHASE_SCALE;
+            float sample = phase < width ? 1.0f : -1.0f;
+            sample += polyblep(t, dt, inv_dt) - polyblep(t2, dt, inv_dt);
+            acc[i * VOICE_LANES + lane] += gate ? sample * level : 0.0f;
+            level += step;
+            phase += inc;
+        }
+
+        vb->phase[v] = phase;
+    }
+}
+
+static inline void scalar_table(struct voicebank *vb,
+                                int group,
+                                const struct wavetable *wt,
+                                float morph,
+                                bool cubic,
+                                float *acc,
+                                int len)
+{
+    float blend;
+    int frame = wavetable_frame(morph, &blend);
+
+    for (int lane = 0; lane < VOICE_LANES; lane++) {
+        int v = group * VOICE_LANES + lane;
+        uint32_t phase = vb->phase[v];
+        uint32_t inc = vb->inc[v];
+        float level = vb->level[v];
+        float step = vb->step[v];
+        bool gate = vb->gate[v];
+        const float *a = wt->row[wavetable_level(inc)][frame];
+        const float *b = a + WAVETABLE_ROW;
+
+        for (int i = 0; i < len; i++) {
+            uint32_t j = phase >> (32 - WAVETABLE_BITS);
+            float x = (phase & WAVETABLE_FRAC_MASK) * WAVETABLE_FRAC_SCALE;
+            float sa, sb;
+            if (cubic) {
+                sa = wavetable_cubic(&a[j], x);
+                sb = wavetable_cubic(&b[j], x);
+            } else {
+                sa = a[j + 1] + (a[j + 2] - a[j + 1]) * x;
+                sb = b[j + 1] + (b[j + 2] - b[j + 1]) * x;
+            }
+
+            float sample = sa + (sb - sa) * blend;
+            acc[i * VOICE_LANES + lane] += gate ? sample * level : 0.0f;
+            level += step;
+            phase += inc;
+        }
+
+        vb->phase[v] = phase;
+    }
+}
+
+static void scalar_table4(struct voicebank *vb,
+                          int group,
+                          const struct wavetable *wt,
+                          float morph,
+                          float *acc,
+                          int len)
+{
+    scalar_table(vb, group, wt, morph, false, acc, len);
+}
+
+static void scalar_table4_cubic(struct voicebank *vb,
+                                int group,
+                                const struct wavetable *wt,
+                                float morph,
+                                float *acc,
+                                int len)
+{
+    scalar_table(vb, group, wt, morph, true, acc, len);
+}
+
+/* The body of every FM kernel.  Each one calls this with a constant @alg, so
+ * once it's inlined the algorithm's routing is folded into straight-line code
+ * and the loops over operators and their modulators unroll away. */
+static inline __attribute__((always_inline)) void scalar_fm(
+    struct voicebank *vb,
+    int group,
+    float feedback,
+    float *acc,
+    int len,
+    const int alg)
+{
+    const struct fmalgorithm *a = &fm_algorithms[alg];
+    float carrier_gain = 1.0f / __builtin_popcount(a->carriers);
+    float fbk = feedback * 0.5f;
+
+    for (int lane = 0; lane < VOICE_LANES; lane++) {
+        int v = group * VOICE_LANES + lane;
+        float level = vb->level[v];
+        float step = vb->step[v];
+        bool gate = vb->gate[v];
+        float fb1 = vb->fm_fb1[v];
+        float fb2 = vb->fm_fb2[v];
+
+        uint32_t phase[FM_OPS], inc[FM_OPS];
+        float oplevel[FM_OPS], opstep[FM_OPS];
+        for (int op = 0; op < FM_OPS; op++) {
+            phase[op] = vb->fm_phase[op][v];
+            inc[op] = vb->fm_inc[op][v];
+            oplevel[op] = vb->fm_level[op][v];
+            opstep[op] = vb->fm_step[op][v];
+        }
+
+        for (int i = 0; i < len; i++) {
+            float out[FM_OPS];
+            for (int op = FM_OPS - 1; op >= 0; op--) {
+                float mod = op == FM_OPS - 1 ? (fb1 + fb2) * fbk : 0.0f;
+                for (int src = op + 1; src < FM_OPS; src++) {
+                    if (a->mods[op] & (1 << src)) {
+                        mod += out[src];
+                    }
+                }
+
+                uint32_t offset = (uint32_t)(int32_t)(mod * FM_PHASE_SCALE)
+                                  << FM_PHASE_SHIFT;
+                out[op] = fm_sine(phase[op] + offset) * oplevel[op];
+                oplevel[op] += opstep[op];
+                phase[op] += inc[op];
+            }
+
+            fb2 = fb1;
+            fb1 = out[FM_OPS - 1];
+
+            float sum = 0.0f;
+            for (int op = 0; op < FM_OPS; op++) {
+                if (a->carriers & (1 << op)) {
+                    sum += out[op];
+                }
+            }
+
+            float sample = sum * carrier_gain;
+            acc[i * VOICE_LANES + lane] += gate ? sample * level : 0.0f;
+            level += step;
+        }
+
+        for (int op = 0; op < FM_OPS; op++) {
+            vb->fm_phase[op][v] = phase[op];
+        }
+        vb->fm_fb1[v] = fb1;
+        vb->fm_fb2[v] = fb2;
+    }
+}
+
+#define SCALAR_FM(alg)                                                      \
+    static void scalar_fm##alg(struct voicebank *vb,                        \
+                               int group,                                   \
+                               float feedback,                              \
+                               float *acc,                                  \
+                               int len)                                     \
+    {                                                                       \
+        scalar_fm(vb, group, feedback, acc, len, alg);                      \
+    }
+
+SCALAR_FM(0)
+SCALAR_FM(1)
+SCALAR_FM(2)
+SCALAR_FM(3)
+SCALAR_FM(4)
+SCALAR_FM(5)
+SCALAR_FM(6)
+SCALAR_FM(7)
+
+/* The body of every sampler kernel, with a constant @interp.  The sinc's taps
+ * are summed in the order the NEON version's are: taps k and k + 4 share a
+ * lane, and then the lanes are folded in half twice.  Every voice moves
+ * through its sample whether or not it's sounding, just as the oscillators
+ * do. */
+static inline __attribute__((always_inline)) void scalar_sampler(
+    struct voicebank *vb,
+    int group,
+    float *acc,
+    int len,
+    const enum sampler_interp interp)
+{
+    for (int lane = 0; lane < VOICE_LANES; lane++) {
+        int v = group * VOICE_LANES + lane;
+        uint32_t pos = vb->smp_pos[v];
+        uint32_t frac = vb->smp_frac[v];
+        uint32_t step = vb->smp_step[v];
+        uint32_t step_frac = vb->smp_step_frac[v];
+        const int16_t *data = vb->smp_data[v];
+        uint32_t frames = vb->smp_frames[v];
+        uint32_t end = vb->smp_end[v];
+        uint32_t loop = vb->smp_loop[v];
+        float level = vb->level[v];
+        float lstep = vb->step[v];
+        bool gate = vb->gate[v];
+
+        for (int i = 0; i < len; i++) {
+            float sample;
+            if (interp == SAMPLER_SINC) {
+                uint32_t at = pos - (SAMPLER_REACH - 1);
+                const float *c =
+                    sampler_sinc[frac >> (32 - SAMPLER_SINC_BITS)];
+                float s[4];
+                for (int k = 0; k < 4; k++) {
+                    s[k] = sampler_frame(data, frames, at + k) * c[k]
+                           + sampler_frame(data, frames, at + k + 4)
+                             * c[k + 4];
+                }
+                sample = (s[0] + s[2]) + (s[1] + s[3]);
+            } else {
+                float q[4];
+                for (int k = 0; k < 4; k++) {
+                    q[k] = sampler_frame(data, frames, pos - 1 + k);
+                }
+                float x = sampler_fraction(frac);
+                sample = interp == SAMPLER_LINEAR
+                         ? q[1] + (q[2] - q[1]) * x
+                         : wavetable_cubic(q, x);
+            }
+
+            acc[i * VOICE_LANES + lane] += gate ? sample * level : 0.0f;
+            level += lstep;
+
+            uint32_t next = frac + step_frac;
+            pos += step + (next < frac);
+            pos -= pos < end ? 0 : loop;
+            pos = pos < end ? pos : end;
+            frac = next;
+        }
+
+        vb->smp_pos[v] = pos;
+        vb->smp_frac[v] = frac;
+    }
+}
+
+#define SCALAR_SAMPLER(name, interp)                                        \
+    static void scalar_sampler_##name(struct voicebank *vb,                 \
+                                      int group,                            \
+                                      float *acc,                           \
+                                      int len)                              \
+    {                                                                       \
+        scalar_sampler(vb, group, acc, len, interp);                        \
+    }
+
+SCALAR_SAMPLER(linear, SAMPLER_LINEAR)
+SCALAR_SAMPLER(hermite, SAMPLER_HERMITE)
+SCALAR_SAMPLER(sinc, SAMPLER_SINC)
+
+/* Here the lanes are a voice's copies rather than voices, and the scalar
+ * kernel pans and sums them exactly as the NEON one does: copies c and c + 4
+ * share a lane, and the lanes are then folded in half twice.  @lanes is
+ * constant in each of the two copies of this that the kernel inlines, so the
+ * copies past the fourth cost nothing when there aren't any. */
+static inline __attribute__((always_inline)) void scalar_unison(
+    struct voicebank *vb,
+    int group,
+    const float pan[2][UNISON_MAX],
+    float *left,
+    float *right,
+    int len,
+    const int lanes)
+{
+    for (int voice = 0; voice < VOICE_LANES; voice++) {
+        int v = group * VOICE_LANES + voice;
+        if (!vb->gate[v]) {
+            continue;
+        }
+
+        uint32_t phase[UNISON_MAX], inc[UNISON_MAX];
+        float dt[UNISON_MAX], inv_dt[UNISON_MAX];
+        for (int c = 0; c < lanes; c++) {
+            phase[c] = vb->uni_phase[v][c];
+            inc[c] = vb->uni_inc[v][c];
+            dt[c] = inc[c] * PHASE_SCALE;
+            inv_dt[c] = vb->uni_inv_dt[v][c];
+        }
+        float level = vb->level[v];
+        float step = vb->step[v];
+
+        for (int i = 0; i < len; i++) {
+            float l[VOICE_LANES], r[VOICE_LANES];
+            for (int c = 0; c < lanes; c++) {
+                float t = phase[c] * PHASE_SCALE;
+                float sample = t + t - 1.0f - polyblep(t, dt[c], inv_dt[c]);
+                int lane = c % VOICE_LANES;
+                if (c < VOICE_LANES) {
+                    l[lane] = sample * pan[0][c];
+                    r[lane] = sample * pan[1][c];
+                } else {
+                    l[lane] = l[lane] + sample * pan[0][c];
+                    r[lane] = r[lane] + sample * pan[1][c];
+                }
+                phase[c] += inc[c];
+            }
+
+            float suml = (l[0] + l[2]) + (l[1] + l[3]);
+            float sumr = (r[0] + r[2]) + (r[1] + r[3]);
+            left[i * VOICE_LANES + voice] += suml * level;
+            right[i * VOICE_LANES + voice] += sumr * level;
+            level += step;
+        }
+
+        for (int c = 0; c < lanes; c++) {
+            vb->uni_phase[v][c] = phase[c];
+        }
+    }
+}
+
+static void scalar_unison4(struct voicebank *vb,
+                           int group,
+                           int copies,
+                           const float pan[2][UNISON_MAX],
+                           float *left,
+                           float *right,
+                           int len)
+{
+    if (copies > VOICE_LANES) {
+        scalar_unison(vb, group, pan, left, right, len, UNISON_MAX);
+    } else {
+        scalar_unison(vb, group, pan, left, right, len, VOICE_LANES);
+    }
+}
+
+/* A voice at a time, a partial at a time: each partial's samples for a chunk
+ * are added into the lane of a per-sample sum that it shares with every fourth
+ * partial, and then the lanes are folded and the result scaled by the voice's
+ * level.  That's the order the NEON version, which has four partials to a
+ * register, adds them up in. */
+static void scalar_additive4(struct voicebank *vb,
+                             struct additivebank *ab,
+                             int group,
+                             float *acc,
+                             int len)
+{
+    for (int voice = 0; voice < VOICE_LANES; voice++) {
+        int i = group * VOICE_LANES + voice;
+        struct additivevoice *v = &ab->voice[i];
+        if (!vb->gate[i]) {
+            continue;
+        }
+
+        float amp[ADDITIVE_PARTIALS];
+        for (int p = 0; p < v->count; p++) {
+            amp[p] = v->amp[p];
+        }
+        float level = vb->level[i];
+        float step = vb->step[i];
+
+        for (int at = 0; at < len; at += ADDITIVE_CHUNK) {
+            int n = len - at < ADDITIVE_CHUNK ? len - at : ADDITIVE_CHUNK;
+            float sum[ADDITIVE_CHUNK][VOICE_LANES];
+            for (int t = 0; t < n; t++) {
+                for (int lane = 0; lane < VOICE_LANES; lane++) {
+                    sum[t][lane] = 0.0f;
+                }
+            }
+
+            for (int p = 0; p < v->count; p++) {
+                float re = v->re[p], im = v->im[p];
+                float cr = v->rot_re[p], ci = v->rot_im[p];
+                float a = amp[p], da = v->step[p];
+                for (int t = 0; t < n; t++) {
+                    sum[t][p % VOICE_LANES] += a * im;
+                    a += da;
+                    float next = re * cr - im * ci;
+                    im = re * ci + im * cr;
+                    re = next;
+                }
+                v->re[p] = re;
+                v->im[p] = im;
+                amp[p] = a;
+            }
+
+            for (int t = 0; t < n; t++) {
+                float s = (sum[t][0] + sum[t][2]) + (sum[t][1] + sum[t][3]);
+                acc[(at + t) * VOICE_LANES + voice] += s * level;
+                level += step;
+            }
+        }
+
+        /* To first order, this scales the phasor back onto the unit circle. */
+        for (int p = 0; p < v->count; p++) {
+            float re = v->re[p], im = v->im[p];
+            float g = 1.5f - (re * re + im * im) * 0.5f;
+            v->re[p] = re * g;
+            v->im[p] = im * g;
+        }
+    }
+}
+
+static void scalar_svf4(struct voicebank *vb,
+                        int group,
+                        int channel,
+                        const struct svfmix *mix,
+                        float *buf,
+                        int len)
+{
+    for (int lane = 0; lane < VOICE_LANES; lane++) {
+        int v = group * VOICE_LANES + lane;
+        float a1 = vb->svf_a1[v];
+        float a2 = vb->svf_a2[v];
+        float a3 = vb->svf_a3[v];
+        float ic1 = vb->svf_ic1[channel][v];
+        float ic2 = vb->svf_ic2[channel][v];
+
+        for (int i = 0; i < len; i++) {
+            float *x = &buf[i * VOICE_LANES + lane];
+            float v0 = *x;
+            float v3 = v0 - ic2;
+            float v1 = a1 * ic1 + a2 * v3;
+            float v2 = (ic2 + a2 * ic1) + a3 * v3;
+            ic1 = (v1 + v1) - ic1;
+            ic2 = (v2 + v2) - ic2;
+
+            *x = (mix->high * v0 + mix->band * v1) + mix->low * v2;
+        }
+
+        vb->svf_ic1[channel][v] = ic1;
+        vb->svf_ic2[channel][v] = ic2;
+    }
+}
+
+/* The butterflies of a 4-point Hadamard transform, in place, in the order the
+ * NEON version does them. */
+static inline void scalar_hadamard4(float *v)
+{
+    float a0 = v[0] + v[2], a1 = v[1] + v[3];
+    float a2 = v[0] - v[2], a3 = v[1] - v[3];
+    v[0] = a0 + a1;
+    v[1] = a0 - a1;
+    v[2] = a2 + a3;
+    v[3] = a2 - a3;
+}
+
+static inline void scalar_fdn_body(struct fdn *f,
+                                   float *taps,
+                                   float *left,
+                                   float *right,
+                                   int len,
+                                   int lines,
+                                   int order)
+{
+    float lp[REVERB_MAX_ORDER][REVERB_LINES];
+    for (int o = 0; o < order; o++) {
+        for (int i = 0; i < lines; i++) {
+            lp[o][i] = f->lp[o][i];
+        }
+    }
+
+    for (int t = 0; t < len; t++) {
+        float *x = &taps[t * REVERB_LINES];
+        float d[REVERB_LINES];
+        for (int i = 0; i < lines; i++) {
+            d[i] = x[i];
+            for (int o = 0; o < order; o++) {
+                lp[o][i] = lp[o][i] + (d[i] - lp[o][i]) * f->damp;
+                d[i] = lp[o][i];
+            }
+        }
+
+        float l, r;
+        if (lines == REVERB_LINES) {
+            l = (d[0] + d[4]) + (d[2] + d[6]);
+            r = (d[1] + d[5]) + (d[3] + d[7]);
+        } else {
+            l = d[0] + d[2];
+            r = d[1] + d[3];
+        }
+
+        if (lines == REVERB_LINES) {
+            for (int i = 0; i < 4; i++) {
+                float a = d[i], b = d[i + 4];
+                d[i] = a + b;
+                d[i + 4] = a - b;
+            }
+            scalar_hadamard4(&d[4]);
+        }
+        scalar_hadamard4(d);
+
+        float in[2] = { left[t], right[t] };
+        for (int i = 0; i < lines; i++) {
+            x[i] = in[i & 1] + f->gain[i] * d[i];
+        }
+
+        left[t] = in[0] + l * f->out;
+        right[t] = in[1] + r * f->out;
+    }
+
+    for (int o = 0; o < order; o++) {
+        for (int i = 0; i < lines; i++) {
+            f->lp[o][i] = lp[o][i];
+        }
+    }
+}
+
+/* Each configuration gets its own copy of the loop with the line count and
+ * filter order known, so that none of the decisions are made per sample. */
+static void scalar_fdn(struct fdn *f,
+                       float *taps,
+                       float *left,
+                       float *right,
+                       int len)
+{
+    int order = f->order;
+    if (f->lines == REVERB_LINES) {
+        if (order == 0) {
+            scalar_fdn_body(f, taps, left, right, len, REVERB_LINES, 0);
+        } else if (order == 1) {
+            scalar_fdn_body(f, taps, left, right, len, REVERB_LINES, 1);
+        } else {
+            scalar_fdn_body(f, taps, left, right, len, REVERB_LINES, 2);
+        }
+    } else {
+        if (order == 0) {
+            scalar_fdn_body(f, taps, left, right, len, 4, 0);
+        } else if (order == 1) {
+            scalar_fdn_body(f, taps, left, right, len, 4, 1);
+        } else {
+            scalar_fdn_body(f, taps, left, right, len, 4, 2);
+        }
+    }
+}
+
+static void scalar_reduce(float *mix, const float *acc, int len)
+{
+    for (int i = 0; i < len; i++) {
+        const float *lanes = &acc[i * VOICE_LANES];
+        mix[i] = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    }
+}
+
+/* The odd phase of the output comes from the nonzero taps, and the even phase
+ * is the middle tap's, just a copy of the input.  Both phases are delayed by
+ * half the filter, so the copy comes first. */
+static void scalar_halfband_up(const float *coef,
+                               int taps,
+                               float *out,
+                               const float *x,
+                               int len)
+{
+    for (int i = 0; i < len; i++) {
+        float acc = 0.0f;
+        for (int k = 0; k < taps; k++) {
+            acc += coef[k] * x[i + k];
+        }
+
+        /* (Doubled, as every other sample going in was a zero.) */
+        out[2 * i] = x[i + taps / 2 - 1];
+        out[2 * i + 1] = acc + acc;
+    }
+}
+
+/* The other way around, the nonzero taps go over the even samples, and the
+ * middle one picks out an odd one. */
+static void scalar_halfband_down(const float *coef,
+                                 int taps,
+                                 float *out,
+                                 const float *x,
+                                 int len)
+{
+    for (int i = 0; i < len; i++) {
+        float acc = 0.0f;
+        for (int k = 0; k < taps; k++) {
+            acc += coef[k] * x[2 * (i + k)];
+        }
+
+        out[i] = acc + 0.5f * x[2 * (i + taps / 2 - 1) + 1];
+    }
+}
+
+static void scalar_drive(float *buf, float gain, float level, int len)
+{
+    for (int i = 0; i < len; i++) {
+        float v = buf[i] * gain;
+        v = v > 1.0f ? 1.0f : v;
+        v = v < -1.0f ? -1.0f : v;
+        buf[i] = (v * (1.5f - 0.5f * (v * v))) * level;
+    }
+}
+
+static void scalar_gain(float *buf, float gain, int len)
+{
+    for (int i = 0; i < len; i++) {
+        buf[i] *= gain;
+    }
+}
+
+static void scalar_mix(float *dst, const float *src, int len)
+{
+    for (int i = 0; i < len; i++) {
+        dst[i] += src[i];
+    }
+}
+
+static inline uint32_t scalar_pwm(float sample)
+{
+    sample = sample > 1.0f ? 1.0f : sample;
+    sample = sample < -1.0f ? -1.0f : sample;
+    return SAMPLE_MID + (int)(sample * SAMPLE_SWING);
+}
+
+static void scalar_interleave(uint32_t *out,
+                              const float *left,
+                              const float *right,
+                              int len)
+{
+    for (int i = 0; i < len; i++) {
+        *out++ = scalar_pwm(left[i]);
+        *out++ = scalar_pwm(right[i]);
+    }
+}
+
+static void scalar_pcm16(uint32_t *out,
+                         const int16_t *left,
+                         const int16_t *right,
+                         int len)
+{
+    for (int i = 0; i < len; i++) {
+        *out++ = (uint32_t)(left[i] + 32768) >> 4;
+        *out++ = (uint32_t)(right[i] + 32768) >> 4;
+    }
+}
+
+/* One channel of one sample of the noise shaper, with its TPDF @dither. */
+static inline uint32_t scalar_shape(float sample,
+                                    float dither,
+                                    float *e1,
+                                    float *e2)
+{
+    sample = sample > 1.0f ? 1.0f : sample;
+    sample = sample < -1.0f ? -1.0f : sample;
+
+    /* Everything's offset to be positive before the conversion, so that
+     * truncating it rounds down, which with the half added rounds to
+     * nearest. */
+    float v = (sample * SAMPLE_SWING - (*e1 + *e1)) + *e2;
+    int32_t q = (int32_t)((v + dither) + (SAMPLE_MID + 0.5f));
+    *e2 = *e1;
+    *e1 = (float)(q - SAMPLE_MID) - v;
+
+    q = q > SAMPLE_HIGH ? SAMPLE_HIGH : q;
+    return q < SAMPLE_LOW ? SAMPLE_LOW : q;
+}
+
+static void scalar_quantize(struct dither *d,
+                            uint32_t *out,
+                            const float *left,
+                            const float *right,
+                            int len)
+{
+    for (int i = 0; i < len; i++) {
+        float u[4];
+        for (int lane = 0; lane < 4; lane++) {
+            d->seed[lane] = DITHER_ADD + d->seed[lane] * DITHER_MUL;
+            u[lane] = (float)(d->seed[lane] >> 8) * DITHER_SCALE;
+        }
+
+        *out++ = scalar_shape(left[i], u[0] - u[2], &d->e1[0], &d->e2[0]);
+        *out++ = scalar_shape(right[i], u[1] - u[3], &d->e1[1], &d->e2[1]);
+    }
+}
+
+const struct kernels kernels_scalar = {
+    .name = "scalar",
+    .saw = blep_saw,
+    .pulse = blep_pulse,
+    .saw4 = scalar_saw4,
+    .pulse4 = scalar_pulse4,
+    .table4 = scalar_table4,
+    .table4_cubic = scalar_table4_cubic,
+    .fm4 = {
+        scalar_fm0,
+        scalar_fm1,
+        scalar_fm2,
+        scalar_fm3,
+        scalar_fm4,
+        scalar_fm5,
+        scalar_fm6,
+        scalar_fm7
+    },
+    .unison4 = scalar_unison4,
+    .additive4 = scalar_additive4,
+    .sampler4 = {
+        [SAMPLER_LINEAR] = scalar_sampler_linear,
+        [SAMPLER_HERMITE] = scalar_sampler_hermite,
+        [SAMPLER_SINC] = scalar_sampler_sinc
+    },
+    .svf4 = scalar_svf4,
+    .fdn = scalar_fdn,
+    .reduce = scalar_reduce,
+    .halfband_up = scalar_halfband_up,
+    .halfband_down = scalar_halfband_down,
+    .drive = scalar_drive,
+    .gain = scalar_gain,
+    .mix = scalar_mix,
+    .interleave = scalar_interleave,
+    .pcm16 = scalar_pcm16,
+    .quantize = scalar_quantize
+};
+
+const struct kernels *kernels_select(void)
+{
+    return cpu_has_neon() ? &kernels_neon : &kernels_scalar;
+}
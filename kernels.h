@@ -0,0 +1,181 @@
+#ifndef SXLHLG_KERNELS_H
+#define SXLHLG_KERNELS_H
+
+#include <stdint.h>
+
+#include "additive.h"
+#include "dither.h"
+#include "fm.h"
+#include "halfband.h"
+#include "osc.h"
+#include "reverb.h"
+#include "sampler.h"
+#include "svf.h"
+#include "unison.h"
+#include "voicebank.h"
+#include "wavetable.h"
+
+/* The PWM values the audio driver expects.  The mix is accumulated as floats in
+ * [-1, 1], which we map onto the SAMPLE_LOW..SAMPLE_HIGH swing. */
+#define SAMPLE_HIGH 6144
+#define SAMPLE_MID 4096
+#define SAMPLE_LOW 2048
+
+#define SAMPLE_SWING (SAMPLE_HIGH - SAMPLE_MID)
+
+/* The inner loops of the render path, each of which processes a whole block at
+ * a time.  There's a plain C implementation of every kernel that serves as the
+ * reference, and a NEON implementation that must produce bit-identical output
+ * (the whole tree is built with -ffp-contract=off so that the compiler can't
+ * fuse the scalar multiply-adds and break that). */
+struct kernels {
+    const char *name;
+
+    /* Band-limited oscillators, as in blep.h. */
+    void (*saw)(struct osc *o, float *out, int len);
+    void (*pulse)(struct osc *o, uint32_t width, float *out, int len);
+
+    /* Render the four voices of @group in @vb, adding each one's output (scaled
+     * by its level, ramped per sample) into its own lane of @acc, which holds
+     * VOICE_LANES floats per sample. */
+    void (*saw4)(struct voicebank *vb, int group, float *acc, int len);
+    void (*pulse4)(struct voicebank *vb, int group, float *acc, int len);
+
+    /* Wavetable voices, blending between the two frames of @wt either side of
+     * @morph (see wavetable.h) and interpolating between points either
+     * linearly or with wavetable_cubic(). */
+    void (*table4)(struct voicebank *vb,
+                   int group,
+                   const struct wavetable *wt,
+                   float morph,
+                   float *acc,
+                   int len);
+    void (*table4_cubic)(struct voicebank *vb,
+                         int group,
+                         const struct wavetable *wt,
+                         float morph,
+                         float *acc,
+                         int len);
+
+    /* FM voices, with one specialized kernel per algorithm (see fm.h) so that
+     * there's no decision about the routing left to make per sample.
+     * @feedback is the patch's. */
+    void (*fm4[FM_ALGORITHMS])(struct voicebank *vb,
+                               int group,
+                               float feedback,
+                               float *acc,
+                               int len);
+
+    /* Unison voices (see unison.h): render the first @copies copies of each
+     * sounding voice of @group in @vb as saws, one copy per lane, pan them by
+     * @pan and add them into the voice's lane of @left and @right, which are
+     * laid out like the accumulator.  Only the gates are per voice rather than
+     * per lane here, so voices that aren't sounding are skipped instead of
+     * masked. */
+    void (*unison4)(struct voicebank *vb,
+                    int group,
+                    int copies,
+                    const float pan[2][UNISON_MAX],
+                    float *left,
+                    float *right,
+                    int len);
+
+    /* Additive voices (see additive.h): render the partials in @ab of each
+     * sounding voice of @group in @vb, adding them into the voice's lane of
+     * @acc.  As for unison, the gates are per voice, and the partials are
+     * spread across the lanes instead. */
+    void (*additive4)(struct voicebank *vb,
+                      struct additivebank *ab,
+                      int group,
+                      float *acc,
+                      int len);
+
+    /* Sampler voices (see sampler.h), each playing its own sample, with one
+     * kernel per way of interpolating them. */
+    void (*sampler4[SAMPLER_INTERPS])(struct voicebank *vb,
+                                      int group,
+                                      float *acc,
+                                      int len);
+
+    /* Run the filters of the four voices of @group in @vb over @buf in place,
+     * where @buf is laid out like the accumulator.  @channel is 0 for mono or
+     * the left channel and 1 for the right, which has filter states of its
+     * own. */
+    void (*svf4)(struct voicebank *vb,
+                 int group,
+                 int channel,
+                 const struct svfmix *mix,
+                 float *buf,
+                 int len);
+
+    /* Run the reverb network @f over @len samples, at most REVERB_CHUNK.
+     * @taps holds REVERB_LINES floats per sample, the outputs of the delay
+     * lines, and is overwritten with what's to be fed back into them.  The
+     * dry @left and @right go into the even and odd lines respectively, and
+     * the reverb is added onto them. */
+    void (*fdn)(struct fdn *f, float *taps, float *left, float *right, int len);
+
+    /* Double the sample rate of @len samples through the half-band filter
+     * @coef, @taps long (see halfband.h), writing 2 * @len to @out.  @x
+     * starts with the last @taps - 1 samples before the new ones. */
+    void (*halfband_up)(const float *coef,
+                        int taps,
+                        float *out,
+                        const float *x,
+                        int len);
+
+    /* Halve it again, from 2 * @len samples to @len.  @x starts with the
+     * last 2 * (@taps - 1) samples before the new ones. */
+    void (*halfband_down)(const float *coef,
+                          int taps,
+                          float *out,
+                          const float *x,
+                          int len);
+
+    /* Soft-clip @buf in place: buf[i] = level * s(gain * buf[i]), where
+     * s(v) = 1.5v - 0.5v^3 for v in [-1, 1], flattening off to +/-1. */
+    void (*drive)(float *buf, float gain, float level, int len);
+
+    /* mix[i] = (acc[4i] + acc[4i + 1]) + (acc[4i + 2] + acc[4i + 3]) */
+    void (*reduce)(float *mix, const float *acc, int len);
+
+    /* buf[i] *= gain */
+    void (*gain)(float *buf, float gain, int len);
+
+    /* dst[i] += src[i] */
+    void (*mix)(float *dst, const float *src, int len);
+
+    /* Clip @left and @right to [-1, 1], convert them to PWM values and
+     * interleave them into @out, which is 2 * @len words long.  A mono mix is
+     * passed as both. */
+    void (*interleave)(uint32_t *out,
+                       const float *left,
+                       const float *right,
+                       int len);
+
+    /* Widen @len samples of signed 16-bit @left and @right to unsigned
+     * 12-bit words, (x + 32768) >> 4, and interleave them into @out, which is
+     * 2 * @len words long.  This is how samplesrc() plays its sample. */
+    void (*pcm16)(uint32_t *out,
+                  const int16_t *left,
+                  const int16_t *right,
+                  int len);
+
+    /* The same, but rounding to the PWM values with @d's dither and noise
+     * shaping (see dither.h) instead of truncating.  This is how the synth's
+     * output is quantized; the plain conversion is the baseline it's measured
+     * against. */
+    void (*quantize)(struct dither *d,
+                     uint32_t *out,
+                     const float *left,
+                     const float *right,
+                     int len);
+};
+
+extern const struct kernels kernels_scalar;
+extern const struct kernels kernels_neon;
+
+/* Pick the fastest set of kernels the hardware supports. */
+const struct kernels *kernels_select(void);
+
+#endif
@@ -0,0 +1,71 @@
+#include "audio.h"
+#include "fm.h"
+#include "lfo.h"
+
+/* Anything faster than this is audio-rate modulation, which stepping once per
+ * sub-block can't do justice to. */
+#define LFO_MAX_RATE 50.0f
+
+void lfo_reset(struct lfo *l)
+{
+    l->shape = LFO_SINE;
+    l->phase = 0;
+    l->inc = 0;
+    l->seed = 0x2545f491;
+    l->held = 0.0f;
+}
+
+void lfo_set(struct lfo *l, const struct lfopatch *p)
+{
+    float rate = p->rate;
+    rate = rate < 0.0f ? 0.0f : rate;
+    rate = rate > LFO_MAX_RATE ? LFO_MAX_RATE : rate;
+
+    l->shape = p->shape;
+    l->inc = (uint32_t)(rate * (4294967296.0f / AUDIO_SAMPLE_RATE));
+}
+
+/* A xorshift generator is plenty random enough for this. */
+static float lfo_random(struct lfo *l)
+{
+    uint32_t x = l->seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    l->seed = x;
+    return (int32_t)x * FM_SIN_SCALE;
+}
+
+float lfo_advance(struct lfo *l, int len)
+{
+    uint32_t before = l->phase;
+    l->phase += l->inc * len;
+
+    /* (The phase can't wrap more than once in a sub-block at LFO_MAX_RATE.) */
+    if (l->phase < before) {
+        l->held = lfo_random(l);
+    }
+
+    float x = (int32_t)l->phase * FM_SIN_SCALE;
+    switch (l->shape) {
+    case LFO_SINE:
+        return fm_sine(l->phase);
+    case LFO_TRIANGLE:
+    {
+        /* The same folding fm_sine() does, without the polynomial. */
+        float a = x < 0.0f ? -x : x;
+        float d = 0.5f - a;
+        float u = 0.5f - (d < 0.0f ? -d : d);
+        u = x < 0.0f ? -u : u;
+        return u + u;
+    }
+    case LFO_SAW:
+        return x;
+    case LFO_SQUARE:
+        return x < 0.0f ? -1.0f : 1.0f;
+    case LFO_RANDOM:
+        return l->held;
+    }
+
+    return 0.0f;
+}
@@ -0,0 +1,62 @@
+#ifndef SXLHLG_LFO_H
+#define SXLHLG_LFO_H
+
+#include <stdint.h>
+
+/* Low-frequency oscillators for the modulation matrix (see mod.h).  They're
+ * shared by every voice and, like the envelopes, only evaluated at control
+ * rate: the synth advances each one once per control sub-block and routes its
+ * value at the end of it. */
+#define LFO_COUNT 2
+
+enum lfo_shape {
+    LFO_SINE,
+    LFO_TRIANGLE,
+    LFO_SAW,
+    LFO_SQUARE,
+    LFO_RANDOM          /* a new random level every cycle */
+};
+
+/* The settings of one LFO, as they appear in the patch. */
+struct lfopatch {
+    enum lfo_shape shape;
+    float rate;         /* Hz */
+};
+
+struct lfo {
+    enum lfo_shape shape;
+    uint32_t phase;     /* 0.32 fixed point, like the oscillators' */
+    uint32_t inc;       /* per sample */
+    uint32_t seed;      /* for LFO_RANDOM */
+    float held;
+};
+
+void lfo_reset(struct lfo *l);
+
+/* Take up @p's settings, carrying on from the current phase. */
+void lfo_set(struct lfo *l, const struct lfopatch *p);
+
+/* Advance @l by @len samples and return its value at the end of them, in
+ * [-1, 1]. */
+float lfo_advance(struct lfo *l, int len);
+
+/* One cycle of a triangle with its corners rounded off, in [-1, 1], for the
+ * effects that sweep a delay time (see chorus.h).  The straight sides hold the
+ * pitch shift steady for most of the cycle, as a Juno's chorus does, and the
+ * rounding keeps it from jumping at the turns.  It's generated at build time
+ * by tools/mkmodtables.c, with the first point repeated at the end so that
+ * interpolating never has to wrap. */
+#define LFO_TABLE_BITS 8
+#define LFO_TABLE_LEN (1 << LFO_TABLE_BITS)
+
+extern const float lfo_rounded[LFO_TABLE_LEN + 1];
+
+/* The shape above at 0.32 fixed-point @phase, interpolated linearly. */
+static inline float lfo_lookup(const float *table, uint32_t phase)
+{
+    uint32_t i = phase >> (32 - LFO_TABLE_BITS);
+    float x = (phase << LFO_TABLE_BITS) * (1.0f / 4294967296.0f);
+    return table[i] + (table[i + 1] - table[i]) * x;
+}
+
+#endif
@@ -0,0 +1,110 @@
+#include <stdint.h>
+
+#include "audio.h"
+#include "kernels.h"
+#include "limiter.h"
+
+/* The loudest the limiter lets the mix get: the top of the PWM's range, less
+ * enough room for the dither to land on. */
+#define LIMITER_CEILING \
+    ((float)(AUDIO_PWM_RANGE - SAMPLE_MID - DITHER_PEAK - 1) / SAMPLE_SWING)
+
+/* How far the gain gets back up towards 1 each sample, for a release with a
+ * time constant of ~50ms. */
+#define LIMITER_RELEASE (1.0f / (0.05f * AUDIO_SAMPLE_RATE))
+
+/* The fixed-point gains are 16.16, so a window of them adds up without
+ * rounding. */
+#define LIMITER_ONE 65536
+
+void limiter_init(struct limiter *l)
+{
+    for (int i = 0; i < LIMITER_AHEAD; i++) {
+        l->line[0][i] = 0.0f;
+        l->line[1][i] = 0.0f;
+        l->gains[i] = LIMITER_ONE;
+    }
+
+    l->pos = 0;
+    l->head = 0;
+    l->count = 0;
+    l->release = 1.0f;
+    l->sum = LIMITER_ONE * LIMITER_AHEAD;
+    l->least = 1.0f;
+}
+
+static inline float magnitude(float x)
+{
+    return x < 0.0f ? -x : x;
+}
+
+void limiter_process(struct limiter *l, float *left, float *right, int len)
+{
+    uint32_t pos = l->pos;
+    uint32_t head = l->head;
+    uint32_t count = l->count;
+    float release = l->release;
+    uint32_t sum = l->sum;
+    float least = l->least;
+
+    for (int i = 0; i < len; i++) {
+        float xl = left[i], xr = right[i];
+        float peak = magnitude(xl) > magnitude(xr)
+                     ? magnitude(xl)
+                     : magnitude(xr);
+
+        /* The front of the queue drops out of the window a sample at a time,
+         * then this sample knocks out everything no louder than it from the
+         * back. */
+        if (count && pos - l->when[head] >= LIMITER_AHEAD) {
+            head = (head + 1) & LIMITER_MASK;
+            count--;
+        }
+        while (count && l->peak[(head + count - 1) & LIMITER_MASK] <= peak) {
+            count--;
+        }
+        uint32_t back = (head + count) & LIMITER_MASK;
+        l->peak[back] = peak;
+        l->when[back] = pos;
+        count++;
+
+        float loudest = l->peak[head];
+        float needed = loudest > LIMITER_CEILING
+                       ? LIMITER_CEILING / loudest
+                       : 1.0f;
+        release += (1.0f - release) * LIMITER_RELEASE;
+        release = needed < release ? needed : release;
+
+        /* Truncating to fixed point only ever rounds the gain down. */
+        uint32_t gain = (uint32_t)(release * LIMITER_ONE);
+        uint32_t slot = pos & LIMITER_MASK;
+        sum += gain - l->gains[slot];
+        l->gains[slot] = gain;
+        float g = (float)sum * (1.0f / (LIMITER_ONE * LIMITER_AHEAD));
+        least = g < least ? g : least;
+
+        /* The slot after this one's is the oldest in the line, written
+         * LIMITER_LATENCY samples ago. */
+        l->line[0][slot] = xl;
+        l->line[1][slot] = xr;
+        uint32_t out = (pos + 1) & LIMITER_MASK;
+        left[i] = l->line[0][out] * g;
+        right[i] = l->line[1][out] * g;
+
+        pos++;
+    }
+
+    l->pos = pos;
+    l->head = head;
+    l->count = count;
+    l->release = release;
+    l->sum = sum;
+    l->least = least;
+}
+
+float limiter_reduction(struct limiter *l)
+{
+    float least = l->least;
+    l->least = 1.0f;
+    return least;
+}
@@ -0,0 +1,70 @@
+#ifndef SXLHLG_LIMITER_H
+#define SXLHLG_LIMITER_H
+
+#include <stdint.h>
+
+/* A look-ahead peak limiter on the master bus, the last thing before the mix
+ * is quantized.  Enough loud voices at once will add up past what the PWM can
+ * play - which isn't even the whole of SAMPLE_LOW..SAMPLE_HIGH, as the PWM's
+ * period is only AUDIO_PWM_RANGE ticks - and clipping them there is harsh.
+ * Instead the limiter turns the mix down just enough to fit, smoothly.
+ *
+ * To do that without clipping the front of a peak, the mix is delayed by
+ * LIMITER_LATENCY samples, so the gain can start coming down before the peak
+ * gets to it:
+ *
+ * - The gain each sample needs is worked out from the loudest sample in the
+ *   last LIMITER_AHEAD, everything still in the delay line.  That maximum is
+ *   kept in a monotonic queue - each new sample knocks out the quieter ones
+ *   queued before it, as they can never be the loudest again - so it's at the
+ *   front, with no scan of the window.  Every sample is queued and knocked out
+ *   at most once, so a block costs at most its length plus LIMITER_AHEAD of
+ *   those steps, however the samples fall.
+ *
+ * - That gain is let back up slowly, by a release, and then averaged over the
+ *   last LIMITER_AHEAD samples, which fades it in over the whole look-ahead.
+ *   The average is of fixed-point gains, so its running sum is exact and can't
+ *   drift.  A peak's gain is in every one of the samples averaged when the
+ *   peak comes out of the delay line, so it's always turned down at least
+ *   enough: the limiter never overshoots.
+ *
+ * The latency is the same whether it's doing anything or not, so it's always
+ * on.  The two channels share the gain, so that the stereo image stays put. */
+#define LIMITER_AHEAD 64
+#define LIMITER_MASK (LIMITER_AHEAD - 1)
+#define LIMITER_LATENCY (LIMITER_AHEAD - 1)
+
+#if LIMITER_AHEAD & LIMITER_MASK
+#error "LIMITER_AHEAD must be a power of two"
+#endif
+
+struct limiter {
+    float line[2][LIMITER_AHEAD];
+    uint32_t pos;       /* samples so far, where the next one is written */
+
+    /* The queue of candidates for the loudest sample in the window, from the
+     * loudest (and oldest) at @head, and when each was written. */
+    float peak[LIMITER_AHEAD];
+    uint32_t when[LIMITER_AHEAD];
+    uint32_t head;
+    uint32_t count;
+
+    float release;      /* the gain before averaging */
+    uint32_t gains[LIMITER_AHEAD];  /* and its last few, fixed point */
+    uint32_t sum;
+
+    /* The least gain applied since the last limiter_reduction(). */
+    float least;
+};
+
+void limiter_init(struct limiter *l);
+
+/* Run @len samples of the mix in @left and @right through @l, in place.  A
+ * mono mix can be passed as both. */
+void limiter_process(struct limiter *l, float *left, float *right, int len);
+
+/* How far @l has had to turn the mix down since this was last asked, in
+ * [0, 1]: 1 is not at all. */
+float limiter_reduction(struct limiter *l);
+
+#endif
@@ -18,6 +18,8 @@ void midisrc(void)
         int ev = AwaitEvent(MIDIPKT_EVENTID);
         struct usbmidipkt *pkt = (struct usbmidipkt *)ev;
 
+        /* The packet carries the time it arrived on the USB core along with
+         * it. */
         req.hdr.type = DELIVER_MIDI;
         memcpy(&req.pkt, pkt, USBMIDIPKT_SIZE(pkt));
 
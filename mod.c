@@ -0,0 +1,17 @@
+#include "mod.h"
+
+void mod_build(struct modmatrix *m, const struct modroute *routes, int count)
+{
+    m->count = 0;
+    for (int i = 0; i < count && m->count < MOD_ROUTES; i++) {
+        const struct modroute *r = &routes[i];
+        if (r->amount == 0.0f
+            || r->source >= MOD_SOURCES
+            || r->via >= MOD_SOURCES
+            || r->dest >= MOD_DESTS) {
+            continue;
+        }
+
+        m->route[m->count++] = *r;
+    }
+}
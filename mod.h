@@ -0,0 +1,73 @@
+#ifndef SXLHLG_MOD_H
+#define SXLHLG_MOD_H
+
+#include <stdint.h>
+
+/* The modulation matrix: a list of routes, each of which adds a source's value
+ * (optionally scaled by a second 'via' source, so that e.g. the mod wheel can
+ * fade vibrato in) times an amount onto a destination.
+ *
+ * Everything here runs at control rate.  Once per control sub-block the synth
+ * gathers the value of every source for each sounding voice, runs through the
+ * routes to total up each destination, and applies the totals the same way it
+ * applies the envelopes: the amplitude is ramped sample by sample towards its
+ * new value, and the rest are stepped.  So the per-sample cost of the matrix
+ * is nil, however many routes there are. */
+
+enum mod_source {
+    MOD_ONE,            /* always 1, for routes with no via */
+    MOD_LFO1,           /* [-1, 1] */
+    MOD_LFO2,
+    MOD_ENV,            /* the voice's amplitude envelope, [0, 1] */
+    MOD_VELOCITY,       /* [0, 1] */
+    MOD_WHEEL,          /* [0, 1] */
+    MOD_AFTERTOUCH,     /* channel pressure, [0, 1] */
+    MOD_SOURCES
+};
+
+/* The units of each destination are what a route's amount is given in. */
+enum mod_dest {
+    MOD_PITCH,          /* semitones */
+    MOD_CUTOFF,         /* semitones */
+    MOD_AMP,            /* fraction of the level, added to 1 */
+    MOD_WIDTH,          /* fraction of a cycle, added to the pulse width */
+    MOD_DESTS
+};
+
+#define MOD_ROUTES 16
+
+struct modroute {
+    uint8_t source;
+    uint8_t via;
+    uint8_t dest;
+    float amount;
+};
+
+/* The routes that actually do something, packed together in one flat array
+ * so that evaluating them is a single pass over a few cache lines. */
+struct modmatrix {
+    int count;
+    struct modroute route[MOD_ROUTES];
+};
+
+/* Build @m from the @count routes at @routes, leaving out the ones with no
+ * amount or that name a source or destination we don't have. */
+void mod_build(struct modmatrix *m, const struct modroute *routes, int count);
+
+/* Total up each of the destinations in @dst given the values of the sources in
+ * @src. */
+static inline void mod_eval(const struct modmatrix *m,
+                            const float src[MOD_SOURCES],
+                            float dst[MOD_DESTS])
+{
+    for (int d = 0; d < MOD_DESTS; d++) {
+        dst[d] = 0.0f;
+    }
+
+    for (int i = 0; i < m->count; i++) {
+        const struct modroute *r = &m->route[i];
+        dst[r->dest] += src[r->source] * src[r->via] * r->amount;
+    }
+}
+
+#endif
@@ -0,0 +1,29 @@
+#include <stdint.h>
+
+#include "osc.h"
+
+void osc_square(struct osc *o, float *out, int len)
+{
+    uint32_t phase = o->phase;
+    uint32_t inc = o->inc;
+
+    /* The top bit of the phase tells us which half of the cycle we're in, so
+     * rather than comparing against the midpoint we copy it straight into the
+     * sign bit of the output. */
+    union {
+        float f;
+        uint32_t u;
+    } high = { .f = 1.0f };
+
+    for (int i = 0; i < len; i++) {
+        union {
+            float f;
+            uint32_t u;
+        } sample = { .u = high.u ^ (phase & 0x80000000) };
+
+        out[i] = sample.f;
+        phase += inc;
+    }
+
+    o->phase = phase;
+}
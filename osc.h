@@ -0,0 +1,24 @@
+#ifndef SXLHLG_OSC_H
+#define SXLHLG_OSC_H
+
+#include <stdint.h>
+
+/* A phase-accumulator oscillator.  The phase is a 0.32 fixed-point fraction of
+ * a cycle, so it wraps around for free when it overflows and no sample ever
+ * needs a modulo. */
+struct osc {
+    uint32_t phase;
+    uint32_t inc;
+};
+
+static inline void osc_start(struct osc *o, uint32_t inc)
+{
+    o->phase = 0;
+    o->inc = inc;
+}
+
+/* Write @len samples of a naive (aliasing) unit-amplitude square wave to
+ * @out. */
+void osc_square(struct osc *o, float *out, int len);
+
+#endif
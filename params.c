@@ -0,0 +1,72 @@
+#include "params.h"
+
+const struct paramdesc param_descs[PARAMS] = {
+    [PARAM_CUTOFF] = { 0.0f, 135.0f, false },       /* note */
+    [PARAM_RESONANCE] = { 0.0f, 1.0f, false },
+    [PARAM_KEYTRACK] = { 0.0f, 1.0f, false },
+    [PARAM_WIDTH] = { 0.02f, 0.98f, false },        /* of a cycle */
+    [PARAM_MORPH] = { 0.0f, 3.0f, false },
+    [PARAM_FEEDBACK] = { 0.0f, 1.0f, false },
+    [PARAM_OP1_LEVEL] = { 0.0f, 1.0f, false },
+    [PARAM_OP2_LEVEL] = { 0.0f, 1.0f, false },
+    [PARAM_OP3_LEVEL] = { 0.0f, 1.0f, false },
+    [PARAM_OP4_LEVEL] = { 0.0f, 1.0f, false },
+    [PARAM_ATTACK] = { 0.0f, 5000.0f, true },       /* ms */
+    [PARAM_DECAY] = { 0.0f, 5000.0f, true },
+    [PARAM_SUSTAIN] = { 0.0f, 100.0f, false },      /* percent */
+    [PARAM_RELEASE] = { 0.0f, 5000.0f, true },
+    [PARAM_LFO1_RATE] = { 0.05f, 20.0f, true },     /* Hz */
+    [PARAM_LFO2_RATE] = { 0.05f, 20.0f, true },
+    [PARAM_VOLUME] = { 0.0f, 1.0f, false },
+    [PARAM_REVERB] = { 0.0f, 1.0f, false },
+    [PARAM_CHORUS] = { 0.0f, 1.0f, false },
+    [PARAM_DETUNE] = { 0.0f, 1.0f, false },         /* semitones */
+    [PARAM_SPREAD] = { 0.0f, 1.0f, false },
+    [PARAM_DRIVE] = { 0.0f, 16.0f, true }
+};
+
+void params_init(struct params *p)
+{
+    for (int cc = 0; cc < PARAM_CCS; cc++) {
+        p->map[cc] = PARAM_NONE;
+    }
+
+    /* The General MIDI sound controllers where there's one that fits, and
+     * the general-purpose ones for the rest. */
+    p->map[7] = PARAM_VOLUME;
+    p->map[16] = PARAM_OP1_LEVEL;
+    p->map[17] = PARAM_OP2_LEVEL;
+    p->map[18] = PARAM_OP3_LEVEL;
+    p->map[19] = PARAM_OP4_LEVEL;
+    p->map[70] = PARAM_WIDTH;
+    p->map[71] = PARAM_RESONANCE;
+    p->map[72] = PARAM_RELEASE;
+    p->map[73] = PARAM_ATTACK;
+    p->map[74] = PARAM_CUTOFF;
+    p->map[75] = PARAM_DECAY;
+    p->map[76] = PARAM_LFO1_RATE;
+    p->map[77] = PARAM_LFO2_RATE;
+    p->map[78] = PARAM_KEYTRACK;
+    p->map[79] = PARAM_SUSTAIN;
+    p->map[80] = PARAM_MORPH;
+    p->map[81] = PARAM_FEEDBACK;
+    p->map[82] = PARAM_SPREAD;
+    p->map[83] = PARAM_DRIVE;
+    p->map[91] = PARAM_REVERB;
+    p->map[93] = PARAM_CHORUS;
+    p->map[94] = PARAM_DETUNE;
+
+    p->moving = 0;
+    for (int i = 0; i < PARAMS; i++) {
+        p->value[i] = 0.0f;
+        p->target[i] = 0.0f;
+    }
+}
+
+float params_scale(int param, int value)
+{
+    const struct paramdesc *d = &param_descs[param];
+    float x = value / 127.0f;
+    x = d->cubic ? x * x * x : x;
+    return d->min + (d->max - d->min) * x;
+}
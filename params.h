@@ -0,0 +1,86 @@
+#ifndef SXLHLG_PARAMS_H
+#define SXLHLG_PARAMS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* The patch settings that MIDI controllers can turn.  A control change doesn't
+ * set its parameter directly: it sets a target, and the synth glides the
+ * parameter towards it once per control sub-block, so that the coarse steps of
+ * a 7-bit controller (and the gaps between the messages of a knob being
+ * turned) don't zipper.  Nothing is ever recomputed per sample; parameters
+ * that feed the per-sample ramps, like the volume and operator levels, get the
+ * ramps' interpolation on top. */
+enum param {
+    PARAM_CUTOFF,
+    PARAM_RESONANCE,
+    PARAM_KEYTRACK,
+    PARAM_WIDTH,
+    PARAM_MORPH,
+    PARAM_FEEDBACK,
+    PARAM_OP1_LEVEL,
+    PARAM_OP2_LEVEL,
+    PARAM_OP3_LEVEL,
+    PARAM_OP4_LEVEL,
+    PARAM_ATTACK,
+    PARAM_DECAY,
+    PARAM_SUSTAIN,
+    PARAM_RELEASE,
+    PARAM_LFO1_RATE,
+    PARAM_LFO2_RATE,
+    PARAM_VOLUME,
+    PARAM_REVERB,
+    PARAM_CHORUS,
+    PARAM_DETUNE,
+    PARAM_SPREAD,
+    PARAM_DRIVE,
+    PARAMS
+};
+
+/* How a controller's 0-127 maps onto a parameter.  Times and rates use a
+ * cubic curve so that the short end, where the ear is most sensitive, gets
+ * most of the travel. */
+struct paramdesc {
+    float min, max;
+    bool cubic;
+};
+
+extern const struct paramdesc param_descs[PARAMS];
+
+#define PARAM_NONE 0xff
+#define PARAM_CCS 128
+
+/* Parameters glide this fraction of the way to their targets each control
+ * sub-block, a time constant of about 7ms. */
+#define PARAM_SMOOTHING 0.05f
+
+struct params {
+    uint8_t map[PARAM_CCS];     /* the parameter each CC turns, if any */
+    uint32_t moving;            /* bit n set while parameter n is gliding */
+    float value[PARAMS];
+    float target[PARAMS];
+};
+
+/* Set up the default controller assignments, with nothing moving. */
+void params_init(struct params *p);
+
+/* The value of @param that controller value @value asks for. */
+float params_scale(int param, int value);
+
+/* Glide @param one sub-block on towards its target, landing on it exactly once
+ * it's close enough, and return its new value. */
+static inline float params_step(struct params *p, int param)
+{
+    const struct paramdesc *d = &param_descs[param];
+    float diff = p->target[param] - p->value[param];
+    float close = (d->max - d->min) * (1.0f / 4096);
+    if (diff < close && diff > -close) {
+        p->value[param] = p->target[param];
+        p->moving &= ~(1u << param);
+    } else {
+        p->value[param] += diff * PARAM_SMOOTHING;
+    }
+    return p->value[param];
+}
+
+#endif
@@ -0,0 +1,146 @@
+#include <stdint.h>
+
+#include "audio.h"
+#include "fxline.h"
+#include "kernels.h"
+#include "reverb.h"
+
+/* The line lengths at a size of 1, 25-52ms: primes, so that no two lines'
+ * echoes keep landing on top of each other.  The first four, which are all a
+ * 4-line network uses, are spread across the whole range. */
+static const uint16_t reverb_lengths[REVERB_LINES] = {
+    1087, 1789, 1447, 2137, 1283, 1951, 1597, 2311
+};
+
+#define REVERB_MIN_SIZE 0.5f
+#define REVERB_MAX_SIZE 2.0f
+
+/* Short enough that the loops never ring on, long enough not to be silly. */
+#define REVERB_MIN_DECAY 0.1f
+#define REVERB_MAX_DECAY 20.0f
+
+void reverb_init(struct reverb *r, float *mem)
+{
+    for (int i = 0; i < REVERB_LINES; i++) {
+        r->line[i] = mem + i * REVERB_LEN;
+        r->len[i] = reverb_lengths[i];
+    }
+    for (int i = 0; i < REVERB_LINES * REVERB_LEN; i++) {
+        mem[i] = 0.0f;
+    }
+    r->pos = 0;
+
+    r->fdn.lines = 0;
+    r->fdn.order = 0;
+    for (int i = 0; i < REVERB_LINES; i++) {
+        r->fdn.gain[i] = 0.0f;
+        for (int o = 0; o < REVERB_MAX_ORDER; o++) {
+            r->fdn.lp[o][i] = 0.0f;
+        }
+    }
+    r->fdn.damp = 1.0f;
+    r->fdn.out = 0.0f;
+
+    /* Nothing matches these, so the first block works everything out. */
+    r->size = 0.0f;
+    r->decay = 0.0f;
+}
+
+/* 2^@x for @x <= 0: a Taylor series for the fractional part and the exponent
+ * bits for the rest.  Good to a few parts in a million, which is far closer
+ * than anyone could hear in a decay time. */
+static float exp2_neg(float x)
+{
+    if (x < -126.0f) {
+        return 0.0f;
+    }
+
+    int whole = (int)x;
+    float y = (x - whole) * 0.693147181f;
+    float frac = 1.0f + y * (1.0f + y * (0.5f + y * (1.0f / 6 + y
+                 * (1.0f / 24 + y * (1.0f / 120 + y * (1.0f / 720
+                 + y * (1.0f / 5040)))))));
+
+    union {
+        uint32_t bits;
+        float f;
+    } scale = { .bits = (uint32_t)(127 + whole) << 23 };
+    return frac * scale.f;
+}
+
+/* Work out the line lengths and feedback gains, which involves a division and
+ * an exp2 per line, only when the settings they come from have changed. */
+static void reverb_configure(struct reverb *r, const struct reverbpatch *p)
+{
+    int lines = p->lines == REVERB_LINES ? REVERB_LINES : 4;
+    float size = fx_clamp(p->size, REVERB_MIN_SIZE, REVERB_MAX_SIZE);
+    float decay = fx_clamp(p->decay, REVERB_MIN_DECAY, REVERB_MAX_DECAY);
+
+    if (size != r->size || decay != r->decay || lines != r->fdn.lines) {
+        /* The Hadamard matrix is only orthogonal once it's scaled by
+         * 1 / sqrt(lines). */
+        float scale = lines == REVERB_LINES ? 0.353553391f : 0.5f;
+
+        /* A pass around line i takes len[i] samples and should lose
+         * 60dB * len[i] / (decay * fs) of level, i.e. be scaled by
+         * 2^(-log2(1000) * len[i] / (decay * fs)). */
+        float per_sample = -9.96578428f / (decay * AUDIO_SAMPLE_RATE);
+        for (int i = 0; i < REVERB_LINES; i++) {
+            r->len[i] = (uint32_t)(reverb_lengths[i] * size);
+            r->fdn.gain[i] = i < lines
+                             ? exp2_neg(per_sample * r->len[i]) * scale
+                             : 0.0f;
+        }
+
+        r->size = size;
+        r->decay = decay;
+        r->fdn.lines = lines;
+    }
+
+    r->fdn.order = p->order < 0 ? 0 : p->order;
+    r->fdn.order = r->fdn.order > REVERB_MAX_ORDER
+                   ? REVERB_MAX_ORDER
+                   : r->fdn.order;
+    r->fdn.damp = 1.0f - fx_clamp(p->damping, 0.0f, 0.95f);
+
+    /* Each output is the sum of half the lines. */
+    r->fdn.out = p->wet * 2.0f / lines;
+}
+
+void reverb_process(struct reverb *r,
+                    const struct kernels *k,
+                    const struct reverbpatch *p,
+                    float *left,
+                    float *right,
+                    int len)
+{
+    reverb_configure(r, p);
+    int lines = r->fdn.lines;
+
+    /* The lines' outputs for a chunk are gathered into the taps, sample by
+     * sample, for the kernel to run the network over; what it leaves there is
+     * scattered back into the lines' inputs. */
+    float taps[REVERB_CHUNK * REVERB_LINES] __aligned(16);
+    for (int done = 0; done < len; done += REVERB_CHUNK) {
+        int n = len - done < REVERB_CHUNK ? len - done : REVERB_CHUNK;
+
+        for (int i = 0; i < lines; i++) {
+            const float *line = r->line[i];
+            uint32_t from = r->pos - r->len[i];
+            for (int t = 0; t < n; t++) {
+                taps[t * REVERB_LINES + i] = line[(from + t) & REVERB_MASK];
+            }
+        }
+
+        k->fdn(&r->fdn, taps, &left[done], &right[done], n);
+
+        for (int i = 0; i < lines; i++) {
+            float *line = r->line[i];
+            for (int t = 0; t < n; t++) {
+                line[(r->pos + t) & REVERB_MASK] = taps[t * REVERB_LINES + i];
+            }
+        }
+
+        r->pos += n;
+    }
+}
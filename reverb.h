@@ -0,0 +1,85 @@
+#ifndef SXLHLG_REVERB_H
+#define SXLHLG_REVERB_H
+
+#include <stdint.h>
+
+#include <caboose/config.h>
+#include <caboose/util.h>
+
+/* A feedback delay network reverb on the master output: REVERB_LINES delay
+ * lines of different lengths whose outputs are damped, mixed together by
+ * a Hadamard matrix (scaled to be orthogonal, so it neither adds nor loses
+ * energy) and fed back into their inputs along with the dry signal.  Each
+ * line's feedback gain is set from its length so that every path dies away at
+ * the same rate.
+ *
+ * The lines are CONFIG_SYNTH_REVERB_LEN samples each, a power of two, and live
+ * in the memory the platform sets aside at startup (see
+ * caboose-platform/fxmem.h), after the delay's.
+ *
+ * Quality against cost: the network can run on 4 or 8 lines, and the
+ * damping in each line's loop can be off or a 1st- or 2nd-order lowpass.  Eight
+ * lines build up echo density twice as fast, and the steeper damping gives
+ * a darker, more natural tail. */
+#define REVERB_LINES 8
+#define REVERB_LEN CONFIG_SYNTH_REVERB_LEN
+#define REVERB_MASK (REVERB_LEN - 1)
+
+#if REVERB_LEN & REVERB_MASK
+#error "CONFIG_SYNTH_REVERB_LEN must be a power of two"
+#endif
+
+/* The network runs over the taps of this many samples at a time.  Since every
+ * line is longer than this, nothing read in a chunk can have been written in
+ * the same chunk. */
+#define REVERB_CHUNK 32
+
+#define REVERB_MAX_ORDER 2
+
+struct reverbpatch {
+    float wet;          /* [0, 1]; 0 is off */
+    float size;         /* scales the line lengths, [0.5, 2] */
+    float decay;        /* the time to die away by 60dB, in seconds */
+    float damping;      /* [0, 1) */
+    int lines;          /* 4 or REVERB_LINES */
+    int order;          /* of the damping filters, 0 to REVERB_MAX_ORDER */
+};
+
+/* The part of the reverb the kernels see: the network's coefficients and its
+ * filter states, one lane per line. */
+struct fdn {
+    int lines;
+    int order;
+    float gain[REVERB_LINES];   /* feedback, with the matrix's scaling */
+    float lp[REVERB_MAX_ORDER][REVERB_LINES];
+    float damp;                 /* the lowpasses' coefficient */
+    float out;                  /* the level of the reverb in the output */
+} __aligned(16);
+
+struct kernels;
+
+struct reverb {
+    struct fdn fdn;
+    float *line[REVERB_LINES];
+    uint32_t len[REVERB_LINES];
+    uint32_t pos;
+
+    /* The settings the lengths and gains were last worked out for. */
+    float size;
+    float decay;
+};
+
+/* Set up @r to use the REVERB_LINES * REVERB_LEN floats at @mem, and clear
+ * them. */
+void reverb_init(struct reverb *r, float *mem);
+
+/* Add @len samples of reverb on @left and @right into them, with settings @p,
+ * using kernels @k. */
+void reverb_process(struct reverb *r,
+                    const struct kernels *k,
+                    const struct reverbpatch *p,
+                    float *left,
+                    float *right,
+                    int len);
+
+#endif
@@ -0,0 +1,124 @@
+#include "sampler.h"
+#include "tuning.h"
+
+void sampler_start(struct voicebank *vb,
+                   int v,
+                   const int16_t *data,
+                   uint32_t frames,
+                   uint32_t loop_start,
+                   uint32_t loop_end)
+{
+    vb->smp_pos[v] = 0;
+    vb->smp_frac[v] = 0;
+    vb->smp_data[v] = data;
+    vb->smp_frames[v] = frames;
+
+    /* A one-shot stops far enough past the end that everything it reads is
+     * silence, and never goes back.  A loop goes back late enough that none
+     * of what it reads afterwards is from before the loop (see sinc.h). */
+    vb->smp_end[v] = loop_end ? loop_end + SAMPLER_REACH - 1
+                              : frames + SAMPLER_REACH;
+    vb->smp_loop[v] = loop_end ? loop_end - loop_start : 0;
+}
+
+void sampler_tune(struct voicebank *vb, int v, int root, uint32_t inc)
+{
+    root = root < 0 ? 0 : root;
+    root = root > TUNING_NOTES - 1 ? TUNING_NOTES - 1 : root;
+
+    /* The ratio of the two increments is the rate, and an increment fits in
+     * 32 bits, so shifting it up first leaves a 32.32 quotient. */
+    uint64_t rate = ((uint64_t)inc << 32) / tuning_words[root];
+    vb->smp_step[v] = rate >> 32;
+    vb->smp_step_frac[v] = (uint32_t)rate;
+}
+
+bool sampler_playable(const struct bankzone *z, int note)
+{
+    int root = z->root < TUNING_NOTES ? z->root : TUNING_NOTES - 1;
+    note = note < 0 ? 0 : note;
+    note = note > TUNING_NOTES - 1 ? TUNING_NOTES - 1 : note;
+    return z->codec == BANK_PCM16
+           || tuning_words[note]
+              < (uint64_t)SAMPLER_STEP_MAX * tuning_words[root];
+}
+
+void sampler_play(struct samplerbank *sb,
+                  struct voicebank *vb,
+                  int v,
+                  const struct bank *b,
+                  const struct bankzone *z)
+{
+    struct samplervoice *sv = &sb->voice[v];
+    sv->streaming = z && z->codec != BANK_PCM16;
+    if (!z) {
+        sampler_start(vb, v, NULL, 0, 0, 0);
+    } else if (!sv->streaming) {
+        sampler_start(vb,
+                      v,
+                      bank_data(b, z, 0),
+                      z->frames,
+                      z->loop_start,
+                      z->loop_end);
+    } else {
+        samplestream_start(&sv->stream, b, z, 0);
+        sv->ended = false;
+        sv->valid = 0;
+        sampler_start(vb, v, sv->window, 0, 0, 0);
+    }
+}
+
+void sampler_fill(struct samplerbank *sb,
+                  struct voicebank *vb,
+                  int group,
+                  int len)
+{
+    for (int lane = 0; lane < VOICE_LANES; lane++) {
+        int v = group * VOICE_LANES + lane;
+        struct samplervoice *sv = &sb->voice[v];
+        if (!sv->streaming || !vb->gate[v]) {
+            continue;
+        }
+
+        /* Everything before the voice but the SAMPLER_REACH - 1 frames the
+         * interpolation reads behind it is done with. */
+        uint32_t pos = vb->smp_pos[v];
+        uint32_t drop = pos > SAMPLER_REACH - 1 ? pos - (SAMPLER_REACH - 1) : 0;
+        drop = drop < sv->valid ? drop : sv->valid;
+        for (uint32_t i = drop; i < sv->valid; i++) {
+            sv->window[i - drop] = sv->window[i];
+        }
+        sv->valid -= drop;
+        pos -= drop;
+        vb->smp_pos[v] = pos;
+
+        /* Any faster and it would run out of window, so it's held to the
+         * fastest it can go (see SAMPLER_STEP_MAX). */
+        if (vb->smp_step[v] >= SAMPLER_STEP_MAX) {
+            vb->smp_step[v] = SAMPLER_STEP_MAX;
+            vb->smp_step_frac[v] = 0;
+        }
+
+        /* The furthest it'll read is SAMPLER_REACH past where it'll be by
+         * the end of the block.  (A longer block than SAMPLER_BLOCK would
+         * run out of window, and read silence.) */
+        uint64_t step = (uint64_t)vb->smp_step[v] << 32 | vb->smp_step_frac[v];
+        uint32_t need = pos
+                        + (uint32_t)((vb->smp_frac[v] + step * len) >> 32)
+                        + SAMPLER_REACH + 1;
+        need = need < SAMPLER_WINDOW ? need : SAMPLER_WINDOW;
+        if (!sv->ended && need > sv->valid) {
+            uint32_t want = need - sv->valid;
+            uint32_t got = samplestream_read(&sv->stream,
+                                             &sv->window[sv->valid],
+                                             want);
+            sv->valid += got;
+            sv->ended = got < want;
+        }
+
+        /* Once it's all been decoded, the voice stops where it would have
+         * in the whole sample. */
+        vb->smp_frames[v] = sv->valid;
+        vb->smp_end[v] = sv->ended ? sv->valid + SAMPLER_REACH : UINT32_MAX;
+    }
+}
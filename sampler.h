@@ -0,0 +1,141 @@
+#ifndef SXLHLG_SAMPLER_H
+#define SXLHLG_SAMPLER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "bank.h"
+#include "samplestream.h"
+#include "sinc.h"
+#include "voicebank.h"
+
+/* Sampler voices: each note plays a recording from the top, faster or slower
+ * than it was recorded by the ratio of the note's frequency to the root key's,
+ * so that it tracks the keyboard (and the pitch modulation) like any other
+ * waveform.  The voice's ADSR and everything else are applied on top.
+ *
+ * A voice's place in the sample is 32.32 fixed point, in frames: a whole
+ * frame in smp_pos and the fraction in smp_frac, and the same for how far it
+ * moves each sample.  That's exact for any length of sample that fits in
+ * memory, and a fraction fine enough that the pitch is as good as the
+ * tuning's.  Playing between frames means interpolating, and patches can pick
+ * how well - and how expensively - that's done:
+ *
+ * SAMPLER_LINEAR draws a straight line between the two frames either side,
+ * which dulls the top end and lets through images of it too.
+ *
+ * SAMPLER_HERMITE fits a cubic through the four frames around the position,
+ * just as the wavetables' cubic interpolation does.
+ *
+ * SAMPLER_SINC convolves the eight around it with a windowed sinc (see
+ * sinc.h).  It's at the sample's own Nyquist, so it only interpolates: a
+ * sample played back a long way above its root will alias, whichever
+ * interpolator it's played with.
+ *
+ * Past either end of the sample there's silence, and a voice stops where
+ * it's read the last of it - unless the sample loops, in which case it goes
+ * back by the length of the loop whenever it gets to the end of it.  (That's
+ * once a sample at most, so a loop shorter than a voice moves in a sample
+ * sticks at its end.)
+ *
+ * A sample that's stored compressed can't be read where it is, so a voice
+ * playing one decodes it into a window of its own as it goes (see
+ * samplestream.h): before every block, whatever it's left behind is dropped
+ * off the front of the window, and as much as it'll read by the end of the
+ * block is decoded onto the back.  The kernels can't tell the difference -
+ * to them the window's just a short sample, with the voice's position in it -
+ * except that a loop's decoded round and round rather than wrapped.  What
+ * the window does limit is how fast the voice can go: SAMPLER_STEP_MAX frames
+ * a sample, over three and a half octaves above the root, where it would be
+ * aliasing badly anyway.  A note that would start out faster than that isn't
+ * played at all (see sampler_playable()), but one that's bent or modulated
+ * up past it once it's started is held to it, and so plays flat. */
+#define SAMPLER_WINDOW 512
+#define SAMPLER_BLOCK 32    /* the most samples rendered between fills */
+#define SAMPLER_STEP_MAX \
+    ((SAMPLER_WINDOW - 2 * SAMPLER_REACH) / SAMPLER_BLOCK - 1)
+
+enum sampler_interp {
+    SAMPLER_LINEAR,
+    SAMPLER_HERMITE,
+    SAMPLER_SINC,
+    SAMPLER_INTERPS
+};
+
+/* How to play the sample voices: each note plays whichever zone of @bank
+ * covers it (see bank.h).  Voices are mono, so a stereo zone plays its first
+ * channel. */
+struct samplerpatch {
+    const struct bank *bank;
+    enum sampler_interp interp;
+};
+
+/* Each voice's window, and what it's decoding into it. */
+struct samplervoice {
+    struct samplestream stream;
+    bool streaming;     /* or reading the bank where it is */
+    bool ended;         /* a one-shot that's been decoded to the end */
+    uint32_t valid;     /* how many frames there are in the window */
+    int16_t window[SAMPLER_WINDOW];
+};
+
+struct samplerbank {
+    struct samplervoice voice[SYNTH_VOICE_COUNT];
+};
+
+/* Whether @z can play @note: a compressed zone can't be played back more
+ * than SAMPLER_STEP_MAX times as fast as it was recorded. */
+bool sampler_playable(const struct bankzone *z, int note);
+
+/* Start voice @v on the first channel of zone @z of @b, or on silence if @z
+ * is NULL.  An uncompressed zone is read where it is, with sampler_start(),
+ * and a compressed one's streamed into the voice's window. */
+void sampler_play(struct samplerbank *sb,
+                  struct voicebank *vb,
+                  int v,
+                  const struct bank *b,
+                  const struct bankzone *z);
+
+/* Decode as much as each streaming voice of @group will read in the next
+ * @len samples, up to SAMPLER_BLOCK, into its window.  This has to be done
+ * before every block rendered for them.  Voices that are gated off are left
+ * alone. */
+void sampler_fill(struct samplerbank *sb,
+                  struct voicebank *vb,
+                  int group,
+                  int len);
+
+/* Start voice @v of @vb from the top of the @frames frames of @data, with
+ * @loop_end 0 for a one-shot.  A looped sample has to go on for
+ * SAMPLER_GUARD frames past @loop_end with the start of the loop, and
+ * @frames includes those, which is how tools/mkbank.c packs them.  A NULL
+ * @data and no @frames play silence. */
+void sampler_start(struct voicebank *vb,
+                   int v,
+                   const int16_t *data,
+                   uint32_t frames,
+                   uint32_t loop_start,
+                   uint32_t loop_end);
+
+/* Set voice @v of @vb moving through its sample at the rate that plays it at
+ * increment @inc, given that it plays at its own pitch on key @root.  This
+ * costs a 64-bit division, so it's only done when the pitch has moved. */
+void sampler_tune(struct voicebank *vb, int v, int root, uint32_t inc);
+
+/* Frame @at of @frames of @data, or silence if that's off either end of them
+ * (a position before the start having wrapped around to a huge one). */
+static inline float sampler_frame(const int16_t *data,
+                                  uint32_t frames,
+                                  uint32_t at)
+{
+    return at < frames ? data[at] * (1.0f / 32768.0f) : 0.0f;
+}
+
+/* The fraction of a frame @frac, as a float in [0, 1).  Its top 24 bits are
+ * all that's kept, so that the conversion is exact. */
+static inline float sampler_fraction(uint32_t frac)
+{
+    return (frac >> 8) * (1.0f / 16777216.0f);
+}
+
+#endif
@@ -1,34 +1,37 @@
-#include <limits.h>
 #include <stdint.h>
 
 #include <caboose/caboose.h>
 #include <caboose/platform.h>
 #include <caboose/util.h>
 
-#include <caboose-platform/debug.h>
-
 #include "audio.h"
-
-/* This is probably undefined behaviour.  Meh. */
-extern int16_t sample_bin[];
-extern unsigned int sample_bin_len;
-
-uint32_t resampled[500000];
+#include "bank.h"
+#include "kernels.h"
+#include "samplestream.h"
 
 void samplesrc(void)
 {
-    /* Our sample is raw signed 16-bit little-endian 44100Hz, while we need to
-     * produce unsigned 12-bit little-endian 44100Hz (in 32-bit words), so we
-     * need to do some resampling. */
-    debug_printf("Starting to resample...");
-    for (int i = 0; i < sample_bin_len / 2; i++) {
-        resampled[i] = (uint32_t)(sample_bin[i] + (-SHRT_MIN)) >> 4;
-    }
-    debug_printf("Finished resampling!");
-
     RegisterAs(AUDIO_SOURCE);
 
-    size_t i = 0;
+    /* This plays instead of the synth, never alongside it, so it's the one
+     * task using the VFP (and NEON) registers. */
+    const struct kernels *k = kernels_select();
+
+    /* It plays the first zone of the bank, whatever it's mapped to.  A
+     * 16-bit zone is widened straight out of the bank, going round its loop
+     * or back to the start at the end; a compressed one is read through
+     * streams, which decode it a block at a time into scratch first. */
+    const struct bank *b = &bank_default;
+    ASSERT(bank_valid(b) && b->zones > 0);
+    const struct bankzone *z = &b->zone[0];
+    const int16_t *pcm[2] = { bank_data(b, z, 0), bank_data(b, z, 1) };
+    uint32_t stop = z->loop_end ? z->loop_end : z->frames;
+    uint32_t restart = z->loop_end ? z->loop_start : 0;
+    uint32_t at = 0;
+    struct samplestream left, right;
+    samplestream_start(&left, b, z, 0);
+    samplestream_start(&right, b, z, 1);
+
     while (true) {
         tid_t sender;
         struct audioreq req;
@@ -37,11 +40,30 @@ void samplesrc(void)
         ASSERT(req.hdr.type == GET_AUDIO);
 
         uint32_t out[req.len * 2];
-        memcpy(out, &resampled[i], req.len * 2 * sizeof resampled[0]);
-        i += req.len * 2;
-
-        if (i + req.len * 2 > sample_bin_len / 2) {
-            i = 0;
+        int16_t l[req.len], r[req.len];
+        for (unsigned int j = 0; j < req.len;) {
+            unsigned int n = req.len - j;
+            if (!z->frames) {
+                /* There's nothing to go round, so it's silence rather than
+                 * going back to the start forever. */
+                for (unsigned int i = j; i < req.len; i++) {
+                    l[i] = r[i] = 0;
+                }
+                k->pcm16(&out[j * 2], &l[j], &r[j], n);
+            } else if (z->codec == BANK_PCM16) {
+                n = n < stop - at ? n : stop - at;
+                k->pcm16(&out[j * 2], &pcm[0][at], &pcm[1][at], n);
+                at = at + n < stop ? at + n : restart;
+            } else {
+                n = samplestream_read(&left, &l[j], n);
+                samplestream_read(&right, &r[j], n);
+                k->pcm16(&out[j * 2], &l[j], &r[j], n);
+                if (j + n < req.len) {
+                    samplestream_seek(&left, 0);
+                    samplestream_seek(&right, 0);
+                }
+            }
+            j += n;
         }
 
         Reply(sender, out, sizeof out);
@@ -0,0 +1,80 @@
+#include "samplestream.h"
+
+void samplestream_start(struct samplestream *st,
+                        const struct bank *b,
+                        const struct bankzone *z,
+                        int channel)
+{
+    st->data = bank_data(b, z, channel);
+    st->codec = z->codec;
+    st->frames = z->frames;
+    st->loop_start = z->loop_start;
+    st->loop_end = z->loop_end;
+    samplestream_seek(st, 0);
+}
+
+/* Decode the next @n frames of @st into @out, all of them from the same
+ * block. */
+static void adpcm_read(struct samplestream *st, int16_t *out, uint32_t n)
+{
+    const struct adpcmblock *b = st->data;
+    b += st->at / ADPCM_FRAMES;
+
+    uint32_t i = st->at % ADPCM_FRAMES;
+    uint32_t end = i + n;
+    st->at += n;
+    if (i == 0) {
+        *out++ = adpcm_block(&st->adpcm, b);
+        i++;
+    }
+
+    /* Frame i's code is the (i - 1)th. */
+    for (; i < end; i++) {
+        unsigned int code = b->codes[(i - 1) >> 1] >> ((i - 1) & 1) * 4;
+        *out++ = adpcm_decode(&st->adpcm, code & 0xf);
+    }
+}
+
+void samplestream_seek(struct samplestream *st, uint32_t at)
+{
+    st->at = at;
+
+    /* Decoding has to pick up from the top of a block, so anything before
+     * @at in its block is decoded and thrown away. */
+    uint32_t into = at % ADPCM_FRAMES;
+    if (st->codec == BANK_ADPCM && into && at < st->frames) {
+        int16_t skip[ADPCM_FRAMES];
+        st->at = at - into;
+        adpcm_read(st, skip, into);
+    }
+}
+
+uint32_t samplestream_read(struct samplestream *st, int16_t *out, uint32_t n)
+{
+    uint32_t done = 0;
+    while (done < n) {
+        uint32_t stop = st->loop_end ? st->loop_end : st->frames;
+        if (st->at >= stop) {
+            if (!st->loop_end) {
+                break;
+            }
+            samplestream_seek(st, st->loop_start);
+            continue;
+        }
+
+        uint32_t run = n - done < stop - st->at ? n - done : stop - st->at;
+        if (st->codec == BANK_ADPCM) {
+            uint32_t left = ADPCM_FRAMES - st->at % ADPCM_FRAMES;
+            run = run < left ? run : left;
+            adpcm_read(st, &out[done], run);
+        } else {
+            const int16_t *pcm = st->data;
+            for (uint32_t i = 0; i < run; i++) {
+                out[done + i] = pcm[st->at + i];
+            }
+            st->at += run;
+        }
+        done += run;
+    }
+    return done;
+}
@@ -0,0 +1,41 @@
+#ifndef SXLHLG_SAMPLESTREAM_H
+#define SXLHLG_SAMPLESTREAM_H
+
+#include <stdint.h>
+
+#include "adpcm.h"
+#include "bank.h"
+
+/* A channel of a bank's sample, read in order a block at a time and decoded
+ * on the way if it's compressed (see bank.h), so that nothing ever needs the
+ * whole of it decoded at once.  A looped sample reads on round its loop for
+ * as long as it's read - what's after the end of the loop is never read - and
+ * a one-shot runs out at its end.
+ *
+ * Getting back to the start of a loop means decoding from the start of the
+ * ADPCM block it's in, so that costs up to ADPCM_FRAMES frames' worth of
+ * decoding every time round it. */
+struct samplestream {
+    const void *data;
+    uint8_t codec;
+    uint32_t frames;
+    uint32_t loop_start;
+    uint32_t loop_end;  /* or 0 if it doesn't loop */
+    uint32_t at;        /* the next frame to read */
+    struct adpcm adpcm;
+};
+
+/* Start @st at the top of channel @channel of @z's sample, in @b. */
+void samplestream_start(struct samplestream *st,
+                        const struct bank *b,
+                        const struct bankzone *z,
+                        int channel);
+
+/* Go to frame @at of @st's sample. */
+void samplestream_seek(struct samplestream *st, uint32_t at);
+
+/* Read the next @n frames of @st into @out, and return how many there were:
+ * all of them, unless a one-shot's run out. */
+uint32_t samplestream_read(struct samplestream *st, int16_t *out, uint32_t n);
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef SXLHLG_SINC_H
+#define SXLHLG_SINC_H
+
+/* The taps the sampler's windowed-sinc interpolation convolves with (see
+ * sampler.h): a Kaiser-windowed sinc at the sample's own Nyquist, tabulated at
+ * SAMPLER_SINC_PHASES positions between one frame and the next by
+ * tools/mksinc.c on the build host.  Each row is for the middle of its span of
+ * fractions, and is normalised to unity gain at DC so that a constant comes
+ * out as itself whatever the fraction. */
+#define SAMPLER_SINC_TAPS 8
+#define SAMPLER_SINC_BITS 10
+#define SAMPLER_SINC_PHASES (1 << SAMPLER_SINC_BITS)
+
+/* How many frames either side of its position the sinc reads: the position's
+ * own and the REACH - 1 before it, and the REACH after it. */
+#define SAMPLER_REACH (SAMPLER_SINC_TAPS / 2)
+
+/* How many frames a loop is followed by (see bank.h).  A voice goes back
+ * round the loop once it's REACH - 1 frames past its end, so that everything
+ * it reads either side of its position afterwards is inside the loop, and it
+ * reads up to REACH past that before it does. */
+#define SAMPLER_GUARD (2 * SAMPLER_REACH - 1)
+
+/* The taps for the frames from the position - (SAMPLER_REACH - 1) up, for each
+ * of the fractions. */
+extern const float sampler_sinc[SAMPLER_SINC_PHASES][SAMPLER_SINC_TAPS];
+
+#endif
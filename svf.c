@@ -0,0 +1,17 @@
+#include "svf.h"
+
+void svf_coeffs(struct svfcoeffs *c, float note, float k)
+{
+    /* Interpolate linearly between notes, which is good to a fraction of a
+     * cent - far better than the cutoff needs. */
+    note = note < 0.0f ? 0.0f : note;
+    note = note > SVF_NOTES - 1 ? SVF_NOTES - 1 : note;
+
+    int i = (int)note;
+    i = i < SVF_NOTES - 2 ? i : SVF_NOTES - 2;
+    float g = svf_g[i] + (svf_g[i + 1] - svf_g[i]) * (note - i);
+
+    c->a1 = 1.0f / (1.0f + g * (g + k));
+    c->a2 = g * c->a1;
+    c->a3 = g * c->a2;
+}
@@ -0,0 +1,38 @@
+#ifndef SXLHLG_SVF_H
+#define SXLHLG_SVF_H
+
+/* A topology-preserving-transform state-variable filter (after Andrew Simper's
+ * "linear trapezoidal integrated SVF"), one per voice.  Unlike the classic
+ * Chamberlin SVF it stays stable right up to Nyquist and copes well with its
+ * cutoff being modulated, so coefficients computed once per block are all it
+ * needs.
+ *
+ * The cutoff is given as a (fractional) MIDI note number, which makes key
+ * tracking and modulation in octaves simple additions. */
+
+/* The prewarped integrator gain tan(pi * f / fs) for cutoffs at each note from
+ * 0 up to just below Nyquist, generated at build time by tools/mksvf.c. */
+#define SVF_NOTES 136
+extern const float svf_g[SVF_NOTES];
+
+/* Damping ranges from sqrt(2) with no resonance, which gives the flattest
+ * passband without a peak, down to this at full resonance, which rings for a
+ * good long while without self-oscillating. */
+#define SVF_MAX_DAMPING 1.41421356f
+#define SVF_MIN_DAMPING 0.04f
+
+/* The per-voice coefficients the render kernels use. */
+struct svfcoeffs {
+    float a1, a2, a3;
+};
+
+/* How much of each of the filter's high, band and low-pass outputs to mix
+ * together for its overall response.  The same for every voice. */
+struct svfmix {
+    float high, band, low;
+};
+
+/* Compute the coefficients for a cutoff of @note with damping @k. */
+void svf_coeffs(struct svfcoeffs *c, float note, float k);
+
+#endif
@@ -1,10 +1,12 @@
 #include <stdbool.h>
 
 #include <caboose/caboose.h>
+#include <caboose/config.h>
 #include <caboose-platform/debug.h>
 #include <caboose-platform/platform-events.h>
 
 #include "audio.h"
+#include "bench.h"
 #include "midi.h"
 #include "synth.h"
 
@@ -12,9 +14,13 @@ void application(void)
 {
     debug_printf("Get up, get up, get up, get up!");
 
+#ifdef CONFIG_SYNTH_BENCH
+    Create(2, bench);
+#else
     Create(1, audio);
     Create(2, synth);
     Create(5, midisrc);
+#endif
 
     Exit();
 }
@@ -4,160 +4,1179 @@
 #include <caboose/platform.h>
 #include <caboose/util.h>
 
+#include <caboose-platform/fxmem.h>
+#include <caboose-platform/worker.h>
+
 #include "audio.h"
+#include "blep.h"
+#include "kernels.h"
 #include "messages.h"
 #include "midi.h"
+#include "sampler.h"
 #include "synth.h"
+#include "tuning.h"
+
+#define MIDI_NOTE_OFF           0b1000
+#define MIDI_NOTE_ON            0b1001
+#define MIDI_CONTROL_CHANGE     0b1011
+#define MIDI_CHANNEL_PRESSURE   0b1101
+
+#define MIDI_CC_MOD_WHEEL 1
+
+/* NOTE: the engine doesn't save VFP registers across context switches, so it's
+ * only safe to do floating point work in one task - this one.  (The worker
+ * cores this farms voices out to have VFPs of their own.) */
+
+/* Filter settings are recomputed once per control sub-block and glide towards
+ * their new values by this fraction of the way each time (a time constant of a
+ * couple of milliseconds), so that sweeping them doesn't zipper. */
+#define FILTER_SMOOTHING 0.25f
+
+/* Pulse widths are kept this far from either end of the cycle, where the pulse
+ * would vanish altogether. */
+#define PULSE_MIN_WIDTH 0.02f
+
+void synth_init(struct synth *s)
+{
+    s->kernels = kernels_select();
+
+    s->cores = 1 + WORKER_COUNT;
+    for (int w = 0; w < WORKER_COUNT; w++) {
+        s->shares[w].s = s;
+    }
+
+    struct patch p = {
+        .wave = WAVE_SQUARE,
+        .width = 0x80000000,
+        .unison = 1,
+        .detune = 0.2f,
+        .spread = 1.0f,
+        .table = &wavetable_classic,
+        .morph = 0.0f,
+        .cubic = false,
+        .filter = FILTER_OFF,
+        .cutoff = 96.0f,
+        .keytrack = 0.5f,
+        .resonance = 0.0f,
+        .volume = 1.0f,
+
+        /* Crunchy rather than fuzzy when it's turned up, and oversampled
+         * enough that high notes don't alias. */
+        .drive = {
+            .gain = 0.0f,
+            .level = 0.3f,
+            .oversample = 4
+        },
+
+        /* A slow, fairly deep ensemble chorus, when it's turned up. */
+        .chorus = {
+            .wet = 0.0f,
+            .rate = 0.5f,
+            .delay = 7.0f,
+            .depth = 2.5f
+        },
+
+        /* Dotted eighths at 120bpm, bouncing from side to side, when the
+         * delay is turned up. */
+        .delay = {
+            .wet = 0.0f,
+            .feedback = 0.35f,
+            .pingpong = true,
+            .time = 375.0f,
+            .bpm = 0.0f,
+            .beats = 0.75f,
+            .damping = 0.3f,
+            .mod_depth = 0.0f,
+            .mod_rate = 0.5f
+        },
+
+        /* A medium hall, when it's sent any signal. */
+        .reverb = {
+            .wet = 0.0f,
+            .size = 1.0f,
+            .decay = 1.8f,
+            .damping = 0.4f,
+            .lines = REVERB_LINES,
+            .order = 1
+        },
+
+        /* The mod wheel brings in vibrato and pressure opens up the filter,
+         * so the patch sounds just the same until they're used. */
+        .lfo = {
+            { .shape = LFO_SINE, .rate = 5.5f },
+            { .shape = LFO_TRIANGLE, .rate = 0.3f }
+        },
+        .mod = {
+            {
+                .source = MOD_LFO1,
+                .via = MOD_WHEEL,
+                .dest = MOD_PITCH,
+                .amount = 0.5f
+            },
+            {
+                .source = MOD_AFTERTOUCH,
+                .via = MOD_ONE,
+                .dest = MOD_CUTOFF,
+                .amount = 24.0f
+            }
+        }
+    };
+    adsr_set(&p.adsr, 5, 200, 70, 300);
+
+    /* A bright electric piano: a tine (1 -> 0) and a bell-like overtone
+     * (3 -> 2) that dies away quickly. */
+    p.fm.algorithm = 3;
+    p.fm.feedback = 0.2f;
+    static const struct {
+        float ratio, level;
+        int attack, decay, sustain, release;
+    } ops[FM_OPS] = {
+        { 1.0f, 1.0f, 1, 1500, 30, 300 },
+        { 1.0f, 0.35f, 1, 800, 10, 300 },
+        { 14.0f, 0.15f, 1, 300, 0, 100 },
+        { 1.0f, 0.25f, 1, 200, 0, 100 }
+    };
+    for (int op = 0; op < FM_OPS; op++) {
+        p.fm.op[op].ratio = ops[op].ratio;
+        p.fm.op[op].level = ops[op].level;
+        adsr_set(&p.fm.op[op].adsr,
+                 ops[op].attack,
+                 ops[op].decay,
+                 ops[op].sustain,
+                 ops[op].release);
+    }
+
+    /* A plucked string: a saw's harmonics, each as loud as it is in a saw,
+     * with the higher ones dying away sooner and further. */
+    p.additive.partials = 24;
+    for (int k = 0; k < p.additive.partials; k++) {
+        p.additive.ratio[k] = k + 1;
+        p.additive.level[k] = 0.6366198f / (k + 1);
+        p.additive.sustain[k] = 1.0f / (k + 1);
+        p.additive.decay[k] = 2000 / (k + 1);
+    }
+
+    /* The bank built in, which nothing has looked at since it was packed. */
+    ASSERT(bank_valid(&bank_default));
+    p.sampler.bank = &bank_default;
+    p.sampler.interp = SAMPLER_HERMITE;
+
+    /* Idle voices' filters run in the masked lanes too, so they need sane
+     * coefficients. */
+    struct svfcoeffs idle;
+    svf_coeffs(&idle, 60.0f, SVF_MAX_DAMPING);
+
+    /* Idle voices still get rendered alongside the others in their group, so
+     * give them a harmless pitch to keep NaNs out of the masked lanes. */
+    for (int i = 0; i < SYNTH_VOICE_COUNT; i++) {
+        s->voices[i].note = -1;
+        s->voices[i].gain = 0.0f;
+        s->voices[i].velocity = 0.0f;
+        s->voices[i].pitch = 0.0f;
+        env_reset(&s->voices[i].env);
+        s->voices[i].cutoff = 60.0f;
+        additive_reset(&s->additive.voice[i]);
+        for (int op = 0; op < FM_OPS; op++) {
+            env_reset(&s->voices[i].fm_env[op]);
+        }
+
+        s->bank.phase[i] = 0;
+        s->bank.inc[i] = tuning_words[69];
+        s->bank.inv_dt[i] = 1.0f / (tuning_words[69] * PHASE_SCALE);
+        s->bank.level[i] = 0.0f;
+        s->bank.step[i] = 0.0f;
+        s->bank.gate[i] = 0;
+        s->bank.width[i] = 0x80000000;
+        s->bank.svf_a1[i] = idle.a1;
+        s->bank.svf_a2[i] = idle.a2;
+        s->bank.svf_a3[i] = idle.a3;
+        s->bank.svf_ic1[0][i] = 0.0f;
+        s->bank.svf_ic2[0][i] = 0.0f;
+        s->bank.svf_ic1[1][i] = 0.0f;
+        s->bank.svf_ic2[1][i] = 0.0f;
+
+        for (int op = 0; op < FM_OPS; op++) {
+            s->bank.fm_phase[op][i] = 0;
+            s->bank.fm_inc[op][i] = 0;
+            s->bank.fm_level[op][i] = 0.0f;
+            s->bank.fm_step[op][i] = 0.0f;
+        }
+        s->bank.fm_fb1[i] = 0.0f;
+        s->bank.fm_fb2[i] = 0.0f;
+
+        sampler_play(&s->sampler, &s->bank, i, NULL, NULL);
+        s->bank.smp_step[i] = 0;
+        s->bank.smp_step_frac[i] = 0;
+        s->voices[i].root = 60;
+
+        for (int c = 0; c < UNISON_MAX; c++) {
+            s->bank.uni_phase[i][c] = 0;
+            s->bank.uni_inc[i][c] = tuning_words[69];
+            s->bank.uni_inv_dt[i][c] = 1.0f / (tuning_words[69] * PHASE_SCALE);
+        }
+    }
+
+    s->active = 0;
+    s->stamp = 0;
+    s->damping = SVF_MAX_DAMPING;
+    s->copies = 1;
+    s->detune = 0.0f;
+    for (int c = 0; c < UNISON_MAX; c++) {
+        s->pan[0][c] = 0.0f;
+        s->pan[1][c] = 0.0f;
+    }
+
+    for (int i = 0; i < LFO_COUNT; i++) {
+        lfo_reset(&s->lfo[i]);
+    }
+    s->wheel = 0.0f;
+    s->pressure = 0.0f;
+    params_init(&s->params);
+    drive_init(&s->drive);
+    float *fx = (float *)fxmem;
+    delay_init(&s->delay, fx);
+    reverb_init(&s->reverb, fx + 2 * DELAY_LEN);
+    chorus_init(&s->chorus, fx + 2 * DELAY_LEN + REVERB_LINES * REVERB_LEN);
+    limiter_init(&s->limiter);
+    dither_init(&s->dither);
+    s->event_head = 0;
+    s->event_count = 0;
+    s->clock = 0;
+    s->clocked = false;
+
+    synth_load(s, &p);
+}
+
+void synth_load(struct synth *s, const struct patch *p)
+{
+    s->patch = *p;
+    for (int i = 0; i < LFO_COUNT; i++) {
+        lfo_set(&s->lfo[i], &p->lfo[i]);
+    }
+    mod_build(&s->matrix, p->mod, MOD_ROUTES);
+
+    /* Anything still gliding was headed for a setting of the old patch. */
+    s->params.moving = 0;
+}
+
+/* How many copies of each note @s's patch plays in unison. */
+static int unison_copies(struct synth *s)
+{
+    int copies = s->patch.wave == WAVE_SAW ? s->patch.unison : 1;
+    copies = copies < 1 ? 1 : copies;
+    return copies > UNISON_MAX ? UNISON_MAX : copies;
+}
+
+/* The filter cutoff @s's patch asks for when playing @note. */
+static float filter_cutoff(struct synth *s, int note)
+{
+    return s->patch.cutoff + s->patch.keytrack * (note - 60);
+}
+
+/* Choose a voice for a new note.  In order of preference, we'll take the voice
+ * already playing this note (so that repeated keys don't pile up), a free
+ * voice, or failing those we'll steal the quietest voice - the oldest of those
+ * if there's a tie, since it's been heard the longest.  Voices in their release
+ * are still sounding, but they'll generally be the quiet ones.
+ *
+ * Free voices are taken lowest index first, which keeps the sounding voices
+ * packed into as few groups as possible. */
+static int voice_alloc(struct synth *s, int note)
+{
+    int idle = -1;
+    int victim = -1;
+    for (int i = 0; i < SYNTH_VOICE_COUNT; i++) {
+        struct voice *v = &s->voices[i];
+        if (v->note == note) {
+            return i;
+        }
+
+        if (v->note < 0) {
+            idle = idle < 0 ? i : idle;
+            continue;
+        }
+
+        float level = s->bank.level[i];
+        if (victim < 0
+            || level < s->bank.level[victim]
+            || (level == s->bank.level[victim]
+                && s->stamp - v->stamp
+                   > s->stamp - s->voices[victim].stamp)) {
+            victim = i;
+        }
+    }
+
+    return idle >= 0 ? idle : victim;
+}
+
+/* Set voice @i's oscillator, and its operators, partials or sample, to phase
+ * increment @inc.  Operators tuned past Nyquist are pinned there, where
+ * they're silent; partials are silenced (see additive.h). */
+static void voice_tune(struct synth *s, int i, uint32_t inc)
+{
+    s->bank.inc[i] = inc;
+    s->bank.inv_dt[i] = 1.0f / (inc * PHASE_SCALE);
+
+    for (int op = 0; op < FM_OPS; op++) {
+        float opinc = inc * s->patch.fm.op[op].ratio;
+        s->bank.fm_inc[op][i] = opinc < 2147483648.0f
+                                ? (uint32_t)opinc
+                                : 0x80000000;
+    }
+
+    if (s->patch.wave == WAVE_ADDITIVE) {
+        additive_tune(&s->additive.voice[i], inc);
+    }
+
+    if (s->patch.wave == WAVE_SAMPLE) {
+        sampler_tune(&s->bank, i, s->voices[i].root, inc);
+    }
+}
+
+/* Tune voice @i's unison copies either side of @note.  Like voice_tune(), this
+ * costs a division per copy, so it's only done when something has changed. */
+static void voice_detune(struct synth *s, int i, float note)
+{
+    const float *detune = unison_detune[s->copies - 1];
+    for (int c = 0; c < s->copies; c++) {
+        uint32_t inc = tuning_inc(note + s->detune * detune[c]);
+        s->bank.uni_inc[i][c] = inc;
+        s->bank.uni_inv_dt[i][c] = 1.0f / (inc * PHASE_SCALE);
+    }
+}
+
+/* Start voice @i on the zone of the patch's bank that plays @note at
+ * @velocity, or on silence if there isn't one - or if it can't go that high
+ * (see sampler_playable()). */
+static void voice_sample(struct synth *s, int i, int note, int velocity)
+{
+    const struct bank *b = s->patch.sampler.bank;
+    const struct bankzone *z = bank_zone(b, note, velocity);
+    z = z && sampler_playable(z, note) ? z : NULL;
+    sampler_play(&s->sampler, &s->bank, i, b, z);
+    if (z) {
+        s->voices[i].root = z->root;
+    }
+}
+
+void synth_note_on(struct synth *s, int note, int velocity)
+{
+    int i = voice_alloc(s, note);
+    struct voice *v = &s->voices[i];
+
+    /* A retriggered note carries on from where its oscillator and filter are,
+     * since the envelope does too. */
+    if (v->note != note) {
+        s->bank.phase[i] = 0;
+        s->bank.svf_ic1[0][i] = 0.0f;
+        s->bank.svf_ic2[0][i] = 0.0f;
+        s->bank.svf_ic1[1][i] = 0.0f;
+        s->bank.svf_ic2[1][i] = 0.0f;
+        v->cutoff = filter_cutoff(s, note);
+
+        for (int c = 0; c < UNISON_MAX; c++) {
+            s->bank.uni_phase[i][c] = unison_phase[c];
+        }
+
+        for (int op = 0; op < FM_OPS; op++) {
+            s->bank.fm_phase[op][i] = 0;
+        }
+        s->bank.fm_fb1[i] = 0.0f;
+        s->bank.fm_fb2[i] = 0.0f;
+    }
+
+    /* A sample is played from the top every time, retriggered or not, and
+     * it's the velocity as well as the note that picks it. */
+    if (s->patch.wave == WAVE_SAMPLE) {
+        voice_sample(s, i, note, velocity);
+    }
+
+    /* The partials are culled for the note's own pitch.  Bending it up is
+     * left to additive_tune(). */
+    if (s->patch.wave == WAVE_ADDITIVE) {
+        additive_start(&s->additive.voice[i],
+                       &s->patch.additive,
+                       tuning_words[note],
+                       v->note != note);
+    }
+
+    v->note = note;
+    v->stamp = s->stamp++;
+    v->gain = VOICE_GAIN * velocity / 127;
+    v->velocity = velocity / 127.0f;
+    env_gate_on(&v->env);
+
+    /* Any pitch modulation is picked up at the next control sub-block. */
+    v->pitch = 0.0f;
+    voice_tune(s, i, tuning_words[note]);
+    if (s->copies > 1) {
+        voice_detune(s, i, note);
+    }
+    s->bank.gate[i] = 0xffffffff;
+    s->active |= 1u << i;
+
+    for (int op = 0; op < FM_OPS; op++) {
+        env_gate_on(&v->fm_env[op]);
+    }
+}
+
+void synth_note_off(struct synth *s, int note)
+{
+    /* The voice stays allocated until its release has run out. */
+    for (int i = 0; i < SYNTH_VOICE_COUNT; i++) {
+        struct voice *v = &s->voices[i];
+        if (v->note == note) {
+            env_gate_off(&v->env);
+            for (int op = 0; op < FM_OPS; op++) {
+                env_gate_off(&v->fm_env[op]);
+            }
+        }
+    }
+}
+
+/* The current setting of @param in @s's patch. */
+static float param_get(struct synth *s, int param)
+{
+    struct patch *p = &s->patch;
+    switch (param) {
+    case PARAM_CUTOFF:
+        return p->cutoff;
+    case PARAM_RESONANCE:
+        return p->resonance;
+    case PARAM_KEYTRACK:
+        return p->keytrack;
+    case PARAM_WIDTH:
+        return p->width * PHASE_SCALE;
+    case PARAM_MORPH:
+        return p->morph;
+    case PARAM_FEEDBACK:
+        return p->fm.feedback;
+    case PARAM_OP1_LEVEL:
+    case PARAM_OP2_LEVEL:
+    case PARAM_OP3_LEVEL:
+    case PARAM_OP4_LEVEL:
+        return p->fm.op[param - PARAM_OP1_LEVEL].level;
+    case PARAM_ATTACK:
+        return 1000.0f / (p->adsr.attack * AUDIO_SAMPLE_RATE);
+    case PARAM_DECAY:
+        return 1000.0f / (p->adsr.decay * AUDIO_SAMPLE_RATE);
+    case PARAM_SUSTAIN:
+        return p->adsr.sustain * 100.0f;
+    case PARAM_RELEASE:
+        return 1000.0f / (p->adsr.release * AUDIO_SAMPLE_RATE);
+    case PARAM_LFO1_RATE:
+    case PARAM_LFO2_RATE:
+        return p->lfo[param - PARAM_LFO1_RATE].rate;
+    case PARAM_VOLUME:
+        return p->volume;
+    case PARAM_REVERB:
+        return p->reverb.wet;
+    case PARAM_CHORUS:
+        return p->chorus.wet;
+    case PARAM_DETUNE:
+        return p->detune;
+    case PARAM_SPREAD:
+        return p->spread;
+    case PARAM_DRIVE:
+        return p->drive.gain;
+    }
+
+    return 0.0f;
+}
+
+static void param_set(struct synth *s, int param, float value)
+{
+    struct patch *p = &s->patch;
+    switch (param) {
+    case PARAM_CUTOFF:
+        p->cutoff = value;
+        break;
+    case PARAM_RESONANCE:
+        p->resonance = value;
+        break;
+    case PARAM_KEYTRACK:
+        p->keytrack = value;
+        break;
+    case PARAM_WIDTH:
+        p->width = (uint32_t)(value * 4294967296.0f);
+        break;
+    case PARAM_MORPH:
+        p->morph = value;
+        break;
+    case PARAM_FEEDBACK:
+        p->fm.feedback = value;
+        break;
+    case PARAM_OP1_LEVEL:
+    case PARAM_OP2_LEVEL:
+    case PARAM_OP3_LEVEL:
+    case PARAM_OP4_LEVEL:
+        p->fm.op[param - PARAM_OP1_LEVEL].level = value;
+        break;
+    case PARAM_ATTACK:
+        p->adsr.attack = adsr_rate(value);
+        break;
+    case PARAM_DECAY:
+        p->adsr.decay = adsr_rate(value);
+        break;
+    case PARAM_SUSTAIN:
+        p->adsr.sustain = value * 0.01f;
+        break;
+    case PARAM_RELEASE:
+        p->adsr.release = adsr_rate(value);
+        break;
+    case PARAM_LFO1_RATE:
+    case PARAM_LFO2_RATE:
+    {
+        int i = param - PARAM_LFO1_RATE;
+        p->lfo[i].rate = value;
+        lfo_set(&s->lfo[i], &p->lfo[i]);
+        break;
+    }
+    case PARAM_VOLUME:
+        p->volume = value;
+        break;
+    case PARAM_REVERB:
+        p->reverb.wet = value;
+        break;
+    case PARAM_CHORUS:
+        p->chorus.wet = value;
+        break;
+    case PARAM_DETUNE:
+        p->detune = value;
+        break;
+    case PARAM_SPREAD:
+        p->spread = value;
+        break;
+    case PARAM_DRIVE:
+        p->drive.gain = value;
+        break;
+    }
+}
+
+void synth_control_change(struct synth *s, int cc, int value)
+{
+    if (cc == MIDI_CC_MOD_WHEEL) {
+        s->wheel = value / 127.0f;
+        return;
+    }
+
+    int param = s->params.map[cc & (PARAM_CCS - 1)];
+    if (param == PARAM_NONE) {
+        return;
+    }
+
+    /* A parameter that's at rest glides from wherever the patch has it, which
+     * needn't be anywhere a controller could have put it. */
+    if (!(s->params.moving & (1u << param))) {
+        s->params.value[param] = param_get(s, param);
+        s->params.moving |= 1u << param;
+    }
+    s->params.target[param] = params_scale(param, value);
+}
+
+void synth_pressure(struct synth *s, int value)
+{
+    s->pressure = value / 127.0f;
+}
+
+void synth_midi(struct synth *s, const uint8_t *msg)
+{
+    uint8_t type = msg[0] >> 4;
+    int data1 = msg[1] & 0x7f;
+    int data2 = msg[2] & 0x7f;
+    switch (type) {
+    case MIDI_NOTE_OFF:
+        synth_note_off(s, data1);
+        break;
+    case MIDI_NOTE_ON:
+        /* A note-on with zero velocity is how running status expresses a
+         * note-off. */
+        if (data2) {
+            synth_note_on(s, data1, data2);
+        } else {
+            synth_note_off(s, data1);
+        }
+        break;
+    case MIDI_CONTROL_CHANGE:
+        synth_control_change(s, data1, data2);
+        break;
+    case MIDI_CHANNEL_PRESSURE:
+        synth_pressure(s, data1);
+        break;
+    }
+}
+
+void synth_queue(struct synth *s, uint32_t stamp, const uint8_t *msg)
+{
+    /* When the queue's full, the oldest message can't wait any longer. */
+    if (s->event_count == SYNTH_EVENTS) {
+        synth_midi(s, s->events[s->event_head].msg);
+        s->event_head = (s->event_head + 1) % SYNTH_EVENTS;
+        s->event_count--;
+    }
+
+    int tail = (s->event_head + s->event_count) % SYNTH_EVENTS;
+    s->events[tail].stamp = stamp;
+    for (int i = 0; i < 3; i++) {
+        s->events[tail].msg[i] = msg[i];
+    }
+    s->event_count++;
+}
+
+static void voice_free(struct synth *s, int i)
+{
+    s->voices[i].note = -1;
+    s->bank.level[i] = 0.0f;
+    s->bank.step[i] = 0.0f;
+    s->bank.gate[i] = 0;
+    s->bank.svf_ic1[0][i] = 0.0f;
+    s->bank.svf_ic2[0][i] = 0.0f;
+    s->bank.svf_ic1[1][i] = 0.0f;
+    s->bank.svf_ic2[1][i] = 0.0f;
+    for (int op = 0; op < FM_OPS; op++) {
+        env_reset(&s->voices[i].fm_env[op]);
+        s->bank.fm_level[op][i] = 0.0f;
+        s->bank.fm_step[op][i] = 0.0f;
+    }
+    s->active &= ~(1u << i);
+}
 
-static int periods[] = {
-	5394,
-	5091,
-	4805,
-	4536,
-	4281,
-	4041,
-	3814,
-	3600,
-	3398,
-	3207,
-	3027,
-	2857,
-	2697,
-	2546,
-	2403,
-	2268,
-	2141,
-	2020,
-	1907,
-	1800,
-	1699,
-	1604,
-	1514,
-	1429,
-	1348,
-	1273,
-	1201,
-	1134,
-	1070,
-	1010,
-	954,
-	900,
-	849,
-	802,
-	757,
-	714,
-	674,
-	636,
-	601,
-	567,
-	535,
-	505,
-	477,
-	450,
-	425,
-	401,
-	378,
-	357,
-	337,
-	318,
-	300,
-	283,
-	268,
-	253,
-	238,
-	225,
-	212,
-	200,
-	189,
-	179,
-	169,
-	159,
-	150,
-	142,
-	134,
-	126,
-	119,
-	113,
-	106,
-	100,
-	95,
-	89,
-	84,
-	80,
-	75,
-	71,
-	67,
-	63,
-	60,
-	56,
-	53,
-	50,
-	47,
-	45,
-	42,
-	40,
-	38,
-	35,
-	33,
-	32,
-	30,
-	28,
-	27,
-	25,
-	24,
-	22,
-	21,
-	20,
-	19,
-	18,
-	17,
-	16,
-	15,
-	14,
-	13,
-	13,
-	12,
-	11,
-	11,
-	10,
-	9,
-	9,
-	8,
-	8,
-	7,
-	7,
-	7,
-	6,
-	6,
-	6,
-	5,
-	5,
-	5,
-	4,
-	4,
-	4,
-	4,
-	4
+/* The levels that the ramps set up for a sub-block end on. */
+struct ramps {
+    float level[SYNTH_VOICE_COUNT];
+    float fm[FM_OPS][SYNTH_VOICE_COUNT];
 };
 
-#define MIDI_NOTE_OFF   0b1000
-#define MIDI_NOTE_ON    0b1001
+/* The once-per-sub-block work for each sounding voice: run its envelopes and
+ * its modulation on to the end of the sub-block and set up the ramps to get
+ * there, and update its pitch, pulse width and filter.  Returns the levels
+ * that were ramped to in @end. */
+static void synth_control(struct synth *s, struct ramps *end, int len)
+{
+    /* Controllers first, so that everything below sees this sub-block's
+     * settings. */
+    for (uint32_t moving = s->params.moving; moving; moving &= moving - 1) {
+        int param = __builtin_ctz(moving);
+        param_set(s, param, params_step(&s->params, param));
+    }
+
+    bool fm = s->patch.wave == WAVE_FM;
+    bool additive = s->patch.wave == WAVE_ADDITIVE;
+    bool filter = s->patch.filter != FILTER_OFF;
+    bool pulse = s->patch.wave == WAVE_SQUARE || s->patch.wave == WAVE_PULSE;
+    float width = s->patch.wave == WAVE_SQUARE
+                  ? 0.5f
+                  : s->patch.width * PHASE_SCALE;
+    if (filter) {
+        float resonance = s->patch.resonance;
+        resonance = resonance < 0.0f ? 0.0f : resonance;
+        resonance = resonance > 1.0f ? 1.0f : resonance;
+        float damping = SVF_MAX_DAMPING
+                        - (SVF_MAX_DAMPING - SVF_MIN_DAMPING) * resonance;
+        s->damping += (damping - s->damping) * FILTER_SMOOTHING;
+    }
+
+    /* The copies are retuned along with the voices' pitch modulation, and
+     * all of them are when the unison itself has changed. */
+    int copies = unison_copies(s);
+    float detune = s->patch.detune < 0.0f ? 0.0f : s->patch.detune;
+    bool retune = copies > 1 && (copies != s->copies || detune != s->detune);
+    s->copies = copies;
+    s->detune = detune;
+    if (copies > 1) {
+        float spread = s->patch.spread;
+        spread = spread < 0.0f ? 0.0f : spread;
+        spread = spread > 1.0f ? 1.0f : spread;
+
+        float mono = unison_mono[copies - 1];
+        for (int ch = 0; ch < 2; ch++) {
+            const float *full = unison_pan[copies - 1][ch];
+            for (int c = 0; c < UNISON_MAX; c++) {
+                s->pan[ch][c] = c < copies
+                                ? mono + (full[c] - mono) * spread
+                                : 0.0f;
+            }
+        }
+    }
+
+    /* The sources every voice shares.  The LFOs run whether or not any voices
+     * are sounding, so that they don't stop and start with the notes. */
+    float src[MOD_SOURCES];
+    src[MOD_ONE] = 1.0f;
+    src[MOD_LFO1] = lfo_advance(&s->lfo[0], len);
+    src[MOD_LFO2] = lfo_advance(&s->lfo[1], len);
+    src[MOD_WHEEL] = s->wheel;
+    src[MOD_AFTERTOUCH] = s->pressure;
+
+    float inv_len = 1.0f / len;
+    for (int i = 0; i < SYNTH_VOICE_COUNT; i++) {
+        if (!(s->active & (1u << i))) {
+            continue;
+        }
 
-#define SAMPLE_HIGH 6144
-#define SAMPLE_MID 4096
-#define SAMPLE_LOW 2048
+        struct voice *v = &s->voices[i];
+        float env = env_advance(&v->env, &s->patch.adsr, len);
 
-static int fill(uint32_t *buf, int count, int period, int offset)
+        float dst[MOD_DESTS];
+        src[MOD_ENV] = env;
+        src[MOD_VELOCITY] = v->velocity;
+        mod_eval(&s->matrix, src, dst);
+
+        float amp = 1.0f + dst[MOD_AMP];
+        amp = amp < 0.0f ? 0.0f : amp;
+        end->level[i] = env * v->gain * amp * s->patch.volume;
+        s->bank.step[i] = (end->level[i] - s->bank.level[i]) * inv_len;
+
+        /* Retuning costs a division, so it's only done when the pitch has
+         * actually moved. */
+        if (dst[MOD_PITCH] != v->pitch || retune) {
+            v->pitch = dst[MOD_PITCH];
+            voice_tune(s, i, tuning_inc(v->note + v->pitch));
+            if (copies > 1) {
+                voice_detune(s, i, v->note + v->pitch);
+            }
+        }
+
+        if (pulse) {
+            float w = width + dst[MOD_WIDTH];
+            w = w < PULSE_MIN_WIDTH ? PULSE_MIN_WIDTH : w;
+            w = w > 1.0f - PULSE_MIN_WIDTH ? 1.0f - PULSE_MIN_WIDTH : w;
+            s->bank.width[i] = (uint32_t)(w * 4294967296.0f);
+        }
+
+        if (additive) {
+            additive_control(&s->additive.voice[i], len);
+        }
+
+        for (int op = 0; fm && op < FM_OPS; op++) {
+            const struct fmop *o = &s->patch.fm.op[op];
+            end->fm[op][i] = env_advance(&v->fm_env[op], &o->adsr, len)
+                             * o->level;
+            s->bank.fm_step[op][i] = (end->fm[op][i] - s->bank.fm_level[op][i])
+                                     * inv_len;
+        }
+
+        if (filter) {
+            float cutoff = filter_cutoff(s, v->note) + dst[MOD_CUTOFF];
+            v->cutoff += (cutoff - v->cutoff) * FILTER_SMOOTHING;
+
+            struct svfcoeffs c;
+            svf_coeffs(&c, v->cutoff, s->damping);
+            s->bank.svf_a1[i] = c.a1;
+            s->bank.svf_a2[i] = c.a2;
+            s->bank.svf_a3[i] = c.a3;
+        }
+    }
+}
+
+/* Land every voice exactly on its envelopes' values, and give back the ones
+ * whose release finished during the sub-block.  It's the voice's own envelope
+ * that decides that: the operators' envelopes only shape the sound. */
+static void synth_retire(struct synth *s, const struct ramps *end)
 {
-    int midpoint = period / 2;
-    for (int i = 0; i < count; i++) {
-        uint32_t sample = offset < midpoint ? SAMPLE_HIGH : SAMPLE_LOW;
-        *buf++ = sample;
-        *buf++ = sample;
-        offset = (offset + 1) % period;
+    bool fm = s->patch.wave == WAVE_FM;
+    bool additive = s->patch.wave == WAVE_ADDITIVE;
+    for (int i = 0; i < SYNTH_VOICE_COUNT; i++) {
+        if (!(s->active & (1u << i))) {
+            continue;
+        }
+
+        if (env_idle(&s->voices[i].env)) {
+            voice_free(s, i);
+            continue;
+        }
+
+        s->bank.level[i] = end->level[i];
+        for (int op = 0; fm && op < FM_OPS; op++) {
+            s->bank.fm_level[op][i] = end->fm[op][i];
+        }
+        if (additive) {
+            additive_land(&s->additive.voice[i]);
+        }
+    }
+}
+
+/* Add the oscillators of the voices in @group into @acc. */
+static void render_oscillators(struct synth *s, int group, float *acc, int len)
+{
+    const struct kernels *k = s->kernels;
+
+    switch (s->patch.wave) {
+    case WAVE_SQUARE:
+    case WAVE_PULSE:
+        /* (The widths were set in synth_control().) */
+        k->pulse4(&s->bank, group, acc, len);
+        break;
+    case WAVE_SAW:
+        k->saw4(&s->bank, group, acc, len);
+        break;
+    case WAVE_TABLE:
+        if (s->patch.cubic) {
+            k->table4_cubic(&s->bank,
+                            group,
+                            s->patch.table,
+                            s->patch.morph,
+                            acc,
+                            len);
+        } else {
+            k->table4(&s->bank,
+                      group,
+                      s->patch.table,
+                      s->patch.morph,
+                      acc,
+                      len);
+        }
+        break;
+    case WAVE_FM:
+        k->fm4[s->patch.fm.algorithm](&s->bank,
+                                      group,
+                                      s->patch.fm.feedback,
+                                      acc,
+                                      len);
+        break;
+    case WAVE_ADDITIVE:
+        k->additive4(&s->bank, &s->additive, group, acc, len);
+        break;
+    case WAVE_SAMPLE:
+        sampler_fill(&s->sampler, &s->bank, group, len);
+        k->sampler4[s->patch.sampler.interp](&s->bank, group, acc, len);
+        break;
+    }
+}
+
+/* Render the voices in each of @groups (bit n for group n) into @acc, using
+ * @voices as scratch space of the same size, and through @filter unless it's
+ * off.  Voices playing in unison are stereo, and their right channel goes
+ * into @accr, with @voicesr as its scratch. */
+static void render_groups(struct synth *s,
+                          uint32_t groups,
+                          const struct svfmix *filter,
+                          float *acc,
+                          float *accr,
+                          float *voices,
+                          float *voicesr,
+                          int len)
+{
+    const struct kernels *k = s->kernels;
+
+    for (int group = 0; group < VOICE_GROUPS; group++) {
+        if (!(groups & (1 << group))) {
+            continue;
+        }
+
+        bool unison = s->copies > 1;
+        if (s->patch.filter == FILTER_OFF) {
+            if (unison) {
+                k->unison4(&s->bank, group, s->copies, s->pan, acc, accr, len);
+            } else {
+                render_oscillators(s, group, acc, len);
+            }
+            continue;
+        }
+
+        for (int i = 0; i < len * VOICE_LANES; i++) {
+            voices[i] = 0.0f;
+        }
+        for (int i = 0; unison && i < len * VOICE_LANES; i++) {
+            voicesr[i] = 0.0f;
+        }
+
+        if (unison) {
+            k->unison4(&s->bank,
+                       group,
+                       s->copies,
+                       s->pan,
+                       voices,
+                       voicesr,
+                       len);
+        } else {
+            render_oscillators(s, group, voices, len);
+        }
+        k->svf4(&s->bank, group, 0, filter, voices, len);
+        k->mix(acc, voices, len * VOICE_LANES);
+
+        if (unison) {
+            k->svf4(&s->bank, group, 1, filter, voicesr, len);
+            k->mix(accr, voicesr, len * VOICE_LANES);
+        }
     }
+}
 
-    return offset;
+/* A worker's job: render its share into its own accumulators. */
+static void render_share(void *arg)
+{
+    struct synthshare *share = arg;
+    struct synth *s = share->s;
+    int len = share->len;
+
+    for (int i = 0; i < len * VOICE_LANES; i++) {
+        share->acc[i] = 0.0f;
+    }
+    for (int i = 0; s->copies > 1 && i < len * VOICE_LANES; i++) {
+        share->accr[i] = 0.0f;
+    }
+
+    render_groups(s,
+                  share->groups,
+                  &share->filter,
+                  share->acc,
+                  share->accr,
+                  share->voices,
+                  share->voicesr,
+                  len);
+}
+
+/* Render one control sub-block of @len samples into @acc, using @voices as
+ * scratch space of the same size.  Voices playing in unison are stereo, and
+ * their right channel goes into @accr, with @voicesr as its scratch. */
+static void synth_block(struct synth *s,
+                        float *acc,
+                        float *accr,
+                        float *voices,
+                        float *voicesr,
+                        int len)
+{
+    const struct kernels *k = s->kernels;
+
+    struct ramps end;
+    synth_control(s, &end, len);
+
+    struct svfmix filter = { 0.0f, 0.0f, 0.0f };
+    switch (s->patch.filter) {
+    case FILTER_OFF:
+        break;
+    case FILTER_LOWPASS:
+        filter = (struct svfmix) { 0.0f, 0.0f, 1.0f };
+        break;
+    case FILTER_HIGHPASS:
+        filter = (struct svfmix) { 1.0f, -s->damping, -1.0f };
+        break;
+    case FILTER_BANDPASS:
+        /* Scaled so that the peak stays at unity as the resonance rises. */
+        filter = (struct svfmix) { 0.0f, s->damping, 0.0f };
+        break;
+    }
+
+    /* Groups with no voices sounding at all are skipped outright, but within
+     * a group the idle voices are masked, not branched around.  The groups
+     * that are sounding are split between the cores in runs, as evenly as
+     * they'll go, this one first and with any left over, so a handful of
+     * voices never leaves this one waiting on the workers.  Each group's
+     * voices are only touched by the core rendering them, and everything else
+     * they read stays put until the join.
+     *
+     * Runs rather than every other group, because a group's lanes in the
+     * voicebank are only 16 bytes, and neighbouring groups share cache lines:
+     * dealt out in turn, every line of them would be written by every core
+     * at once.  This way only the lines at the ends of the runs are. */
+    int sounding = 0;
+    for (int group = 0; group < VOICE_GROUPS; group++) {
+        if ((s->active >> (group * VOICE_LANES)) & VOICE_GROUP_MASK) {
+            sounding++;
+        }
+    }
+
+    uint32_t mine = 0;
+    uint32_t dealt[WORKER_COUNT] = { 0 };
+    int nth = 0;
+    for (int group = 0; group < VOICE_GROUPS; group++) {
+        if (!((s->active >> (group * VOICE_LANES)) & VOICE_GROUP_MASK)) {
+            continue;
+        }
+
+        int core = nth++ * s->cores / sounding;
+        if (core) {
+            dealt[core - 1] |= 1 << group;
+        } else {
+            mine |= 1 << group;
+        }
+    }
+
+    for (int w = 0; w < WORKER_COUNT; w++) {
+        if (dealt[w]) {
+            s->shares[w].groups = dealt[w];
+            s->shares[w].filter = filter;
+            s->shares[w].len = len;
+            worker_post(w, render_share, &s->shares[w]);
+        }
+    }
+
+    render_groups(s, mine, &filter, acc, accr, voices, voicesr, len);
+
+    /* The workers' groups are mixed in after this core's, in the same order
+     * every time, so the result doesn't depend on which finishes first. */
+    for (int w = 0; w < WORKER_COUNT; w++) {
+        if (dealt[w]) {
+            worker_wait(w);
+            k->mix(acc, s->shares[w].acc, len * VOICE_LANES);
+            if (s->copies > 1) {
+                k->mix(accr, s->shares[w].accr, len * VOICE_LANES);
+            }
+        }
+    }
+
+    synth_retire(s, &end);
+}
+
+/* The sample of a @len-sample block, @span microseconds long and starting at
+ * system timer @start, that the oldest queued message belongs at, or -1 if it
+ * doesn't belong in this block - or there isn't one.  Messages from before the
+ * block started can only be late, and go at its start, and so does everything
+ * queued before an untimed block (one with no span), which has nothing to
+ * place them by but mustn't leave them waiting. */
+static int event_offset(struct synth *s, uint32_t start, uint32_t span, int len)
+{
+    if (!s->event_count) {
+        return -1;
+    }
+    if (!span) {
+        return 0;
+    }
+
+    uint32_t since = s->events[s->event_head].stamp - start;
+    if ((int32_t)since < 0) {
+        return 0;
+    }
+    if (since >= span) {
+        return -1;
+    }
+
+    int offset = (since * len + span / 2) / span;
+    return offset < len ? offset : len - 1;
+}
+
+/* Render a block of @len samples into @out, acting on the queued messages
+ * that belong in it (see event_offset()) as the render reaches them. */
+static void synth_mix(struct synth *s,
+                      uint32_t *out,
+                      int len,
+                      uint32_t start,
+                      uint32_t span)
+{
+    const struct kernels *k = s->kernels;
+
+    /* Each group of voices is accumulated lane by lane into @acc, which is
+     * folded down into the mix once all of them are done.  When the filter's
+     * on, each group is rendered into @voices first, since it has to be
+     * filtered on its own before it's mixed with the others.  Voices playing
+     * in unison have a right channel too, which gets the same again.  All of
+     * these live on the stack for the duration of the request. */
+    bool unison = unison_copies(s) > 1;
+    float acc[len * VOICE_LANES] __aligned(16);
+    float accr[len * VOICE_LANES] __aligned(16);
+    float voices[SYNTH_CONTROL_LEN * VOICE_LANES] __aligned(16);
+    float voicesr[SYNTH_CONTROL_LEN * VOICE_LANES] __aligned(16);
+    float left[len], right[len];
+    for (int i = 0; i < len * VOICE_LANES; i++) {
+        acc[i] = 0.0f;
+    }
+    for (int i = 0; unison && i < len * VOICE_LANES; i++) {
+        accr[i] = 0.0f;
+    }
+
+    /* A sub-block is cut short where a message is due, so that it's acted on
+     * before the next sample.  Messages can't change whether the voices are
+     * in unison (only a new patch can), so the accumulators stay right. */
+    for (int i = 0; i < len;) {
+        int due;
+        while ((due = event_offset(s, start, span, len)) >= 0 && due <= i) {
+            synth_midi(s, s->events[s->event_head].msg);
+            s->event_head = (s->event_head + 1) % SYNTH_EVENTS;
+            s->event_count--;
+        }
+
+        int n = len - i < SYNTH_CONTROL_LEN ? len - i : SYNTH_CONTROL_LEN;
+        n = due >= 0 && due - i < n ? due - i : n;
+        synth_block(s,
+                    &acc[i * VOICE_LANES],
+                    &accr[i * VOICE_LANES],
+                    voices,
+                    voicesr,
+                    n);
+        i += n;
+    }
+
+    k->reduce(left, acc, len);
+    if (unison) {
+        k->reduce(right, accr, len);
+    }
+
+    /* The drive comes first, while the mix is most likely still mono.  It's
+     * told about the channels it's skipped, so that it doesn't pick up where
+     * it left off when it's next turned up. */
+    bool driven = s->patch.drive.gain > 0.0f;
+    if (driven) {
+        drive_process(&s->drive, k, &s->patch.drive, 0, left, len);
+    } else {
+        drive_bypass(&s->drive, 0);
+    }
+    if (driven && unison) {
+        drive_process(&s->drive, k, &s->patch.drive, 1, right, len);
+    } else {
+        drive_bypass(&s->drive, 1);
+    }
+
+    /* The effects are skipped outright while they're turned off, and the mix
+     * stays mono until unison or one of them makes it stereo. */
+    bool effects = s->patch.chorus.wet > 0.0f
+                   || s->patch.delay.wet > 0.0f
+                   || s->patch.reverb.wet > 0.0f;
+    for (int i = 0; effects && !unison && i < len; i++) {
+        right[i] = left[i];
+    }
+    bool stereo = unison || effects;
+
+    if (s->patch.chorus.wet > 0.0f) {
+        chorus_process(&s->chorus, &s->patch.chorus, left, right, len);
+    }
+
+    if (s->patch.delay.wet > 0.0f) {
+        delay_process(&s->delay, &s->patch.delay, left, right, len);
+    }
+
+    if (s->patch.reverb.wet > 0.0f) {
+        reverb_process(&s->reverb, k, &s->patch.reverb, left, right, len);
+    }
+
+    /* Too many loud voices at once would exceed what the PWM can play, so the
+     * limiter turns them down to fit, LIMITER_LATENCY samples later.  The
+     * conversion still clips rather than wrapping around, just in case.
+     *
+     * This is the one place the mix is rounded to the PWM's 12 bits, with
+     * dither and noise shaping.  A mono mix is passed as both channels (each
+     * still gets its own dither). */
+    limiter_process(&s->limiter, left, stereo ? right : left, len);
+    k->quantize(&s->dither, out, left, stereo ? right : left, len);
+}
+
+void synth_render(struct synth *s, uint32_t *out, int len)
+{
+    synth_mix(s, out, len, 0, 0);
+}
+
+/* The longest a block is taken to have lasted.  One that went on longer - if
+ * a render was held up - is cut short at the start, and the messages from
+ * before then are late anyway. */
+#define SYNTH_MAX_SPAN 100000
+
+void synth_render_timed(struct synth *s,
+                        uint32_t *out,
+                        int len,
+                        uint32_t stamp)
+{
+    /* The first block has nothing to go by, so it's taken to have been as
+     * long as it should have.  After that, the system timer's measure of each
+     * block is used rather than the nominal one, so that the two clocks
+     * drifting apart doesn't matter. */
+    uint32_t span = s->clocked
+                    ? stamp - s->clock
+                    : (uint32_t)len * 1000000 / AUDIO_SAMPLE_RATE;
+    span = span > SYNTH_MAX_SPAN ? SYNTH_MAX_SPAN : span;
+    span = span ? span : 1;
+    s->clock = stamp;
+    s->clocked = true;
+
+    synth_mix(s, out, len, stamp - span, span);
 }
 
 void synth(void)
@@ -171,8 +1190,8 @@ void synth(void)
         struct midireq m;
     } req;
 
-    int note = -1;
-    int period_offset = 0;
+    static struct synth s;
+    synth_init(&s);
 
     while (true) {
         tid_t sender;
@@ -180,42 +1199,14 @@ void synth(void)
 
         switch (req.hdr.type) {
         case DELIVER_MIDI:
-        {
             /* No sense delaying the MIDI task here. */
             Reply(sender, NULL, 0);
-
-            uint8_t status = req.m.pkt.packet[1];
-            uint8_t type = status >> 4;
-            switch (type) {
-            case MIDI_NOTE_OFF:
-            {
-                int off_note = req.m.pkt.packet[2];
-                if (note == off_note) {
-                    note = -1;
-                }
-                break;
-            }
-            case MIDI_NOTE_ON:
-                note = req.m.pkt.packet[2];
-                period_offset = 0;
-                break;
-            }
+            synth_queue(&s, req.m.pkt.stamp, &req.m.pkt.packet[1]);
             break;
-        }
         case GET_AUDIO:
         {
             uint32_t out[req.a.len * 2];
-            if (note < 0) {
-                /* Fill the output buffer with silence. */
-                for (int i = 0; i < req.a.len * 2; i++) {
-                    out[i] = SAMPLE_MID;
-                }
-            } else {
-                /* Fill the output buffer with audio at the frequency of the
-                 * note last played. */
-                int period = periods[note];
-                period_offset = fill(out, req.a.len, period, period_offset);
-            }
+            synth_render_timed(&s, out, req.a.len, req.a.stamp);
 
             Reply(sender, out, sizeof out);
             break;
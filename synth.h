@@ -1,6 +1,247 @@
 #ifndef SXLHLG_SYNTH_H
 #define SXLHLG_SYNTH_H
 
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <caboose/config.h>
+#include <caboose/util.h>
+
+#include <caboose-platform/worker.h>
+
+#include "additive.h"
+#include "chorus.h"
+#include "delay.h"
+#include "dither.h"
+#include "drive.h"
+#include "env.h"
+#include "fm.h"
+#include "kernels.h"
+#include "lfo.h"
+#include "limiter.h"
+#include "mod.h"
+#include "params.h"
+#include "reverb.h"
+#include "sampler.h"
+#include "svf.h"
+#include "unison.h"
+#include "voicebank.h"
+#include "wavetable.h"
+
+/* A full-velocity voice uses a quarter of the available swing, so that chords
+ * of a few notes don't immediately clip. */
+#define VOICE_GAIN 0.25f
+
+/* The envelopes and the modulation matrix are evaluated once per control
+ * sub-block (2.8kHz), so every render request is split into sub-blocks of at
+ * most this many samples.  Evaluating them once per request would tie the
+ * modulation rate to the DMA buffer size. */
+#define SYNTH_CONTROL_LEN 16
+
+enum waveform {
+    WAVE_SQUARE,
+    WAVE_SAW,
+    WAVE_PULSE,
+    WAVE_TABLE,
+    WAVE_FM,
+    WAVE_ADDITIVE,
+    WAVE_SAMPLE
+};
+
+enum filter_mode {
+    FILTER_OFF,
+    FILTER_LOWPASS,
+    FILTER_HIGHPASS,
+    FILTER_BANDPASS
+};
+
+/* MIDI messages are held back until the block of time they arrived during is
+ * rendered, so that each one can be acted on at the sample it arrived at
+ * rather than at the start of whichever block happens to be rendered next
+ * (see synth_render_timed()).  This is how many can be waiting at once. */
+#define SYNTH_EVENTS 64
+
+/* A MIDI message, status byte first, and the system timer when it arrived. */
+struct synthevent {
+    uint32_t stamp;
+    uint8_t msg[3];
+};
+
+/* The sound-defining settings shared by every voice. */
+struct patch {
+    enum waveform wave;
+    uint32_t width;     /* pulse width, 0.32 fixed point like the phase */
+
+    /* For WAVE_SAW: how many copies of each note to play in unison (see
+     * unison.h), 1 to UNISON_MAX, and how they're spread out. */
+    int unison;
+    float detune;       /* semitones, between the outermost copies and the
+                           note */
+    float spread;       /* across the stereo field, [0, 1]; 0 is mono */
+
+    /* For WAVE_TABLE: which table, where between its frames, and whether to
+     * pay for cubic interpolation. */
+    const struct wavetable *table;
+    float morph;
+    bool cubic;
+
+    /* For WAVE_FM. */
+    struct fmpatch fm;
+
+    /* For WAVE_ADDITIVE. */
+    struct additivepatch additive;
+
+    /* For WAVE_SAMPLE. */
+    struct samplerpatch sampler;
+
+    struct adsr adsr;
+
+    enum filter_mode filter;
+    float cutoff;       /* as a note number, for middle C */
+    float keytrack;     /* how far the cutoff follows the note, 1 = fully */
+    float resonance;    /* [0, 1] */
+
+    float volume;       /* [0, 1], on top of each voice's velocity */
+
+    struct drivepatch drive;
+    struct choruspatch chorus;
+    struct delaypatch delay;
+    struct reverbpatch reverb;
+
+    /* The routes of the modulation matrix, in no particular order.  Unused
+     * ones are left with no amount. */
+    struct lfopatch lfo[LFO_COUNT];
+    struct modroute mod[MOD_ROUTES];
+};
+
+/* The bookkeeping for each voice that's only needed at note on and off or once
+ * per block.  What the render loop needs lives in the voicebank, at the same
+ * index. */
+struct voice {
+    int note;           /* -1 when the voice is free */
+    uint32_t stamp;     /* when the voice was last allocated, for stealing */
+    float gain;         /* from the velocity, applied on top of the envelope */
+    float velocity;     /* [0, 1], as a modulation source */
+    float pitch;        /* the modulation the voice is tuned to, in semitones */
+    struct env env;
+    float cutoff;       /* smoothed, as a note number */
+    struct env fm_env[FM_OPS];
+    int root;           /* of the zone of the bank it's playing */
+};
+
+/* The voice groups one of the worker cores renders for a control sub-block
+ * (see synth_block()), and everything it needs to do it: the groups are mixed
+ * into acc (and accr) here rather than into the main core's, and voices and
+ * voicesr are its scratch.  Each share has cache lines of its own, so that
+ * the cores writing them don't get in each other's way. */
+struct synthshare {
+    struct synth *s;
+    uint32_t groups;    /* bit n is set to render group n */
+    struct svfmix filter;
+    int len;
+    float acc[SYNTH_CONTROL_LEN * VOICE_LANES] __aligned(16);
+    float accr[SYNTH_CONTROL_LEN * VOICE_LANES] __aligned(16);
+    float voices[SYNTH_CONTROL_LEN * VOICE_LANES] __aligned(16);
+    float voicesr[SYNTH_CONTROL_LEN * VOICE_LANES] __aligned(16);
+} __aligned(64);
+
+/* All of the synth's state lives in one of these, so that the benchmarks can
+ * drive a private instance without going through the synth task. */
+struct synth {
+    const struct kernels *kernels;
+    struct patch patch;
+    struct voice voices[SYNTH_VOICE_COUNT];
+    struct voicebank bank;
+    struct additivebank additive;   /* the additive voices' partials */
+    struct samplerbank sampler;     /* the sampler voices' windows */
+    uint32_t active;    /* bit n is set while voice n is sounding, releases
+                           included */
+    uint32_t stamp;
+    float damping;      /* the filter's, smoothed */
+
+    /* The modulation sources shared by every voice, and the patch's routes
+     * built into a matrix. */
+    struct lfo lfo[LFO_COUNT];
+    float wheel;
+    float pressure;
+    struct modmatrix matrix;
+
+    /* The parameters MIDI controllers are turning. */
+    struct params params;
+
+    /* The unison the voices' copies are tuned for, and the copies' left and
+     * right gains for this sub-block. */
+    int copies;
+    float detune;
+    float pan[2][UNISON_MAX] __aligned(16);
+
+    /* How many cores the voices are rendered on, 1 to 1 + WORKER_COUNT, and
+     * the workers' shares of them.  There's only the one set of workers, so
+     * only one synth can be using them at a time. */
+    int cores;
+    struct synthshare shares[WORKER_COUNT];
+
+    /* There's only the one set of effects' delay lines (in fxmem), so only
+     * one synth can be rendering at a time. */
+    struct drive drive;
+    struct chorus chorus;
+    struct delay delay;
+    struct reverb reverb;
+
+    /* The master limiter, and the output quantizer's random numbers and error
+     * feedback. */
+    struct limiter limiter;
+    struct dither dither;
+
+    /* The MIDI messages waiting for their block, oldest first, and the system
+     * timer at the end of the last block that was rendered against it. */
+    struct synthevent events[SYNTH_EVENTS];
+    int event_head;
+    int event_count;
+    uint32_t clock;
+    bool clocked;
+};
+
+void synth_init(struct synth *s);
+
+/* Switch to patch @p.  Its LFO settings and modulation routes are only taken
+ * up here, so changes to them in s->patch need another call to this to be
+ * heard. */
+void synth_load(struct synth *s, const struct patch *p);
+
+void synth_note_on(struct synth *s, int note, int velocity);
+void synth_note_off(struct synth *s, int note);
+
+/* MIDI controller @cc changed to @value, and the channel pressure changed to
+ * @value, respectively.  Controllers mapped to parameters (see params.h) take
+ * effect gradually over the following sub-blocks. */
+void synth_control_change(struct synth *s, int cc, int value);
+void synth_pressure(struct synth *s, int value);
+
+/* Act on the three-byte MIDI message @msg right away. */
+void synth_midi(struct synth *s, const uint8_t *msg);
+
+/* Hold @msg, which arrived at system timer @stamp, for synth_render_timed()
+ * to act on at its sample.  If synth_render() comes first instead, it acts on
+ * all of them at its first sample. */
+void synth_queue(struct synth *s, uint32_t stamp, const uint8_t *msg);
+
+/* Render @len stereo samples of all sounding voices into @out in the format
+ * expected by the audio driver.  Any messages still queued (see synth_queue())
+ * are acted on before the first sample, since there's no telling where in
+ * the block they arrived. */
+void synth_render(struct synth *s, uint32_t *out, int len);
+
+/* The same, for the block of time that ended at system timer @stamp, which
+ * started where the last one ended.  Each message queued during it is acted on
+ * at the sample that far through the block, so everything comes out a block
+ * after it arrived: never sooner, but never later either, rather than anything
+ * up to a block later depending on where in it it arrived. */
+void synth_render_timed(struct synth *s,
+                        uint32_t *out,
+                        int len,
+                        uint32_t stamp);
+
 void synth(void);
 
 #endif
@@ -0,0 +1,357 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bank.h"
+#include "sinc.h"
+
+/* Host-side packer for instrument banks (see bank.h).  Each sample is named
+ * on the command line after the settings of the zone it makes:
+ *
+ *     mkbank [-c channels] [-k lo-hi] [-v lo-hi] [-r root] [-l start-end]
+ *            [-e pcm|adpcm] file ... > bank.bin
+ *
+ * Settings carry over from one zone to the next, and a file of "-" is the
+ * standard input.  The samples are 16-bit little-endian PCM, channels
+ * interleaved, written out as C arrays the way xxd -i does it - which is what
+ * sample.c is - and only their hex bytes are read, so the C compiler never has
+ * to see them.  The host is taken to be little-endian, like the Pi.
+ *
+ * Zones are kept at 16 bits unless they ask otherwise.  -e adpcm compresses
+ * the zones after it (see adpcm.h), and says how well on the standard error,
+ * since it's lossy and whether it'll do has to be judged zone by zone. */
+
+struct zonein {
+    struct bankzone z;
+    int16_t *pcm;       /* interleaved */
+};
+
+static struct zonein zones[BANK_ZONES];
+static int nzones;
+
+static void die(const char *msg, const char *what)
+{
+    fprintf(stderr,
+            "mkbank: %s%s%s\n",
+            msg,
+            what ? ": " : "",
+            what ? what : "");
+    exit(1);
+}
+
+static int hexdigit(int c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    } else if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+/* Read the hex bytes out of @name, and return how many there were. */
+static size_t read_hex(const char *name, uint8_t **bytes)
+{
+    FILE *f = strcmp(name, "-") ? fopen(name, "r") : stdin;
+    if (!f) {
+        die("can't open", name);
+    }
+
+    size_t len = 0, size = 65536;
+    uint8_t *buf = malloc(size);
+    int prev = 0, c;
+    while (buf && (c = getc(f)) != EOF) {
+        int hi, lo;
+        if (prev != '0' || (c != 'x' && c != 'X')) {
+            prev = c;
+            continue;
+        }
+
+        /* Anything else in the file - the declarations, the length - has
+         * no hex literals in it. */
+        if ((hi = hexdigit(getc(f))) < 0 || (lo = hexdigit(getc(f))) < 0) {
+            die("not a hex byte", name);
+        }
+        if (len == size) {
+            size *= 2;
+            buf = realloc(buf, size);
+        }
+        if (buf) {
+            buf[len++] = hi << 4 | lo;
+        }
+        prev = 0;
+    }
+
+    if (!buf) {
+        die("out of memory", NULL);
+    }
+    if (f != stdin) {
+        fclose(f);
+    }
+
+    *bytes = buf;
+    return len;
+}
+
+static void range(const char *arg, uint8_t *lo, uint8_t *hi)
+{
+    int l, h;
+    if (sscanf(arg, "%d-%d", &l, &h) != 2 || l < 0 || h < l || h > 127) {
+        die("bad range", arg);
+    }
+    *lo = l;
+    *hi = h;
+}
+
+/* Read @name as the sample of a zone with settings @z. */
+static void zone(const char *name, const struct bankzone *z)
+{
+    if (nzones == BANK_ZONES) {
+        die("too many zones", name);
+    }
+
+    uint8_t *bytes;
+    size_t len = read_hex(name, &bytes);
+    uint32_t frames = len / (2 * z->channels);
+
+    struct zonein *in = &zones[nzones++];
+    in->z = *z;
+
+    /* An empty sample plays as a frame of silence. */
+    if (!frames) {
+        in->z.frames = 1;
+        in->z.loop_start = 0;
+        in->z.loop_end = 0;
+        in->pcm = calloc(z->channels, sizeof in->pcm[0]);
+        free(bytes);
+        return;
+    }
+
+    if (z->loop_end
+        && (z->loop_start >= z->loop_end || z->loop_end > frames)) {
+        die("loop doesn't fit in the sample", name);
+    }
+
+    /* A loop keeps going into the first few frames of it for the sake of
+     * the interpolation, and anything after it is dropped. */
+    uint32_t guard = z->loop_end ? SAMPLER_GUARD : 0;
+    uint32_t keep = z->loop_end ? z->loop_end : frames;
+    in->z.frames = keep + guard;
+    in->pcm = malloc(in->z.frames * z->channels * sizeof in->pcm[0]);
+    if (!in->pcm) {
+        die("out of memory", NULL);
+    }
+
+    for (uint32_t i = 0; i < in->z.frames; i++) {
+        uint32_t from = i;
+        if (i >= keep) {
+            uint32_t loop = z->loop_end - z->loop_start;
+            from = z->loop_start + (i - keep) % loop;
+        }
+        for (int ch = 0; ch < z->channels; ch++) {
+            size_t at = (from * z->channels + ch) * 2;
+            in->pcm[i * z->channels + ch] = (int16_t)(bytes[at]
+                                                      | bytes[at + 1] << 8);
+        }
+    }
+    free(bytes);
+}
+
+/* Compress the @frames frames of @pcm, @stride apart, into @out. */
+static void encode(struct adpcmblock *out,
+                   const int16_t *pcm,
+                   uint32_t frames,
+                   int stride)
+{
+    struct adpcm a = { 0, 0 };
+    for (uint32_t at = 0; at < frames; at += ADPCM_FRAMES, out++) {
+        /* Each block carries on with the step size the last one ended
+         * with. */
+        out->first = pcm[at * stride];
+        out->index = a.index;
+        a.last = out->first;
+
+        uint32_t n = frames - at < ADPCM_FRAMES ? frames - at : ADPCM_FRAMES;
+        for (uint32_t i = 1; i < n; i++) {
+            unsigned int code = adpcm_encode(&a, pcm[(at + i) * stride]);
+            out->codes[(i - 1) >> 1] |= code << ((i - 1) & 1) * 4;
+        }
+    }
+}
+
+/* Say how much @in's compressed channel @ch of @image differs from the
+ * original. */
+static void report(const struct zonein *in, const uint8_t *image, int ch)
+{
+    const struct adpcmblock *b = (const void *)(image + in->z.data[ch]);
+    struct adpcm a = { 0, 0 };
+    double signal = 0.0, noise = 0.0;
+    for (uint32_t i = 0; i < in->z.frames; i++) {
+        const struct adpcmblock *block = &b[i / ADPCM_FRAMES];
+        uint32_t k = i % ADPCM_FRAMES;
+        int16_t x;
+        if (k == 0) {
+            x = adpcm_block(&a, block);
+        } else {
+            unsigned int code = block->codes[(k - 1) >> 1] >> ((k - 1) & 1) * 4;
+            x = adpcm_decode(&a, code & 0xf);
+        }
+
+        double y = in->pcm[i * in->z.channels + ch];
+        signal += y * y;
+        noise += (x - y) * (x - y);
+    }
+
+    uint32_t raw = in->z.frames * sizeof(int16_t);
+    fprintf(stderr,
+            "mkbank: zone %d channel %d: %u bytes from %u, %.2f:1, "
+            "SNR %.1f dB\n",
+            (int)(in - zones),
+            ch,
+            bank_bytes(&in->z),
+            raw,
+            (double)raw / bank_bytes(&in->z),
+            noise > 0.0 ? 10.0 * log10(signal / noise) : 999.0);
+}
+
+static uint32_t align(uint32_t x)
+{
+    return (x + BANK_ALIGN - 1) & ~(uint32_t)(BANK_ALIGN - 1);
+}
+
+int main(int argc, char **argv)
+{
+    struct bankzone z = {
+        .lokey = 0,
+        .hikey = 127,
+        .lovel = 0,
+        .hivel = 127,
+        .root = 60,
+        .channels = 1,
+        .codec = BANK_PCM16
+    };
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (arg[0] != '-' || !arg[1]) {
+            zone(arg, &z);
+            continue;
+        }
+
+        const char *val = argv[++i];
+        if (!val) {
+            die("missing value for", arg);
+        }
+
+        int a, b;
+        switch (arg[1]) {
+        case 'c':
+            a = atoi(val);
+            if (a < 1 || a > BANK_CHANNELS) {
+                die("bad channel count", val);
+            }
+            z.channels = a;
+            break;
+        case 'k':
+            range(val, &z.lokey, &z.hikey);
+            break;
+        case 'v':
+            range(val, &z.lovel, &z.hivel);
+            break;
+        case 'r':
+            a = atoi(val);
+            if (a < 0 || a > 127) {
+                die("bad root", val);
+            }
+            z.root = a;
+            break;
+        case 'l':
+            if (sscanf(val, "%d-%d", &a, &b) != 2 || a < 0 || b < 0) {
+                die("bad loop", val);
+            }
+            z.loop_start = a;
+            z.loop_end = b;
+            break;
+        case 'e':
+            if (!strcmp(val, "pcm")) {
+                z.codec = BANK_PCM16;
+            } else if (!strcmp(val, "adpcm")) {
+                z.codec = BANK_ADPCM;
+            } else {
+                die("unknown codec", val);
+            }
+            break;
+        default:
+            die("unknown option", arg);
+        }
+    }
+
+    /* Lay the bank out: the header and zones, then each channel of each
+     * zone's sample on a boundary of its own. */
+    uint32_t size = align(sizeof(struct bank)
+                          + nzones * sizeof(struct bankzone));
+    for (int n = 0; n < nzones; n++) {
+        struct bankzone *bz = &zones[n].z;
+        for (int ch = 0; ch < BANK_CHANNELS; ch++) {
+            if (ch < bz->channels) {
+                bz->data[ch] = size;
+                size = align(size + bank_bytes(bz));
+            } else {
+                bz->data[ch] = bz->data[0];
+            }
+        }
+    }
+
+    uint8_t *image = calloc(size, 1);
+    if (!image) {
+        die("out of memory", NULL);
+    }
+
+    struct bank *bank = (struct bank *)image;
+    bank->magic = BANK_MAGIC;
+    bank->version = BANK_VERSION;
+    bank->zones = nzones;
+    bank->size = size;
+
+    /* Filling the map in from the last zone back leaves each key and
+     * velocity with the first zone that covers it. */
+    memset(bank->map, BANK_NONE, sizeof bank->map);
+    for (int n = nzones - 1; n >= 0; n--) {
+        const struct bankzone *bz = &zones[n].z;
+        for (int key = bz->lokey; key <= bz->hikey; key++) {
+            for (int vel = bz->lovel; vel <= bz->hivel; vel++) {
+                bank->map[key][vel] = n;
+            }
+        }
+    }
+
+    for (int n = 0; n < nzones; n++) {
+        const struct zonein *in = &zones[n];
+        bank->zone[n] = in->z;
+        for (int ch = 0; ch < in->z.channels; ch++) {
+            uint8_t *out = image + in->z.data[ch];
+            const int16_t *pcm = &in->pcm[ch];
+            if (in->z.codec == BANK_ADPCM) {
+                encode((struct adpcmblock *)out,
+                       pcm,
+                       in->z.frames,
+                       in->z.channels);
+                report(in, image, ch);
+                continue;
+            }
+
+            for (uint32_t i = 0; i < in->z.frames; i++) {
+                ((int16_t *)out)[i] = pcm[i * in->z.channels];
+            }
+        }
+    }
+
+    if (fwrite(image, size, 1, stdout) != 1) {
+        die("can't write the bank", NULL);
+    }
+    return 0;
+}
@@ -0,0 +1,55 @@
+#include <math.h>
+#include <stdio.h>
+
+#include "halfband.h"
+
+/* Host-side generator for halfband.c: the nonzero taps of the half-band
+ * filters the drive oversamples with (see halfband.h). */
+
+/* The zeroth-order modified Bessel function, for the Kaiser window. */
+static double bessel_i0(double x)
+{
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 50; k++) {
+        term *= x / (2.0 * k);
+        sum += term * term;
+    }
+    return sum;
+}
+
+/* Print the @taps nonzero off-centre taps of a half-band filter @taps * 2 - 1
+ * long, Kaiser-windowed with @beta.  Only the first half are computed, and the
+ * second half mirrors them, so that the table is exactly symmetric. */
+static void filter(const char *name, int taps, double beta)
+{
+    double h[HALFBAND_MAX];
+    for (int k = 0; k < taps / 2; k++) {
+        int offset = 2 * k - (taps - 1);
+        double r = (double)offset / taps;
+        double window = bessel_i0(beta * sqrt(1.0 - r * r)) / bessel_i0(beta);
+        h[k] = sin(M_PI * offset / 2.0) / (M_PI * offset) * window;
+        h[taps - 1 - k] = h[k];
+    }
+
+    printf("const float %s[%d] = {\n", name, taps);
+    for (int k = 0; k < taps; k++) {
+        printf("%s%.9ef,%s",
+               k % 4 ? " " : "    ",
+               h[k],
+               k % 4 == 3 ? "\n" : "");
+    }
+    printf("};\n");
+}
+
+int main(void)
+{
+    printf("/* Generated by tools/mkhalfband.c - do not edit. */\n\n");
+    printf("#include \"halfband.h\"\n\n");
+
+    /* (The betas trade the flatness of the passband against the depth of
+     * the stopband.) */
+    filter("halfband_long", HALFBAND_LONG, 7.0);
+    printf("\n");
+    filter("halfband_short", HALFBAND_SHORT, 6.0);
+    return 0;
+}
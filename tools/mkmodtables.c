@@ -0,0 +1,99 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "lfo.h"
+#include "unison.h"
+
+/* Host-side generator for modtables.c: the unison copies' detuning, panning and
+ * starting phases, and the chorus's LFO shape.  None of them depends on
+ * anything but the number of copies, so there's no point spending square roots
+ * and cosines on them at run time. */
+
+/* Where copy @c of @n sits, evenly spaced across [-1, 1]. */
+static double position(int c, int n)
+{
+    return n > 1 ? -1.0 + 2.0 * c / (n - 1) : 0.0;
+}
+
+/* Print a row of UNISON_MAX floats, four to a line. */
+static void row(const double *v, const char *indent)
+{
+    for (int c = 0; c < UNISON_MAX; c++) {
+        printf("%s%.9ef,%s",
+               c % 4 ? " " : indent,
+               v[c],
+               c % 4 == 3 ? "\n" : "");
+    }
+}
+
+int main(void)
+{
+    printf("/* Generated by tools/mkmodtables.c - do not edit. */\n\n");
+    printf("#include \"lfo.h\"\n");
+    printf("#include \"unison.h\"\n\n");
+
+    printf("const float unison_detune[UNISON_MAX][UNISON_MAX] = {\n");
+    for (int n = 1; n <= UNISON_MAX; n++) {
+        double detune[UNISON_MAX];
+        for (int c = 0; c < UNISON_MAX; c++) {
+            double x = c < n ? position(c, n) : 0.0;
+            detune[c] = x * sqrt(fabs(x));
+        }
+        printf("    { /* %d */\n", n);
+        row(detune, "        ");
+        printf("    },\n");
+    }
+    printf("};\n\n");
+
+    printf("const float unison_pan[UNISON_MAX][2][UNISON_MAX] = {\n");
+    for (int n = 1; n <= UNISON_MAX; n++) {
+        printf("    { /* %d */\n", n);
+        for (int side = 0; side < 2; side++) {
+            /* (Rounding off cos(pi / 2) to the exact zero it should be.) */
+            double gain[UNISON_MAX];
+            for (int c = 0; c < UNISON_MAX; c++) {
+                double angle = (position(c, n) + 1.0) * M_PI / 4.0;
+                double g = side ? sin(angle) : cos(angle);
+                gain[c] = c < n ? M_SQRT2 * g / sqrt(n) : 0.0;
+                gain[c] = fabs(gain[c]) < 1e-12 ? 0.0 : gain[c];
+            }
+            printf("        {\n");
+            row(gain, "            ");
+            printf("        },\n");
+        }
+        printf("    },\n");
+    }
+    printf("};\n\n");
+
+    printf("const float unison_mono[UNISON_MAX] = {\n");
+    double mono[UNISON_MAX];
+    for (int n = 1; n <= UNISON_MAX; n++) {
+        mono[n - 1] = 1.0 / sqrt(n);
+    }
+    row(mono, "    ");
+    printf("};\n\n");
+
+    /* Any fixed scatter will do, as long as it's the same every time. */
+    printf("const uint32_t unison_phase[UNISON_MAX] = {\n   ");
+    uint32_t seed = 0x2545f491;
+    for (int c = 0; c < UNISON_MAX; c++) {
+        seed = seed * 1664525 + 1013904223;
+        printf(" 0x%08x,", seed);
+    }
+    printf("\n};\n\n");
+
+    printf("const float lfo_rounded[LFO_TABLE_LEN + 1] = {\n");
+    for (int i = 0; i <= LFO_TABLE_LEN; i++) {
+        double u = (double)(i % LFO_TABLE_LEN) / LFO_TABLE_LEN;
+        double tri = u < 0.25 ? 4.0 * u
+                     : u < 0.75 ? 2.0 - 4.0 * u
+                     : 4.0 * u - 4.0;
+        printf("%s%.9ef,%s",
+               i % 4 ? " " : "    ",
+               1.5 * tri - 0.5 * tri * tri * tri,
+               i % 4 == 3 || i == LFO_TABLE_LEN ? "\n" : "");
+    }
+    printf("};\n");
+    return 0;
+}
@@ -0,0 +1,59 @@
+#include <math.h>
+#include <stdio.h>
+
+#include "sinc.h"
+
+/* Host-side generator for sinctable.c: the sampler's windowed-sinc taps (see
+ * sinc.h). */
+
+/* The zeroth-order modified Bessel function, for the Kaiser window. */
+static double bessel_i0(double x)
+{
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 50; k++) {
+        term *= x / (2.0 * k);
+        sum += term * term;
+    }
+    return sum;
+}
+
+/* (Trading the width of the transition band, and so how much of the top of
+ * the sample's band is rolled off, against how far down the images are.) */
+#define BETA 8.0
+
+int main(void)
+{
+    printf("/* Generated by tools/mksinc.c - do not edit. */\n\n");
+    printf("#include \"sinc.h\"\n\n");
+    printf("const float sampler_sinc[%d][%d] = {\n",
+           SAMPLER_SINC_PHASES,
+           SAMPLER_SINC_TAPS);
+
+    for (int p = 0; p < SAMPLER_SINC_PHASES; p++) {
+        double frac = (p + 0.5) / SAMPLER_SINC_PHASES;
+        double h[SAMPLER_SINC_TAPS], sum = 0.0;
+
+        for (int k = 0; k < SAMPLER_SINC_TAPS; k++) {
+            /* How far frame k is from the position, and how far that is
+             * towards the edge of the window. */
+            double t = k - (SAMPLER_REACH - 1) - frac;
+            double r = t / SAMPLER_REACH;
+            double window = bessel_i0(BETA * sqrt(1.0 - r * r)) /
+                            bessel_i0(BETA);
+            h[k] = (t == 0.0 ? 1.0 : sin(M_PI * t) / (M_PI * t)) * window;
+            sum += h[k];
+        }
+
+        printf("    {");
+        for (int k = 0; k < SAMPLER_SINC_TAPS; k++) {
+            printf("%s%.9ef%s",
+                   k % 4 ? " " : k ? "\n     " : "",
+                   h[k] / sum,
+                   k < SAMPLER_SINC_TAPS - 1 ? "," : "");
+        }
+        printf("},\n");
+    }
+
+    printf("};\n");
+    return 0;
+}
@@ -0,0 +1,33 @@
+#include <math.h>
+#include <stdio.h>
+
+#include "audio.h"
+#include "svf.h"
+
+/* Host-side generator for svftable.c, the filter's cutoff table.  There's no
+ * tan() on the target, and prewarping the cutoff is exactly what keeps the TPT
+ * filter's response in tune near Nyquist, so we tabulate it here once per note
+ * and let the synth interpolate. */
+
+/* Cutoffs this close to Nyquist make the integrator gain blow up, so the top
+ * of the table is clamped. */
+#define MAX_CUTOFF (0.45 * AUDIO_SAMPLE_RATE)
+
+int main(void)
+{
+    printf("/* Generated by tools/mksvf.c - do not edit. */\n\n");
+    printf("#include \"svf.h\"\n\n");
+    printf("const float svf_g[SVF_NOTES] = {\n");
+
+    for (int note = 0; note < SVF_NOTES; note++) {
+        double freq = 440.0 * pow(2.0, (note - 69) / 12.0);
+        freq = freq < MAX_CUTOFF ? freq : MAX_CUTOFF;
+        printf("    %.9ef, /* %3d: %9.3fHz */\n",
+               tan(M_PI * freq / AUDIO_SAMPLE_RATE),
+               note,
+               freq);
+    }
+
+    printf("};\n");
+    return 0;
+}
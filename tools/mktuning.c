@@ -0,0 +1,33 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "audio.h"
+#include "tuning.h"
+
+/* Host-side generator for tuning.c.  For each MIDI note we want the amount by
+ * which a 32-bit phase accumulator must advance each sample so that it wraps
+ * around at the note's frequency - that is, f / AUDIO_SAMPLE_RATE as a 0.32
+ * fixed-point fraction of a cycle.  Computing these in double precision at
+ * build time is what buys us accurate tuning all the way up to note 127, where
+ * the old integer periods[] table had collapsed to a handful of samples. */
+
+int main(void)
+{
+    printf("/* Generated by tools/mktuning.c - do not edit. */\n\n");
+    printf("#include <stdint.h>\n\n");
+    printf("#include \"tuning.h\"\n\n");
+    printf("const uint32_t tuning_words[TUNING_NOTES] = {\n");
+
+    for (int note = 0; note < TUNING_NOTES; note++) {
+        double freq = 440.0 * pow(2.0, (note - 69) / 12.0);
+        double word = round(freq / AUDIO_SAMPLE_RATE * 4294967296.0);
+        printf("    0x%08x, /* %3d: %9.3fHz */\n",
+               (uint32_t)word,
+               note,
+               freq);
+    }
+
+    printf("};\n");
+    return 0;
+}
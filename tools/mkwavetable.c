@@ -0,0 +1,120 @@
+#include <math.h>
+#include <stdio.h>
+
+#include "wavetable.h"
+
+/* Host-side generator for wavetable.c.  Every frame is defined by its Fourier
+ * series, which we sum additively at each mip level up to that level's
+ * harmonic limit (see wavetable.h), so nothing at any level can alias.  This is
+ * far too slow to do at boot, and doing it in double precision here costs
+ * nothing.
+ *
+ * The levels of a frame are all scaled by the same amount - whatever brings the
+ * peak of its fullest level to 1 - so that a note doesn't change in loudness
+ * as it crosses from one level to the next. */
+
+/* The amplitude of harmonic @h of each frame.  The signs match the BLEP
+ * oscillators: the saw rises, and the square starts high. */
+static double sine(int h)
+{
+    return h == 1 ? 1.0 : 0.0;
+}
+
+static double triangle(int h)
+{
+    if (!(h & 1)) {
+        return 0.0;
+    }
+
+    return (h & 2 ? -1.0 : 1.0) * 8.0 / (M_PI * M_PI * h * h);
+}
+
+static double saw(int h)
+{
+    return -2.0 / (M_PI * h);
+}
+
+static double square(int h)
+{
+    return h & 1 ? 4.0 / (M_PI * h) : 0.0;
+}
+
+static double (*const frames[WAVETABLE_FRAMES])(int) = {
+    sine,
+    triangle,
+    saw,
+    square
+};
+
+static const char *const names[WAVETABLE_FRAMES] = {
+    "sine",
+    "triangle",
+    "saw",
+    "square"
+};
+
+static int harmonics(int level)
+{
+    int limit = 1 << level;
+    return limit < WAVETABLE_LEN / 2 ? limit : WAVETABLE_LEN / 2 - 1;
+}
+
+static void cycle(double (*frame)(int), int level, double *out)
+{
+    for (int i = 0; i < WAVETABLE_LEN; i++) {
+        double x = 0.0;
+        for (int h = 1; h <= harmonics(level); h++) {
+            x += frame(h) * sin(2.0 * M_PI * h * i / WAVETABLE_LEN);
+        }
+        out[i] = x;
+    }
+}
+
+int main(void)
+{
+    static double points[WAVETABLE_LEVELS][WAVETABLE_FRAMES][WAVETABLE_LEN];
+
+    for (int f = 0; f < WAVETABLE_FRAMES; f++) {
+        double peak = 0.0;
+        for (int level = 0; level < WAVETABLE_LEVELS; level++) {
+            cycle(frames[f], level, points[level][f]);
+        }
+
+        for (int i = 0; i < WAVETABLE_LEN; i++) {
+            double x = fabs(points[WAVETABLE_LEVELS - 1][f][i]);
+            peak = x > peak ? x : peak;
+        }
+
+        for (int level = 0; level < WAVETABLE_LEVELS; level++) {
+            for (int i = 0; i < WAVETABLE_LEN; i++) {
+                points[level][f][i] /= peak;
+            }
+        }
+    }
+
+    printf("/* Generated by tools/mkwavetable.c - do not edit. */\n\n");
+    printf("#include \"wavetable.h\"\n\n");
+    printf("const struct wavetable wavetable_classic = { .row = {\n");
+
+    for (int level = 0; level < WAVETABLE_LEVELS; level++) {
+        printf("    { /* level %d: %d harmonic%s */\n",
+               level,
+               harmonics(level),
+               harmonics(level) > 1 ? "s" : "");
+        for (int f = 0; f < WAVETABLE_FRAMES; f++) {
+            printf("        { /* %s */\n", names[f]);
+            for (int k = 0; k < WAVETABLE_LEN + WAVETABLE_GUARD; k++) {
+                int i = (k - 1) & (WAVETABLE_LEN - 1);
+                printf("%s%.9ef,%s",
+                       k % 4 ? " " : "            ",
+                       points[level][f][i],
+                       k % 4 == 3 ? "\n" : "");
+            }
+            printf("\n        },\n");
+        }
+        printf("    },\n");
+    }
+
+    printf("} };\n");
+    return 0;
+}
@@ -0,0 +1,28 @@
+#ifndef SXLHLG_TUNING_H
+#define SXLHLG_TUNING_H
+
+#include <stdint.h>
+
+#define TUNING_NOTES 128
+
+/* The per-sample phase increment of each MIDI note in 12-TET (A4 = 440Hz), as
+ * a 0.32 fixed-point fraction of a cycle.  The table is generated at build time
+ * by tools/mktuning.c. */
+extern const uint32_t tuning_words[TUNING_NOTES];
+
+/* The increment for a fractional @note, clamped to the range of the table.
+ * Interpolating linearly between neighbouring semitones instead of
+ * exponentially is never more than 0.8 cents out. */
+static inline uint32_t tuning_inc(float note)
+{
+    note = note < 0.0f ? 0.0f : note;
+    note = note > TUNING_NOTES - 1 ? TUNING_NOTES - 1 : note;
+
+    int n = (int)note;
+    n = n < TUNING_NOTES - 2 ? n : TUNING_NOTES - 2;
+    float frac = note - n;
+    uint32_t span = tuning_words[n + 1] - tuning_words[n];
+    return tuning_words[n] + (uint32_t)(span * frac);
+}
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef SXLHLG_UNISON_H
+#define SXLHLG_UNISON_H
+
+#include <stdint.h>
+
+/* Unison: each note played as up to UNISON_MAX saws at once, detuned either
+ * side of the note and spread across the stereo field - the supersaw.  The
+ * copies aren't voices in their own right: they don't take up any more of the
+ * voicebank's lanes, and share the voice's envelopes, modulation and filter.
+ * Instead the unison kernel renders a voice's copies side by side in the NEON
+ * lanes, which is why there can be up to 8 of them (two registers' worth).
+ *
+ * Where each copy sits, in pitch and in the stereo field, depends only on how
+ * many there are, so it's tabulated on the build host by
+ * tools/mkmodtables.c and shared by every voice. */
+#define UNISON_MAX 8
+
+/* How far copy c of n is detuned, as a fraction of the patch's detune, at
+ * [n - 1][c].  The copies are spread more thinly towards the middle, like a
+ * JP-8000's, so that the note itself stays clear however wide the outer ones
+ * are set.  Copies past n are left undetuned. */
+extern const float unison_detune[UNISON_MAX][UNISON_MAX];
+
+/* The left and right gains of copy c of n at full spread, at [n - 1][0][c] and
+ * [n - 1][1][c]: panned by their detune, from the flattest on the left to the
+ * sharpest on the right.  The pan law is equal power with unity gain in the
+ * middle, like a mono voice's, and every copy is scaled by 1 / sqrt(n), so
+ * that (the copies being uncorrelated) adding them doesn't make the note any
+ * louder.  Copies past n have no gain at all, so the kernel can render them
+ * blindly. */
+extern const float unison_pan[UNISON_MAX][2][UNISON_MAX];
+
+/* The gain of each of n copies, in both channels, at no spread at all, at
+ * [n - 1]: the same scaling, with every copy in the middle. */
+extern const float unison_mono[UNISON_MAX];
+
+/* The phase each copy starts a note at.  Starting them all together would make
+ * every note begin with a loud, phasey blip as they drift apart. */
+extern const uint32_t unison_phase[UNISON_MAX];
+
+#endif
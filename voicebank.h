@@ -0,0 +1,85 @@
+#ifndef SXLHLG_VOICEBANK_H
+#define SXLHLG_VOICEBANK_H
+
+#include <stdint.h>
+
+#include <caboose/config.h>
+#include <caboose/util.h>
+
+#include "fm.h"
+#include "unison.h"
+
+#define SYNTH_VOICE_COUNT CONFIG_SYNTH_VOICE_COUNT
+
+/* Voices are rendered a group at a time, one voice per NEON lane. */
+#define VOICE_LANES 4
+#define VOICE_GROUPS (SYNTH_VOICE_COUNT / VOICE_LANES)
+#define VOICE_GROUP_MASK ((1 << VOICE_LANES) - 1)
+
+#if SYNTH_VOICE_COUNT % VOICE_LANES || SYNTH_VOICE_COUNT > 32
+#error "CONFIG_SYNTH_VOICE_COUNT must be a multiple of 4 and no more than 32"
+#endif
+
+/* The state the render loop touches for every voice on every sample, laid out
+ * struct-of-arrays: lanes 4n..4n+3 of each array are exactly one NEON register
+ * load away, and the whole bank for 32 voices is a handful of cache lines
+ * rather than being spread among the bookkeeping in struct voice.
+ *
+ * Voices that aren't sounding stay in the bank with their gate closed, and the
+ * kernels mask their output to zero instead of branching around them.
+ *
+ * The level follows the voice's envelope, which is only evaluated once per
+ * block; the kernels ramp it by step each sample to get from one block's value
+ * to the next.  They don't store the ramped level back - the synth sets it to
+ * the envelope's exact value afterwards, so rounding can't accumulate. */
+struct voicebank {
+    uint32_t phase[SYNTH_VOICE_COUNT];
+    uint32_t inc[SYNTH_VOICE_COUNT];
+    float inv_dt[SYNTH_VOICE_COUNT];    /* reciprocal of inc, in cycles */
+    float level[SYNTH_VOICE_COUNT];     /* at the start of the block */
+    float step[SYNTH_VOICE_COUNT];      /* added to the level every sample */
+    uint32_t gate[SYNTH_VOICE_COUNT];   /* all ones while the voice sounds */
+    uint32_t width[SYNTH_VOICE_COUNT];  /* of pulses, 0.32 fixed point */
+
+    /* The filter's coefficients (see svf.h), updated once per block, and its
+     * two integrator states for each channel.  Voices are mono unless they're
+     * playing in unison, so the right channel's states usually go unused. */
+    float svf_a1[SYNTH_VOICE_COUNT];
+    float svf_a2[SYNTH_VOICE_COUNT];
+    float svf_a3[SYNTH_VOICE_COUNT];
+    float svf_ic1[2][SYNTH_VOICE_COUNT];
+    float svf_ic2[2][SYNTH_VOICE_COUNT];
+
+    /* The FM operators, indexed by operator and then voice, so that each
+     * operator's lanes are adjacent just like everything else's.  Their levels
+     * follow their own envelopes and are ramped just like the voice's.  The
+     * last operator's previous two outputs are kept for its feedback. */
+    uint32_t fm_phase[FM_OPS][SYNTH_VOICE_COUNT];
+    uint32_t fm_inc[FM_OPS][SYNTH_VOICE_COUNT];
+    float fm_level[FM_OPS][SYNTH_VOICE_COUNT];
+    float fm_step[FM_OPS][SYNTH_VOICE_COUNT];
+    float fm_fb1[SYNTH_VOICE_COUNT];
+    float fm_fb2[SYNTH_VOICE_COUNT];
+
+    /* Where each sampler voice is in its sample, and how far it moves each
+     * sample, as 32.32 fixed point frames, and the sample itself: where it
+     * ends up, and how far back it goes from there if it loops (see
+     * sampler.h). */
+    uint32_t smp_pos[SYNTH_VOICE_COUNT];
+    uint32_t smp_frac[SYNTH_VOICE_COUNT];
+    uint32_t smp_step[SYNTH_VOICE_COUNT];
+    uint32_t smp_step_frac[SYNTH_VOICE_COUNT];
+    const int16_t *smp_data[SYNTH_VOICE_COUNT];
+    uint32_t smp_frames[SYNTH_VOICE_COUNT];
+    uint32_t smp_end[SYNTH_VOICE_COUNT];
+    uint32_t smp_loop[SYNTH_VOICE_COUNT];
+
+    /* The oscillators of the unison copies (see unison.h), indexed by voice
+     * and then copy: here it's a voice's copies that are rendered side by side,
+     * so they're the ones that need to be adjacent. */
+    uint32_t uni_phase[SYNTH_VOICE_COUNT][UNISON_MAX];
+    uint32_t uni_inc[SYNTH_VOICE_COUNT][UNISON_MAX];
+    float uni_inv_dt[SYNTH_VOICE_COUNT][UNISON_MAX];
+} __aligned(16);
+
+#endif
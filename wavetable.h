@@ -0,0 +1,82 @@
+#ifndef SXLHLG_WAVETABLE_H
+#define SXLHLG_WAVETABLE_H
+
+#include <stdint.h>
+
+/* A wavetable is a short sequence of single-cycle waveforms ('frames') that a
+ * voice can morph between, each stored band-limited at one mip level per octave
+ * of the pitch range.  The tables are computed by tools/mkwavetable.c on the
+ * build host and linked in as read-only data.
+ *
+ * A level holds WAVETABLE_LEN points of one cycle of one frame, and the render
+ * loop picks the level from the voice's phase increment: level n is only ever
+ * played with an increment in [2^(30 - n), 2^(31 - n)), i.e. at less than
+ * 44.1kHz / 2^(n + 1), so it can hold 2^n harmonics without any of them passing
+ * Nyquist.  The last level is shared by everything below that and holds as many
+ * harmonics as the table length allows. */
+#define WAVETABLE_BITS 8
+#define WAVETABLE_LEN (1 << WAVETABLE_BITS)
+#define WAVETABLE_LEVELS 8
+#define WAVETABLE_FRAMES 4
+
+/* Each level is stored as a row with one point of the previous cycle before it
+ * and two of the next after it, so that even cubic interpolation never needs to
+ * wrap its index: point i of the cycle is row[i + 1].  Rows are padded out to a
+ * whole number of 64-byte cache lines.
+ *
+ * The padding also means that the row stride isn't a power of two, so the rows
+ * being read by a 32-voice render spread out across the sets of the A7's 4-way
+ * L1 rather than all competing for the same few.  At most two rows per voice
+ * (the two frames either side of the morph position) are touched per block,
+ * which comes to 17KB in the very worst case of every level in use at once. */
+#define WAVETABLE_GUARD 3
+#define WAVETABLE_ROW 272
+
+/* (The alignment is spelled out rather than using __aligned from caboose/util.h
+ * so that tools/mkwavetable.c can include this header on the build host.) */
+struct wavetable {
+    /* The frames of a level are adjacent, since they're read together. */
+    float row[WAVETABLE_LEVELS][WAVETABLE_FRAMES][WAVETABLE_ROW];
+} __attribute__((aligned(64)));
+
+/* sine, triangle, saw and square, in that order */
+extern const struct wavetable wavetable_classic;
+
+/* The mip level to play a voice with phase increment @inc from. */
+static inline int wavetable_level(uint32_t inc)
+{
+    /* Notes never reach Nyquist, so inc < 2^31 and the clz is at least 1. */
+    int level = inc ? __builtin_clz(inc) - 1 : WAVETABLE_LEVELS - 1;
+    return level < WAVETABLE_LEVELS ? level : WAVETABLE_LEVELS - 1;
+}
+
+/* Split a morph position in [0, WAVETABLE_FRAMES - 1] into the first of the two
+ * frames to blend and how far to go towards the second. */
+static inline int wavetable_frame(float morph, float *blend)
+{
+    morph = morph < 0.0f ? 0.0f : morph;
+    morph = morph > WAVETABLE_FRAMES - 1 ? WAVETABLE_FRAMES - 1 : morph;
+
+    int frame = (int)morph;
+    frame = frame < WAVETABLE_FRAMES - 2 ? frame : WAVETABLE_FRAMES - 2;
+    *blend = morph - frame;
+    return frame;
+}
+
+/* The fractional part of the phase below the table index, as a float in
+ * [0, 1).  It's 24 bits, so the conversion is exact. */
+#define WAVETABLE_FRAC_MASK ((1u << (32 - WAVETABLE_BITS)) - 1)
+#define WAVETABLE_FRAC_SCALE (1.0f / (1u << (32 - WAVETABLE_BITS)))
+
+/* 4-point, 3rd-order Hermite (Catmull-Rom) interpolation between p[1] and p[2]
+ * at @x.  The grouping of the operations here is the one the NEON kernel
+ * mirrors lane by lane. */
+static inline float wavetable_cubic(const float *p, float x)
+{
+    float c1 = 0.5f * (p[2] - p[0]);
+    float c2 = (p[0] - 2.5f * p[1]) + (p[2] + p[2]) - 0.5f * p[3];
+    float c3 = 0.5f * (p[3] - p[0]) + 1.5f * (p[1] - p[2]);
+    return ((c3 * x + c2) * x + c1) * x + p[1];
+}
+
+#endif